@@ -0,0 +1,31 @@
+#pragma once
+
+#include "clock.h"
+
+struct BenchTimer {
+    long long startNs = NowNs();
+
+    double Seconds() const {
+        return (NowNs() - startNs) / 1e9;
+    }
+};
+
+// The correctness checks benchmarks make along the way (identical paths, round
+// trips, nothing lost); flicks_bench exits non-zero if any of them fails
+bool BenchCheck(bool ok);
+
+void BenchSession();
+void BenchLoadGen();
+void BenchSpawnSampler();
+void BenchInputRing();
+void BenchSoftRenderer();
+void BenchHistoryStartup();
+void BenchHistoryWriter();
+void BenchStreamStats();
+void BenchSessionTrace();
+void BenchReplay();
+void BenchFrameStats();
+void BenchFramePacing();
+void BenchEventScheduler();
+void BenchStartup();
+void BenchAudioMixer();
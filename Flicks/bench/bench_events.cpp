@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "bench.h"
+#include "presets.h"
+#include "session.h"
+#include "session_trace.h"
+#include "stream_stats.h"
+
+namespace {
+    struct FrameRun {
+        GameResult result;
+        std::vector<TraceEvent> events;
+        std::vector<double> slipMs;     // scheduled event time to the frame that first shows it
+    };
+
+    // A perfect-aim player whose reaction time cycles through 150..249 ms; a
+    // target that expires first is let go. periodUs 0 ticks from event to
+    // event; otherwise the game is only ticked at frame boundaries and at
+    // clicks, like the app at that frame rate.
+    void Play(const GameSettings& settings, const FieldCache& field, uint64_t seed, long long periodUs, FrameRun& run) {
+        SessionTrace trace(4u << 20);
+        FlicksSession session;
+        session.Configure(settings, field);
+        session.Reset(seed);
+        session.SetTrace(&trace);
+
+        const long long startUs = 1000000;
+        session.Click(field.center.x, field.center.y, startUs);
+
+        long long frameUs = startUs;
+        int clickedSpawn = 0;
+        run.slipMs.clear();
+        while (session.GetState() == GAME_RUNNING) {
+            const long long nextUs = periodUs > 0 ? frameUs + periodUs : session.GetNextEventTimeUs();
+
+            if (session.IsCircleActive() && session.GetSpawnCount() != clickedSpawn) {
+                const long long spawnUs = session.GetCircleSpawnTimeUs();
+                const long long clickUs = spawnUs + 150000 + (session.GetSpawnCount() * 37 % 100) * 1000;
+                if (clickUs < nextUs && clickUs < spawnUs + settings.circleLifetimeMs * 1000LL) {
+                    clickedSpawn = session.GetSpawnCount();
+                    session.Tick(clickUs);
+                    session.Click(session.GetCirclePos().x, session.GetCirclePos().y, clickUs);
+                    continue;
+                }
+            }
+
+            frameUs = nextUs;
+            session.Tick(frameUs);
+            long long eventUs;
+            if (session.TakeFirstEventTime(eventUs)) run.slipMs.push_back((frameUs - eventUs) / 1000.0);
+        }
+
+        run.result = session.GetResult();
+        run.events.clear();
+        DecodeSessionTrace(trace.GetData(), trace.GetSize(), trace.GetHeader().startTimeUs, run.events);
+    }
+
+    bool SameGame(const FrameRun& a, const FrameRun& b) {
+        if (a.result.hits != b.result.hits || a.result.attempts != b.result.attempts ||
+            memcmp(&a.result.score, &b.result.score, sizeof(float)) != 0 ||
+            a.events.size() != b.events.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.events.size(); ++i) {
+            const TraceEvent& x = a.events[i];
+            const TraceEvent& y = b.events[i];
+            if (x.type != y.type || x.detail != y.detail || x.timeUs != y.timeUs) return false;
+        }
+        return true;
+    }
+}
+
+// Every preset played at 60, 144 and 540 Hz must produce the game it
+// produces when ticked exactly at each event: same spawns, expiries and
+// score. The slip is how long an event waits for the frame that shows it.
+void BenchEventScheduler() {
+    const int rates[] = { 60, 144, 540 };
+    const int games = 20;
+
+    printf("%-12s", "preset");
+    for (int hz : rates) printf(" | %3d Hz: games equal, slip p50/max ms", hz);
+    printf("\n");
+
+    FrameRun exact, framed;
+    for (int p = 0; p < g_presetCount; ++p) {
+        GameSettings settings;
+        ApplyPreset(settings, g_presets[p]);
+        FieldCache field;
+        UpdateFieldCache(field, 1920, 1080, settings.scale, settings.circleRadiusNorm, settings.cursorRadiusNorm);
+
+        printf("%-12s", g_presets[p].name);
+        for (int hz : rates) {
+            int equal = 0;
+            std::vector<double> slips;
+            for (int g = 0; g < games; ++g) {
+                const uint64_t seed = static_cast<uint64_t>(p) * 1000 + g + 1;
+                Play(settings, field, seed, 0, exact);
+                Play(settings, field, seed, 1000000 / hz, framed);
+                equal += SameGame(exact, framed);
+                slips.insert(slips.end(), framed.slipMs.begin(), framed.slipMs.end());
+            }
+            const double maxSlip = slips.empty() ? 0.0 : *std::max_element(slips.begin(), slips.end());
+            BenchCheck(equal == games);
+            printf(" |         %3d/%-3d %8.2f / %-6.2f", equal, games, ExactQuantile(slips, 0.5), maxSlip);
+        }
+        printf("\n");
+    }
+}
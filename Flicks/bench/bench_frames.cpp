@@ -0,0 +1,89 @@
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "frame_stats.h"
+
+namespace {
+    // Synthetic frame n: every stamp is derived from n, so a reader can tell a
+    // record that was half overwritten from an intact one
+    void FillFrame(FrameTiming& f, long long n) {
+        f.waitEndUs = f.startUs + 1;
+        f.pumpEndUs = f.startUs + 2;
+        f.simEndUs = f.startUs + 3;
+        f.submitEndUs = f.startUs + 4;
+        f.presentEndUs = f.startUs + 5;
+        f.inputUs = f.startUs - 100;
+        f.newestInputUs = f.startUs - 10;
+        f.presentCount = static_cast<uint32_t>(n);
+    }
+
+    bool IsIntact(const FrameTiming& f) {
+        const long long n = f.presentCount;
+        return f.startUs == n * 1000 && f.waitEndUs == f.startUs + 1 && f.pumpEndUs == f.startUs + 2 &&
+            f.simEndUs == f.startUs + 3 && f.submitEndUs == f.startUs + 4 && f.presentEndUs == f.startUs + 5 &&
+            f.inputUs == f.startUs - 100 && f.newestInputUs == f.startUs - 10 &&
+            (f.displayUs == 0 || f.displayUs == f.startUs + 8000);
+    }
+}
+
+void BenchFrameStats() {
+    static FrameStats stats;
+
+    // Writer cost: one frame recorded, displayed two frames later
+    const long long frames = 20000000;
+    BenchTimer timer;
+    for (long long n = 1; n <= frames; ++n) {
+        FrameTiming& f = stats.BeginFrame(n * 1000);
+        FillFrame(f, n);
+        stats.EndFrame();
+        if (n > 2) stats.MarkDisplayed(static_cast<uint32_t>(n - 2), (n - 2) * 1000 + 8000);
+    }
+    const double seconds = timer.Seconds();
+    printf("record: %lld frames in %.3f s, %.1f ns/frame, %llu published\n",
+        frames, seconds, seconds / frames * 1e9, static_cast<unsigned long long>(stats.GetPublishedCount()));
+
+    // Snapshots taken while the writer runs flat out must never hold a torn record
+    static FrameStats shared;
+    std::atomic<bool> stop{ false };
+    std::thread writer([&stop] {
+        for (long long n = 1; !stop.load(std::memory_order_relaxed); ++n) {
+            FrameTiming& f = shared.BeginFrame(n * 1000);
+            FillFrame(f, n);
+            shared.EndFrame();
+            if (n > 2) shared.MarkDisplayed(static_cast<uint32_t>(n - 2), (n - 2) * 1000 + 8000);
+        }
+    });
+
+    std::vector<FrameTiming> snapshot;
+    snapshot.reserve(FrameStats::kCapacity);
+    long long snapshots = 0, copied = 0, torn = 0, unordered = 0;
+    BenchTimer readTimer;
+    while (readTimer.Seconds() < 1.0) {
+        snapshot.clear();
+        copied += static_cast<long long>(shared.Snapshot(snapshot));
+        snapshots++;
+        for (size_t i = 0; i < snapshot.size(); ++i) {
+            if (!IsIntact(snapshot[i])) torn++;
+            if (i > 0 && snapshot[i].presentCount != snapshot[i - 1].presentCount + 1) unordered++;
+        }
+    }
+    stop.store(true, std::memory_order_relaxed);
+    writer.join();
+    printf("concurrent: %lld snapshots, %.0f frames each, %lld torn, %lld out of order, writer at %llu frames\n",
+        snapshots, snapshots ? static_cast<double>(copied) / snapshots : 0.0, torn, unordered,
+        static_cast<unsigned long long>(shared.GetPublishedCount()));
+    BenchCheck(torn == 0 && unordered == 0);
+
+    // What the overlay pays twice a second
+    snapshot.clear();
+    stats.Snapshot(snapshot);
+    const int rounds = 200;
+    FrameStatsSummary summary;
+    BenchTimer summaryTimer;
+    for (int i = 0; i < rounds; ++i) summary = SummarizeFrames(snapshot);
+    printf("summary: %zu frames in %.1f us, frame p99 %.3f ms, input>display p50 %.3f ms\n",
+        snapshot.size(), summaryTimer.Seconds() / rounds * 1e6, summary.frame.p99, summary.inputToDisplay.p50);
+}
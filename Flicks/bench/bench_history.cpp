@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "history.h"
+#include "history_columns.h"
+#include "history_index.h"
+#include "history_writer.h"
+#include "rng.h"
+#include "settings_key.h"
+#include "stream_stats.h"
+#include "summaries.h"
+
+namespace {
+    // Games spread over a handful of settings, like a lab machine shared by a few drills
+    GameSummary MakeGame(Rng& rng, long long index) {
+        GameSummary s = {};
+        const int drill = static_cast<int>(rng.NextInt(0, 7));
+        s.circleRadiusNorm = 0.05f + 0.01f * drill;
+        s.cursorRadiusNorm = 0.015f;
+        s.circleLifetimeMs = 250 + 50 * (drill & 3);
+        s.gameTimeSec = 60;
+        s.hits = static_cast<int>(rng.NextInt(100, 400));
+        s.avgReactionTime = rng.NextFloat(150.0f, 350.0f);
+        s.score = static_cast<float>(s.hits);
+        s.timestamp = 1700000000 + index * 70;
+        s.seed = rng.Next64();
+        return s;
+    }
+
+    void WriteFiles(const std::string& dir, long long count, bool csv) {
+        const std::string logPath = dir + "/history.bin";
+        WriteGameHistory({}, logPath.c_str());
+        GameHistory log;
+        log.Open(logPath.c_str(), nullptr);
+
+        Rng rng(count);
+        std::vector<GameSummary> chunk;
+        std::vector<GameSummary> all;
+        for (long long i = 0; i < count; ) {
+            chunk.clear();
+            for (; i < count && chunk.size() < 65536; ++i) chunk.push_back(MakeGame(rng, i));
+            log.Append(chunk.data(), chunk.size());
+            if (csv) all.insert(all.end(), chunk.begin(), chunk.end());
+        }
+        if (csv) SaveGameSummaries(all, (dir + "/history.csv").c_str());
+    }
+
+    // What the statistics view does first: select one drill and sum its scores
+    double FirstView(const HistoryColumns& columns, uint64_t key, size_t& rows) {
+        std::vector<uint32_t> selected;
+        columns.Select(key, selected);
+        double total = 0.0;
+        for (uint32_t row : selected) total += columns.GetScore(row);
+        rows = selected.size();
+        return total;
+    }
+}
+
+void BenchHistoryStartup() {
+    const long long counts[] = { 10000, 1000000, 10000000 };
+    const std::string dir = (std::filesystem::temp_directory_path() / "flicks_bench_history").string();
+    std::filesystem::create_directories(dir);
+    const std::string logPath = dir + "/history.bin";
+    const std::string snapshotPath = dir + "/history.cols";
+    const std::string csvPath = dir + "/history.csv";
+    Rng keyRng(1);
+    const uint64_t key = MakeSettingsKey(MakeGame(keyRng, 0));
+
+    printf("%-10s | %-10s | %-10s | %-12s | %-12s | %-12s | %-12s | %-12s | %-12s\n",
+        "games", "csv load", "log read", "cols build", "cols open", "key scan", "index build", "first find", "index find");
+    for (long long count : counts) {
+        // CSV parsing at 10^7 rows takes minutes and most of a gigabyte of disk
+        const bool csv = count <= 1000000;
+        WriteFiles(dir, count, csv);
+        std::filesystem::remove(snapshotPath);
+
+        double csvSeconds = -1.0;
+        if (csv) {
+            std::vector<GameSummary> summaries;
+            BenchTimer timer;
+            LoadGameSummaries(summaries, csvPath.c_str());
+            csvSeconds = timer.Seconds();
+        }
+
+        double logSeconds;
+        {
+            std::vector<GameSummary> summaries;
+            BenchTimer timer;
+            ReadGameHistory(summaries, logPath.c_str());
+            logSeconds = timer.Seconds();
+        }
+
+        double buildSeconds, openSeconds, viewSeconds, indexSeconds, firstFindSeconds, findNs;
+        size_t rows = 0;
+        double total = 0.0;
+        {
+            HistoryColumns columns;
+            BenchTimer timer;
+            columns.Open(logPath.c_str(), snapshotPath.c_str());
+            buildSeconds = timer.Seconds();
+        }
+        {
+            HistoryColumns columns;
+            BenchTimer timer;
+            columns.Open(logPath.c_str(), snapshotPath.c_str());
+            openSeconds = timer.Seconds();
+            BenchTimer view;
+            total = FirstView(columns, key, rows);
+            viewSeconds = view.Seconds();
+
+            HistoryIndex index;
+            BenchTimer build;
+            index.Build(columns);
+            indexSeconds = build.Seconds();
+
+            // The first look at a key streams its games through the quantile estimators
+            BenchTimer first;
+            index.Find(columns, key);
+            firstFindSeconds = first.Seconds();
+
+            // What the results window pays per frame after that
+            const int frames = 1000000;
+            double checksum = 0.0;
+            BenchTimer find;
+            for (int i = 0; i < frames; ++i) {
+                const SettingsStats* stats = index.Find(columns, key + (i & 1));
+                if (stats) checksum += stats->score.moments.GetMean();
+            }
+            findNs = find.Seconds() * 1e9 / frames;
+            if (checksum < 0.0) printf("?");
+        }
+
+        char csvText[16] = "skipped";
+        if (csvSeconds >= 0.0) snprintf(csvText, sizeof(csvText), "%.1f ms", csvSeconds * 1e3);
+        printf("%-10lld | %10s | %7.1f ms | %9.1f ms | %9.3f ms | %9.1f ms | %9.1f ms | %9.1f ms | %9.1f ns  (%zu games, mean %.1f)\n",
+            count, csvText, logSeconds * 1e3, buildSeconds * 1e3, openSeconds * 1e3, viewSeconds * 1e3,
+            indexSeconds * 1e3, firstFindSeconds * 1e3, findNs, rows, rows ? total / rows : 0.0);
+    }
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
+
+// What the frame that ends a game pays to record it: a synchronous append
+// and sync against a push to the writer thread, one game every 2 ms and then
+// as a burst of a full ring. Every pushed game has to be in the log after Stop.
+void BenchHistoryWriter() {
+    const std::string dir = (std::filesystem::temp_directory_path() / "flicks_bench_writer").string();
+    std::filesystem::create_directories(dir);
+    const std::string logPath = dir + "/history.bin";
+    const int games = 200;
+    Rng rng(7);
+
+    std::vector<double> syncUs;
+    {
+        WriteGameHistory({}, logPath.c_str());
+        GameHistory log;
+        log.Open(logPath.c_str(), nullptr);
+        for (int i = 0; i < games; ++i) {
+            const GameSummary s = MakeGame(rng, i);
+            BenchTimer timer;
+            log.Append(s);
+            log.Sync();
+            syncUs.push_back(timer.Seconds() * 1e6);
+        }
+    }
+    const double syncMax = *std::max_element(syncUs.begin(), syncUs.end());
+    printf("append + sync: p50 %8.2f us, p99 %8.2f us, max %8.2f us\n",
+        ExactQuantile(syncUs, 0.5), ExactQuantile(syncUs, 0.99), syncMax);
+
+    WriteGameHistory({}, logPath.c_str());
+    HistoryWriter writer;
+    writer.Start(logPath.c_str(), nullptr);
+    for (int round = 0; round < 2; ++round) {
+        const bool burst = (round == 1);
+        const int count = burst ? static_cast<int>(HistoryWriter::kQueueCapacity) : games;
+        std::vector<double> pushUs;
+        for (int i = 0; i < count; ++i) {
+            const GameSummary s = MakeGame(rng, i);
+            BenchTimer timer;
+            writer.Push(s);
+            pushUs.push_back(timer.Seconds() * 1e6);
+            if (!burst) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        const double pushMax = *std::max_element(pushUs.begin(), pushUs.end());
+        printf("push (%-5s):  p50 %8.2f us, p99 %8.2f us, max %8.2f us\n", burst ? "burst" : "2 ms",
+            ExactQuantile(pushUs, 0.5), ExactQuantile(pushUs, 0.99), pushMax);
+    }
+    writer.Stop();
+
+    const long long pushed = games + static_cast<long long>(HistoryWriter::kQueueCapacity) - writer.GetDroppedCount();
+    printf("writer: %lld pushed, %lld dropped, %lld written in %lld syncs, %lld failed, log holds %lld\n",
+        pushed, writer.GetDroppedCount(), writer.GetWrittenCount(), writer.GetSyncCount(),
+        writer.GetFailedCount(), CountGameHistoryRecords(logPath.c_str()));
+    BenchCheck(writer.GetFailedCount() == 0 && writer.GetWrittenCount() == pushed && CountGameHistoryRecords(logPath.c_str()) == pushed);
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
@@ -0,0 +1,64 @@
+#include <cstdio>
+#include <cstring>
+
+#include "bench.h"
+
+namespace {
+    int g_failedChecks = 0;
+
+    struct BenchEntry {
+        const char* name;
+        void (*run)();
+    };
+
+    const BenchEntry g_benches[] = {
+        { "session", BenchSession },
+        { "loadgen", BenchLoadGen },
+        { "spawn", BenchSpawnSampler },
+        { "ring", BenchInputRing },
+        { "render", BenchSoftRenderer },
+        { "history", BenchHistoryStartup },
+        { "writer", BenchHistoryWriter },
+        { "stats", BenchStreamStats },
+        { "trace", BenchSessionTrace },
+        { "replay", BenchReplay },
+        { "frames", BenchFrameStats },
+        { "pacing", BenchFramePacing },
+        { "events", BenchEventScheduler },
+        { "startup", BenchStartup },
+        { "mixer", BenchAudioMixer },
+    };
+}
+
+bool BenchCheck(bool ok) {
+    if (!ok) g_failedChecks++;
+    return ok;
+}
+
+// flicks_bench [name...] - runs the named benchmarks, or all of them
+int main(int argc, char** argv) {
+    int ran = 0;
+    for (const BenchEntry& bench : g_benches) {
+        bool selected = (argc < 2);
+        for (int i = 1; i < argc && !selected; ++i) {
+            selected = (strcmp(argv[i], bench.name) == 0);
+        }
+        if (!selected) continue;
+
+        printf("== %s\n", bench.name);
+        bench.run();
+        ran++;
+    }
+
+    if (ran == 0) {
+        printf("Available benchmarks:");
+        for (const BenchEntry& bench : g_benches) printf(" %s", bench.name);
+        printf("\n");
+        return 1;
+    }
+    if (g_failedChecks > 0) {
+        printf("%d check(s) failed\n", g_failedChecks);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "audio_mixer.h"
+#include "audio_sink.h"
+#include "bench.h"
+#include "stream_stats.h"
+#include "wav.h"
+
+namespace {
+    // A decaying 16-bit tone, like res/hit.wav
+    PcmSound MakeHit(uint32_t rate, uint16_t channels, int frames) {
+        PcmSound pcm;
+        pcm.channels = channels;
+        pcm.sampleRate = rate;
+        pcm.bitsPerSample = 16;
+        pcm.blockAlign = static_cast<uint16_t>(channels * 2);
+        pcm.byteRate = rate * pcm.blockAlign;
+        pcm.samples.resize(static_cast<size_t>(frames) * pcm.blockAlign);
+        for (int i = 0; i < frames; ++i) {
+            const float t = static_cast<float>(i) / rate;
+            const float v = 0.5f * std::sin(6.2831853f * 880.0f * t) * std::exp(-8.0f * t);
+            const int16_t s = static_cast<int16_t>(v * 32767.0f);
+            for (int c = 0; c < channels; ++c) memcpy(&pcm.samples[(static_cast<size_t>(i) * channels + c) * 2], &s, 2);
+        }
+        return pcm;
+    }
+
+    uint64_t HashBlock(uint64_t hash, const float* block, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t bits;
+            memcpy(&bits, &block[i], 4);
+            hash = (hash ^ bits) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    struct MixRun {
+        double voiceFramesPerSec = 0.0;
+        double realtimeFactor = 0.0;
+        uint64_t hash = 14695981039346656037ULL;
+    };
+
+    // Keeps `voices` hits playing (restarting them as they end, so they are
+    // staggered) and times only the Mix calls
+    MixRun RunMix(const PcmSound& hit, bool vectorized, int voices, int blocks) {
+        const int blockFrames = AudioFileSink::kBlockFrames;
+        auto mixer = std::make_unique<AudioMixer>();
+        mixer->SetVectorized(vectorized);
+        const int sound = mixer->AddSound(hit);
+        std::vector<float> block(static_cast<size_t>(blockFrames) * AudioMixer::kChannels);
+
+        MixRun run;
+        long long voiceFrames = 0;
+        double seconds = 0.0;
+        for (int b = 0; b < blocks; ++b) {
+            for (int v = mixer->GetActiveVoices(); v < voices; ++v) mixer->Play(sound, 0.5f);
+            BenchTimer timer;
+            mixer->Mix(block.data(), blockFrames);
+            seconds += timer.Seconds();
+            voiceFrames += static_cast<long long>(mixer->GetActiveVoices()) * blockFrames;
+            run.hash = HashBlock(run.hash, block.data(), block.size());
+        }
+        run.voiceFramesPerSec = voiceFrames / seconds;
+        run.realtimeFactor = static_cast<double>(blocks) * blockFrames / AudioMixer::kSampleRate / seconds;
+        return run;
+    }
+}
+
+void BenchAudioMixer() {
+    const int hitFrames = AudioMixer::kSampleRate / 4;
+    const PcmSound hit = MakeHit(AudioMixer::kSampleRate, 2, hitFrames);
+
+    // Load-time conversion: 44.1 kHz mono is resampled once
+    {
+        AudioMixer mixer;
+        const int sound = mixer.AddSound(MakeHit(44100, 1, 11025));
+        printf("load: 44100 Hz mono, 11025 frames -> %d frames at %d Hz\n", mixer.GetSoundFrames(sound), AudioMixer::kSampleRate);
+    }
+
+    // Rapid hits 5 ms apart: with the old four round-robin voices the fifth
+    // cut the first one off; every hit should now play to its end
+    {
+        AudioMixer mixer;
+        const int sound = mixer.AddSound(hit);
+        const int hits = 8, spacing = AudioMixer::kSampleRate / 200;
+        std::vector<float> block(static_cast<size_t>(spacing) * AudioMixer::kChannels);
+        long long frames = 0;
+        int maxActive = 0;
+        for (int i = 0; i < hits || mixer.GetActiveVoices() > 0; ++i) {
+            if (i < hits) mixer.Play(sound);
+            mixer.Mix(block.data(), spacing);
+            maxActive = std::max(maxActive, mixer.GetActiveVoices());
+            if (mixer.GetActiveVoices() > 0) frames += spacing;
+        }
+        printf("overlap: %d hits 5 ms apart, %d voices at once, %lld stolen, sound for %lld frames (expected %d)\n",
+            hits, maxActive, mixer.GetStolenCount(), frames + spacing, (hits - 1) * spacing + hitFrames);
+        BenchCheck(maxActive == hits && mixer.GetStolenCount() == 0 && frames + spacing == (hits - 1) * spacing + hitFrames);
+
+        // Past kMaxVoices the hit that has played longest gives way
+        for (int i = 0; i < AudioMixer::kMaxVoices + 16; ++i) mixer.Play(sound);
+        mixer.Mix(block.data(), spacing);
+        printf("burst: %d hits, %d voices, %lld stolen\n", AudioMixer::kMaxVoices + 16, mixer.GetActiveVoices(), mixer.GetStolenCount());
+        BenchCheck(mixer.GetActiveVoices() == AudioMixer::kMaxVoices && mixer.GetStolenCount() == 16);
+    }
+
+    printf("%-8s | %-16s | %-16s | %-10s | %s\n", "voices", "scalar Mvf/s", "sse2 Mvf/s", "sse2 x rt", "identical");
+    const int voiceCounts[] = { 1, 8, 32, AudioMixer::kMaxVoices };
+    for (int voices : voiceCounts) {
+        const int blocks = 2000;
+        MixRun scalar = RunMix(hit, false, voices, blocks);
+        MixRun simd = RunMix(hit, true, voices, blocks);
+        printf("%-8d | %-16.1f | %-16.1f | %-10.0f | %s\n", voices, scalar.voiceFramesPerSec / 1e6, simd.voiceFramesPerSec / 1e6,
+            simd.realtimeFactor, BenchCheck(scalar.hash == simd.hash) ? "yes" : "NO");
+    }
+
+    // The game thread's side while the sink mixes in real time: a burst of
+    // hits every millisecond, far more than a game produces
+    {
+        auto mixer = std::make_unique<AudioMixer>();
+        const int sound = mixer->AddSound(hit);
+        AudioFileSink sink;
+        sink.Start(*mixer);
+
+        std::vector<long long> pushNs;
+        BenchTimer timer;
+        while (timer.Seconds() < 0.5) {
+            for (int i = 0; i < 4; ++i) {
+                const long long startNs = NowNs();
+                mixer->Play(sound, 0.25f);
+                pushNs.push_back(NowNs() - startNs);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        sink.Stop();
+        const long long maxNs = *std::max_element(pushNs.begin(), pushNs.end());
+        const Quantiles q = ExactQuantiles(pushNs);
+        printf("play: %zu calls, p50 %.0f ns, p99 %.0f ns, max %lld ns; %lld played, %lld dropped, %lld stolen\n",
+            pushNs.size(), q.p50, q.p99, maxNs, mixer->GetPlayedCount(), mixer->GetDroppedCount(), mixer->GetStolenCount());
+        printf("null sink: %lld frames, max mix %.1f us per %d-frame block, %lld late blocks\n",
+            sink.GetMixedFrames(), sink.GetMaxMixNs() / 1e3, AudioFileSink::kBlockFrames, sink.GetLateBlocks());
+    }
+
+    // File sink: the WAV it writes reads back with every mixed frame
+    {
+        const std::string dir = (std::filesystem::temp_directory_path() / "flicks_bench_mixer").string();
+        std::filesystem::create_directories(dir);
+        const std::string path = dir + "/mix.wav";
+
+        AudioMixer mixer;
+        const int sound = mixer.AddSound(hit);
+        AudioFileSink sink;
+        sink.Start(mixer, path.c_str());
+        for (int i = 0; i < 4; ++i) {
+            mixer.Play(sound);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        sink.Stop();
+
+        PcmSound written;
+        const bool loaded = LoadWav(path.c_str(), written);
+        const long long frames = loaded ? static_cast<long long>(written.samples.size() / written.blockAlign) : 0;
+        printf("file sink: %lld frames mixed, %lld read back (%s)\n", sink.GetMixedFrames(), frames,
+            BenchCheck(loaded && frames == sink.GetMixedFrames()) ? "ok" : "MISMATCH");
+        std::filesystem::remove_all(dir);
+    }
+}
@@ -0,0 +1,52 @@
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "bench.h"
+#include "clock.h"
+#include "frame_pacer.h"
+#include "stream_stats.h"
+
+namespace {
+    void PrintLateness(const char* name, std::vector<double>& lateUs) {
+        const double max = *std::max_element(lateUs.begin(), lateUs.end());
+        printf("%-22s late by p50 %7.1f us, p99 %7.1f us, max %7.1f us\n", name,
+            ExactQuantile(lateUs, 0.50), ExactQuantile(lateUs, 0.99), max);
+    }
+
+    // How far past a 2 ms deadline the sleeper wakes
+    void MeasureSleeper(const char* name, PreciseSleeper& sleeper, long long spinUs) {
+        const int rounds = 300;
+        std::vector<double> lateUs;
+        lateUs.reserve(rounds);
+        for (int i = 0; i < rounds; ++i) {
+            const long long deadline = NowUs() + 2000;
+            lateUs.push_back(static_cast<double>(sleeper.SleepUntil(deadline, spinUs) - deadline));
+        }
+        PrintLateness(name, lateUs);
+    }
+}
+
+void BenchFramePacing() {
+    PreciseSleeper sleeper(NowUs);
+    MeasureSleeper("os sleep", sleeper, 0);
+    MeasureSleeper("sleep + spin", sleeper, sleeper.GetDefaultSpinUs());
+
+    // A 500 fps cap with 0.5 ms of work per frame: the start times should hold a 2 ms grid
+    FramePacer pacer(NowUs);
+    pacer.SetMode(PACING_CAPPED);
+    pacer.SetCapFps(500);
+    std::vector<double> intervals;
+    long long last = 0;
+    for (int i = 0; i < 500; ++i) {
+        const long long start = pacer.Wait();
+        if (last) intervals.push_back((start - last) / 1000.0);
+        last = start;
+        while (NowUs() < start + 500) {}
+        pacer.EndFrame(start, NowUs());
+    }
+    const auto [lo, hi] = std::minmax_element(intervals.begin(), intervals.end());
+    const double minMs = *lo, maxMs = *hi;
+    printf("capped 500 fps: frame p50 %.3f ms, p99 %.3f ms, min %.3f ms, max %.3f ms, predicted work %lld us\n",
+        ExactQuantile(intervals, 0.50), ExactQuantile(intervals, 0.99), minMs, maxMs, pacer.GetPredictedWorkUs());
+}
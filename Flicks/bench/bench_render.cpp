@@ -0,0 +1,104 @@
+#include <cstdio>
+
+#include "bench.h"
+#include "field.h"
+#include "soft_renderer.h"
+
+namespace {
+    struct RenderRun {
+        double mpixPerSec = 0.0;
+        uint64_t hash = 0;
+    };
+
+    // One scene per frame: clear, field, a target and the two cursor circles.
+    // Targets walk across the field so edges land on every sub-pixel phase.
+    RenderRun RunFrames(SoftRenderer& renderer, const FieldCache& field, int frames) {
+        const float clear[4] = { 0.1f, 0.1f, 0.12f, 1.0f };
+        const ImVec4 fieldColor(0.2f, 0.2f, 0.25f, 1.0f);
+        const ImVec4 circleColor(0.9f, 0.3f, 0.2f, 1.0f);
+        const ImVec4 outlineColor(0.0f, 0.0f, 0.0f, 0.8f);
+        const ImVec4 cursorColor(1.0f, 1.0f, 1.0f, 0.9f);
+
+        RenderRun run;
+        long long shaded = 0;
+        double seconds = 0.0;
+        for (int i = 0; i < frames; ++i) {
+            const float t = static_cast<float>(i) * 0.37f;
+            const ImVec2 target(field.center.x + field.spawnMaxRadius * (static_cast<float>(i % 97) / 48.5f - 1.0f),
+                field.center.y + field.spawnMaxRadius * (static_cast<float>(i % 89) / 44.5f - 1.0f) + t - static_cast<int>(t));
+
+            BenchTimer timer;
+            renderer.BeginFrame(clear);
+            renderer.DrawField(field, fieldColor);
+            renderer.BeginCircleRendering();
+            renderer.DrawCircle(target, field.circleRadiusPx, circleColor);
+            renderer.DrawCircle(field.center, field.cursorRadiusPx, outlineColor);
+            renderer.DrawCircle(field.center, field.cursorRadiusPx - 2.0f, cursorColor, 0.1f);
+            renderer.EndCircleRendering();
+            renderer.EndFrame();
+            seconds += timer.Seconds();
+
+            // Pixels written: clear + field + the three circle quads
+            const float r = field.circleRadiusPx, c = field.cursorRadiusPx;
+            shaded += static_cast<long long>(renderer.GetWidth()) * renderer.GetHeight()
+                + static_cast<long long>(field.fieldSize * field.fieldSize)
+                + static_cast<long long>(4.0f * (r * r + c * c + (c - 2.0f) * (c - 2.0f)));
+            // Outside the timed part: every frame must match between the two paths
+            run.hash = run.hash * 31 + renderer.Hash();
+        }
+        run.mpixPerSec = shaded / seconds / 1e6;
+        return run;
+    }
+
+    // Feathered circles alone: the per-pixel sqrt/divide the shader does
+    RenderRun RunCircles(SoftRenderer& renderer, const FieldCache& field, int count) {
+        const float clear[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        const ImVec4 color(0.9f, 0.3f, 0.2f, 0.75f);
+        const float r = field.circleRadiusPx;
+
+        RenderRun run;
+        renderer.BeginFrame(clear);
+        BenchTimer timer;
+        for (int i = 0; i < count; ++i) {
+            const ImVec2 center(field.center.x + static_cast<float>(i % 64) * 0.13f, field.center.y - static_cast<float>(i % 37) * 0.29f);
+            renderer.DrawCircle(center, r, color);
+        }
+        const double seconds = timer.Seconds();
+        run.mpixPerSec = count * 4.0 * r * r / seconds / 1e6;
+        run.hash = renderer.Hash();
+        return run;
+    }
+}
+
+void BenchSoftRenderer() {
+    struct Size { int width, height; };
+    const Size sizes[] = { { 640, 360 }, { 1920, 1080 } };
+    const int frames = 60;
+
+    printf("%-16s | %-14s | %-14s | %s\n", "pass", "scalar Mpix/s", "sse2 Mpix/s", "identical");
+    for (const Size& size : sizes) {
+        FieldCache field;
+        UpdateFieldCache(field, size.width, size.height, 0.9f, 0.112f, 0.015f);
+        SoftRenderer renderer(size.width, size.height);
+
+        // Warm-up pass so neither path pays for first-touch page faults
+        RunFrames(renderer, field, frames / 4);
+        for (int pass = 0; pass < 2; ++pass) {
+            auto run = [&](bool vectorized) {
+                renderer.SetVectorized(vectorized);
+                return pass == 0 ? RunFrames(renderer, field, frames) : RunCircles(renderer, field, frames * 20);
+            };
+            char name[32];
+            snprintf(name, sizeof(name), "%s %dx%d", pass == 0 ? "frame" : "circle", size.width, size.height);
+
+            RenderRun scalar = run(false);
+#ifdef FLICKS_SSE2
+            RenderRun vectorized = run(true);
+            printf("%-16s | %14.1f | %14.1f | %s\n", name,
+                scalar.mpixPerSec, vectorized.mpixPerSec, BenchCheck(scalar.hash == vectorized.hash) ? "yes" : "NO");
+#else
+            printf("%-16s | %14.1f | %14s | -\n", name, scalar.mpixPerSec, "n/a");
+#endif
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#include <cstdio>
+
+#include "bench.h"
+#include "presets.h"
+#include "rng.h"
+#include "session.h"
+#include "session_replay.h"
+#include "simulate.h"
+
+// Records simulated games of every preset and replays each one through a
+// fresh session: any change to spawning, expiry or hit testing shows up as
+// a mismatch here
+void BenchReplay() {
+    SimPlayer player;
+    player.reactionSdMs = 40.0f;
+    player.aimSpread = 0.6f;
+    player.missRate = 0.05f;
+
+    printf("%-12s %8s | %12s | %s\n", "preset", "games", "replays/s", "mismatched events / results");
+    for (int p = 0; p < g_presetCount; ++p) {
+        GameSettings settings;
+        ApplyPreset(settings, g_presets[p]);
+        FieldCache field;
+        UpdateFieldCache(field, 1920, 1080, settings.scale, settings.circleRadiusNorm, settings.cursorRadiusNorm);
+
+        SessionTrace trace;
+        FlicksSession recorder;
+        recorder.Configure(settings, field);
+        recorder.Seed(static_cast<uint64_t>(p) + 1);
+        recorder.SetTrace(&trace);
+        Rng rng(static_cast<uint64_t>(p) + 1, RNG_STREAM_PLAYER);
+
+        const int games = 200;
+        int eventMismatches = 0;
+        int resultMismatches = 0;
+        double replaySeconds = 0.0;
+        FlicksSession player2;
+        SessionReplay replay;
+        for (int i = 0; i < games; ++i) {
+            SimulateSession(recorder, player, rng);
+
+            BenchTimer timer;
+            replay.Load(trace);
+            replay.Begin(player2);
+            replay.Run();
+            replay.End();
+            replaySeconds += timer.Seconds();
+
+            const ReplayCheck check = replay.Check();
+            eventMismatches += !check.eventsMatch;
+            resultMismatches += !check.resultMatch;
+        }
+        printf("%-12s %8d | %12.0f | %d / %d\n", g_presets[p].name, games, games / replaySeconds,
+            eventMismatches, resultMismatches);
+        BenchCheck(eventMismatches == 0 && resultMismatches == 0);
+    }
+}
@@ -0,0 +1,79 @@
+#include <cstdio>
+#include <thread>
+
+#include "bench.h"
+#include "input.h"
+
+namespace {
+    // Synthetic mouse: event i carries timeUs = i so the consumer can check
+    // that nothing was lost, duplicated or reordered
+    struct RingRun {
+        long long received = 0;
+        long long outOfOrder = 0;
+        long long drains = 0;
+        long long maxBatch = 0;
+        double seconds = 0.0;
+    };
+
+    RingRun RunProducerConsumer(InputRing& ring, long long count, int consumerSpinUs) {
+        RingRun run;
+        BenchTimer timer;
+
+        std::thread producer([&ring, count] {
+            for (long long i = 0; i < count; ++i) {
+                InputEvent e{ i, 1, -1, (i & 1023) == 0 };
+                while (!ring.TryPush(e)) std::this_thread::yield();
+            }
+        });
+
+        long long expected = 0;
+        while (expected < count) {
+            long long batch = static_cast<long long>(ring.Drain([&](const InputEvent& e) {
+                if (e.timeUs != expected) run.outOfOrder++;
+                expected = e.timeUs + 1;
+                run.received++;
+            }));
+            if (batch == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            run.drains++;
+            if (batch > run.maxBatch) run.maxBatch = batch;
+
+            // Stand-in for the rest of a frame
+            if (consumerSpinUs > 0) {
+                BenchTimer frame;
+                while (frame.Seconds() * 1e6 < consumerSpinUs) {}
+            }
+        }
+
+        producer.join();
+        run.seconds = timer.Seconds();
+        return run;
+    }
+}
+
+void BenchInputRing() {
+    static InputRing ring;
+
+    // Fill with no consumer: exactly Capacity pushes succeed
+    long long accepted = 0;
+    for (size_t i = 0; i < InputRing::GetCapacity() * 2; ++i) {
+        if (ring.TryPush(InputEvent{ static_cast<long long>(i), 0, 0, false })) accepted++;
+    }
+    long long drained = static_cast<long long>(ring.Drain([](const InputEvent&) {}));
+    printf("capacity %zu: accepted %lld, drained %lld\n", InputRing::GetCapacity(), accepted, drained);
+    BenchCheck(accepted == static_cast<long long>(InputRing::GetCapacity()) && drained == accepted);
+
+    const long long count = 5000000;
+    RingRun busy = RunProducerConsumer(ring, count, 0);
+    printf("busy consumer:  %lld events in %.3f s, %.1f M events/s, %lld drains (max batch %lld), %lld out of order\n",
+        busy.received, busy.seconds, busy.received / busy.seconds / 1e6, busy.drains, busy.maxBatch, busy.outOfOrder);
+    BenchCheck(busy.outOfOrder == 0);
+
+    // Consumer that only drains once per 250 us "frame", like a 4 kHz game loop
+    RingRun framed = RunProducerConsumer(ring, count / 5, 250);
+    printf("framed consumer: %lld events in %.3f s, %.1f M events/s, %lld drains (max batch %lld), %lld out of order\n",
+        framed.received, framed.seconds, framed.received / framed.seconds / 1e6, framed.drains, framed.maxBatch, framed.outOfOrder);
+    BenchCheck(framed.outOfOrder == 0);
+}
@@ -0,0 +1,51 @@
+#include <cstdio>
+
+#include "bench.h"
+#include "field.h"
+#include "loadgen.h"
+#include "presets.h"
+#include "session.h"
+#include "simulate.h"
+
+void BenchSession() {
+    GameSettings settings;
+    FieldCache field;
+    UpdateFieldCache(field, 1920, 1080, settings.scale, settings.circleRadiusNorm, settings.cursorRadiusNorm);
+
+    FlicksSession session;
+    session.Configure(settings, field);
+    session.Seed(1);
+
+    SimPlayer player;
+    Rng rng(1, RNG_STREAM_PLAYER);
+    const int sessionCount = 20000;
+    long long hits = 0;
+
+    BenchTimer timer;
+    for (int i = 0; i < sessionCount; ++i) {
+        hits += SimulateSession(session, player, rng).hits;
+    }
+    double seconds = timer.Seconds();
+
+    printf("%d sessions in %.3f s: %.0f sessions/s (%.0f hits/s)\n",
+        sessionCount, seconds, sessionCount / seconds, hits / seconds);
+}
+
+void BenchLoadGen() {
+    LoadGenConfig config;
+    config.sessions = 20000;
+    config.player.reactionMs = 190.0f;
+    config.player.reactionSdMs = 25.0f;
+    config.player.aimSpread = 0.35f;
+    config.player.missRate = 0.05f;
+
+    for (int i = 0; i < g_presetCount; ++i) {
+        ApplyPreset(config.settings, g_presets[i]);
+        UpdateFieldCache(config.field, 1920, 1080,
+            config.settings.scale, config.settings.circleRadiusNorm, config.settings.cursorRadiusNorm);
+
+        LoadGenReport r = RunLoadGen(config);
+        printf("%-12s %d threads: %10.0f sessions/s, score p50 %.1f (p10 %.1f, p90 %.1f)\n",
+            g_presets[i].name, r.threads, r.sessionsPerSec, r.score.p50, r.score.p10, r.score.p90);
+    }
+}
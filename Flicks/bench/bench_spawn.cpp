@@ -0,0 +1,81 @@
+#include <cstdio>
+
+#include "bench.h"
+#include "spawn_sampler.h"
+
+namespace {
+    struct SamplerVariant {
+        const char* name;
+        SpawnSamplerKind kind;
+        bool vectorized;
+    };
+
+    const SamplerVariant g_variants[] = {
+        { "polar", SPAWN_SAMPLER_POLAR, false },
+        { "batch-scalar", SPAWN_SAMPLER_BATCH, false },
+#ifdef FLICKS_SSE2
+        { "batch-sse2", SPAWN_SAMPLER_BATCH, true },
+#endif
+        { "analytic", SPAWN_SAMPLER_ANALYTIC, false },
+    };
+
+    // Chains samples like a game does: each one keeps away from the previous one
+    long long RunChain(SpawnSampler& sampler, float minDistance, int count, float& checksum) {
+        float x = 0.0f, y = 0.0f;
+        long long fallbacks = 0;
+        for (int i = 0; i < count; ++i) {
+            if (!sampler.Sample(x, y, minDistance, i == 0, x, y)) fallbacks++;
+            checksum += x + y;
+        }
+        return fallbacks;
+    }
+
+    bool SameSequence(float minDistance, int count) {
+        SpawnSampler a, b;
+        a.Seed(7, RNG_STREAM_POSITION);
+        b.Seed(7, RNG_STREAM_POSITION);
+        a.SetVectorized(true);
+        b.SetVectorized(false);
+        float ax = 0.0f, ay = 0.0f, bx = 0.0f, by = 0.0f;
+        for (int i = 0; i < count; ++i) {
+            a.Sample(ax, ay, minDistance, i == 0, ax, ay);
+            b.Sample(bx, by, minDistance, i == 0, bx, by);
+            if (ax != bx || ay != by) return false;
+        }
+        return true;
+    }
+}
+
+void BenchSpawnSampler() {
+    const float ratios[] = { 0.0f, 0.2f, 0.4f, 0.5f, 0.6f, 0.7f, 0.8f, 0.9f, 1.0f };
+    const int count = 1000000;
+
+    printf("%-6s", "ratio");
+    for (const SamplerVariant& v : g_variants) printf(" | %-14s", v.name);
+    printf("   (samples/ns, fallback rate)\n");
+
+    float checksum = 0.0f;
+    for (float ratio : ratios) {
+        const float minDistance = 2.0f * ratio;
+        printf("%-6.2f", ratio);
+        for (const SamplerVariant& v : g_variants) {
+            SpawnSampler sampler;
+            sampler.Seed(1, RNG_STREAM_POSITION);
+            sampler.SetKind(v.kind);
+            sampler.SetVectorized(v.vectorized);
+
+            BenchTimer timer;
+            long long fallbacks = RunChain(sampler, minDistance, count, checksum);
+            double ns = timer.Seconds() * 1e9;
+            printf(" | %6.4f %6.2f%%", count / ns, 100.0 * fallbacks / count);
+        }
+        printf("\n");
+    }
+
+#ifdef FLICKS_SSE2
+    bool same = true;
+    for (float ratio : ratios) same = same && SameSequence(2.0f * ratio, 100000);
+    printf("batch-sse2 and batch-scalar sequences %s\n", BenchCheck(same) ? "match" : "DIFFER");
+#endif
+    printf("(checksum %.3f)\n", checksum);
+}
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "compat.h"
+#include "field.h"
+#include "history.h"
+#include "history_columns.h"
+#include "history_index.h"
+#include "rng.h"
+#include "session.h"
+#include "settings.h"
+#include "shader_cache.h"
+#include "soft_renderer.h"
+#include "startup.h"
+#include "wav.h"
+
+namespace {
+    struct StartupFiles {
+        std::string cfg, wav, log, cols, shaders;
+    };
+
+    const char* const kShaderNames[] = { "field_vs", "field_ps", "circle_vs", "circle_ps" };
+
+    // Sources the size of the real ones, each with bytecode already in the cache
+    void WriteTestShaders(const StartupFiles& files) {
+        std::filesystem::create_directories(files.shaders);
+        for (const char* name : kShaderNames) {
+            std::string source = std::string("// ") + name + "\n";
+            while (source.size() < 800) source += "float4 main(float4 pos : SV_POSITION) : SV_Target { return pos; }\n";
+            const std::string path = files.shaders + "/" + name + ".hlsl";
+            FILE* f;
+            if (fopen_s(&f, path.c_str(), "wb") != 0) continue;
+            fwrite(source.data(), 1, source.size(), f);
+            fclose(f);
+
+            const std::vector<uint8_t> bytecode(1500, static_cast<uint8_t>(source.size()));
+            const uint64_t hash = HashShaderSource(source.data(), source.size(), "ps_5_0");
+            StoreCachedShader((files.shaders + "/cache").c_str(), name, hash, bytecode.data(), bytecode.size());
+        }
+    }
+
+    // A second of 48 kHz stereo 16-bit PCM behind a LIST chunk the loader has to skip
+    void WriteTestWav(const char* path) {
+        const uint32_t rate = 48000, samples = rate, dataBytes = samples * 4;
+        const uint8_t list[12] = { 'L', 'I', 'S', 'T', 4, 0, 0, 0, 'I', 'N', 'F', 'O' };
+        const uint32_t riffSize = 4 + sizeof(list) + 8 + 16 + 8 + dataBytes;
+        FILE* f;
+        if (fopen_s(&f, path, "wb") != 0) return;
+        auto u32 = [f](uint32_t v) { fwrite(&v, 4, 1, f); };
+        auto u16 = [f](uint16_t v) { fwrite(&v, 2, 1, f); };
+        fwrite("RIFF", 4, 1, f); u32(riffSize); fwrite("WAVE", 4, 1, f);
+        fwrite(list, sizeof(list), 1, f);
+        fwrite("fmt ", 4, 1, f); u32(16); u16(1); u16(2); u32(rate); u32(rate * 4); u16(4); u16(16);
+        fwrite("data", 4, 1, f); u32(dataBytes);
+        std::vector<int16_t> pcm(samples * 2);
+        for (uint32_t i = 0; i < samples; ++i) pcm[i * 2] = pcm[i * 2 + 1] = static_cast<int16_t>((i * 97) & 0x3fff);
+        fwrite(pcm.data(), 2, pcm.size(), f);
+        fclose(f);
+    }
+
+    void WriteTestHistory(const StartupFiles& files, long long games) {
+        std::vector<GameSummary> summaries;
+        summaries.reserve(static_cast<size_t>(games));
+        Rng rng(3);
+        for (long long i = 0; i < games; ++i) {
+            GameSummary s = {};
+            s.circleRadiusNorm = 0.05f + 0.01f * static_cast<float>(rng.NextInt(0, 7));
+            s.cursorRadiusNorm = 0.015f;
+            s.circleLifetimeMs = 300;
+            s.gameTimeSec = 60;
+            s.hits = static_cast<int>(rng.NextInt(100, 400));
+            s.avgReactionTime = rng.NextFloat(150.0f, 350.0f);
+            s.score = static_cast<float>(s.hits);
+            s.timestamp = 1700000000 + i * 70;
+            summaries.push_back(s);
+        }
+        WriteGameHistory(summaries, files.log.c_str());
+        // The snapshot a previous start left behind
+        HistoryColumns columns;
+        columns.Open(files.log.c_str(), files.cols.c_str());
+    }
+
+    // The stages of wWinMain that do not need Windows. The first frame of the
+    // software renderer stands in for the device and shaders, on the calling
+    // thread like them.
+    struct PortableStartup {
+        GameSettings settings;
+        PcmSound sound;
+        HistoryColumns columns;
+        HistoryIndex index;
+        FieldCache field;
+        FlicksSession session;
+        SoftRenderer renderer{ 1920, 1080 };
+        std::vector<uint8_t> shaderCode[4];
+
+        StartupGraph Build(const StartupFiles& files) {
+            StartupGraph graph;
+            const int settingsStage = graph.Add("settings", [this, &files] {
+                LoadColorSettings(settings, files.cfg.c_str());
+                return true;
+            });
+            // What a dev build does instead of D3DCompile when no shader changed;
+            // release builds skip even this and use the embedded bytecode
+            graph.Add("shader cache", [this, &files] {
+                const std::string cacheDir = files.shaders + "/cache";
+                for (int i = 0; i < 4; ++i) {
+                    std::vector<uint8_t> source;
+                    const std::string path = files.shaders + "/" + kShaderNames[i] + ".hlsl";
+                    if (!ReadFileBytes(path.c_str(), source)) return false;
+                    const uint64_t hash = HashShaderSource(source.data(), source.size(), "ps_5_0");
+                    if (!LoadCachedShader(cacheDir.c_str(), kShaderNames[i], hash, shaderCode[i])) return false;
+                }
+                return true;
+            });
+            graph.Add("hit sound", [this, &files] { return LoadWav(files.wav.c_str(), sound); });
+            graph.Add("history", [this, &files] {
+                if (!columns.Open(files.log.c_str(), files.cols.c_str())) return false;
+                index.Build(columns);
+                return true;
+            });
+            const int fieldStage = graph.Add("field", [this] {
+                UpdateFieldCache(field, 1920, 1080, settings.scale, settings.circleRadiusNorm, settings.cursorRadiusNorm);
+                return true;
+            }, { settingsStage });
+            graph.Add("first frame", [this] {
+                const float clear[4] = { 0.1f, 0.1f, 0.12f, 1.0f };
+                renderer.BeginFrame(clear);
+                renderer.DrawField(field, ImVec4(0.2f, 0.2f, 0.25f, 1.0f));
+                renderer.EndFrame();
+                return true;
+            }, { fieldStage }, true);
+            graph.Add("session", [this] {
+                session.Configure(settings, field);
+                session.Reset(1);
+                return true;
+            }, { settingsStage, fieldStage }, true);
+            return graph;
+        }
+    };
+}
+
+// The portable startup stages run one after another and as a graph on
+// worker threads, from files on disk like a second start of the app
+void BenchStartup() {
+    const std::string dir = (std::filesystem::temp_directory_path() / "flicks_bench_startup").string();
+    std::filesystem::create_directories(dir);
+    StartupFiles files = { dir + "/cfg.ini", dir + "/hit.wav", dir + "/history.bin", dir + "/history.cols", dir + "/shaders" };
+    SaveColorSettings(GameSettings(), files.cfg.c_str());
+    WriteTestShaders(files);
+    WriteTestWav(files.wav.c_str());
+    const long long games = 2000000;
+    WriteTestHistory(files, games);
+
+    const int workers = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()) - 1);
+    const int rounds = 5;
+    printf("%lld games in the history, %d workers, best of %d\n", games, workers, rounds);
+
+    std::string report;
+    for (int parallel = 0; parallel < 2; ++parallel) {
+        long long bestUs = -1;
+        bool ok = true;
+        for (int r = 0; r < rounds; ++r) {
+            PortableStartup app;
+            StartupGraph graph = app.Build(files);
+            ok = graph.Run(parallel ? workers : 0) && ok;
+            if (bestUs < 0 || graph.GetTotalUs() < bestUs) {
+                bestUs = graph.GetTotalUs();
+                report = graph.FormatReport();
+            }
+        }
+        printf("%-8s %8.2f ms%s\n", parallel ? "graph" : "serial", bestUs / 1000.0, BenchCheck(ok) ? "" : "  (a stage failed)");
+    }
+    printf("%s", report.c_str());
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
@@ -0,0 +1,38 @@
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "bench.h"
+#include "rng.h"
+#include "stream_stats.h"
+
+namespace {
+    // Reaction times look log-normal: a hard floor and a long slow tail
+    double NextReactionMs(Rng& rng) {
+        return 120.0 + std::exp(rng.NextNormal(4.3f, 0.45f));
+    }
+}
+
+void BenchStreamStats() {
+    const int counts[] = { 50, 1000, 1000000 };
+
+    printf("%-8s | %-9s | %-26s | %-26s | %-8s\n", "values", "ns/add", "p50 / p90 / p99 estimate", "p50 / p90 / p99 exact", "mean err");
+    for (int count : counts) {
+        Rng rng(static_cast<uint64_t>(count), RNG_STREAM_PLAYER);
+        std::vector<double> values(count);
+        for (double& v : values) v = NextReactionMs(rng);
+
+        StreamStats stats;
+        BenchTimer timer;
+        for (double v : values) stats.Add(v);
+        const double ns = timer.Seconds() * 1e9 / count;
+
+        double sum = 0.0;
+        for (double v : values) sum += v;
+        const Quantiles estimate = stats.GetQuantiles();
+        const Quantiles exact = ExactQuantiles(values);
+        printf("%-8d | %9.1f | %7.1f / %7.1f / %7.1f | %7.1f / %7.1f / %7.1f | %.2e\n", count, ns,
+            estimate.p50, estimate.p90, estimate.p99, exact.p50, exact.p90, exact.p99,
+            std::fabs(stats.moments.GetMean() - sum / count));
+    }
+}
@@ -0,0 +1,104 @@
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "bench.h"
+#include "rng.h"
+#include "session.h"
+#include "session_trace.h"
+#include "simulate.h"
+
+namespace {
+    // One minute of an 8 kHz mouse: small deltas with a flick toward a new
+    // target every 250 ms and a click at the end of each flick
+    std::vector<TraceEvent> MakeSyntheticGame(const FieldCache& field, Rng& rng) {
+        std::vector<TraceEvent> events;
+        const long long reportUs = 125;
+        const long long gameUs = 60 * 1000000LL;
+        for (long long t = 0; t < gameUs; t += reportUs) {
+            const long long phase = t % 250000;
+            if (phase == 0) {
+                events.push_back({ TRACE_SPAWN, 0, 0, 0,
+                    field.center.x + rng.NextFloat() * 400.0f, field.center.y - rng.NextFloat() * 400.0f, t });
+            }
+            const bool flicking = phase < 60000;
+            const int dx = static_cast<int>(flicking ? rng.NextNormal(12.0f, 4.0f) : rng.NextNormal(0.0f, 1.0f));
+            const int dy = static_cast<int>(flicking ? rng.NextNormal(-6.0f, 3.0f) : rng.NextNormal(0.0f, 1.0f));
+            events.push_back({ TRACE_MOVE, 0, dx, dy, 0.0f, 0.0f, t + static_cast<long long>(rng.NextFloat() * 20.0f) });
+            if (phase == 60000) {
+                events.push_back({ TRACE_CLICK, FlicksSession::CLICK_HIT, 0, 0, field.center.x, field.center.y, t });
+            }
+        }
+        events.push_back({ TRACE_END, 0, 0, 0, 0.0f, 0.0f, gameUs });
+        return events;
+    }
+
+    void Record(SessionTrace& trace, const TraceEvent& e) {
+        switch (e.type) {
+        case TRACE_SPAWN: trace.RecordSpawn(e.x, e.y, e.timeUs); break;
+        case TRACE_EXPIRE: trace.RecordExpire(e.timeUs); break;
+        case TRACE_MOVE: trace.RecordMove(e.dx, e.dy, e.timeUs); break;
+        case TRACE_CLICK: trace.RecordClick(e.x, e.y, e.detail, e.timeUs); break;
+        case TRACE_LAST: trace.RecordLast(e.detail != 0, e.timeUs); break;
+        case TRACE_END: trace.RecordEnd(GameResult(), e.detail != 0, e.timeUs); break;
+        }
+    }
+
+    bool SameEvent(const TraceEvent& a, const TraceEvent& b) {
+        const float tolerance = 0.5f / SessionTrace::kPosScale;
+        return a.type == b.type && a.detail == b.detail && a.dx == b.dx && a.dy == b.dy && a.timeUs == b.timeUs &&
+            std::fabs(a.x - b.x) <= tolerance && std::fabs(a.y - b.y) <= tolerance;
+    }
+
+    double SessionsPerSec(FlicksSession& session, const SimPlayer& player, int count) {
+        Rng rng(7, RNG_STREAM_PLAYER);
+        BenchTimer timer;
+        for (int i = 0; i < count; ++i) SimulateSession(session, player, rng);
+        return count / timer.Seconds();
+    }
+}
+
+void BenchSessionTrace() {
+    GameSettings settings;
+    FieldCache field;
+    UpdateFieldCache(field, 1920, 1080, settings.scale, settings.circleRadiusNorm, settings.cursorRadiusNorm);
+    Rng rng(3, RNG_STREAM_PLAYER);
+    const std::vector<TraceEvent> input = MakeSyntheticGame(field, rng);
+
+    SessionTrace trace;
+    trace.Begin(1, settings, field, 0);
+    BenchTimer encodeTimer;
+    for (const TraceEvent& e : input) Record(trace, e);
+    const double encodeSec = encodeTimer.Seconds();
+
+    std::vector<TraceEvent> decoded;
+    decoded.reserve(trace.GetEventCount());
+    BenchTimer decodeTimer;
+    bool roundTrip = DecodeSessionTrace(trace.GetData(), trace.GetSize(), trace.GetHeader().startTimeUs, decoded);
+    const double decodeSec = decodeTimer.Seconds();
+    roundTrip = roundTrip && decoded.size() == input.size();
+    for (size_t i = 0; roundTrip && i < input.size(); ++i) roundTrip = SameEvent(input[i], decoded[i]);
+
+    const double count = static_cast<double>(input.size());
+    printf("60 s at 8 kHz: %u events, %zu bytes (%.2f bytes/event, %.0f KB/s of game)%s\n",
+        trace.GetEventCount(), trace.GetSize(), trace.GetSize() / count, trace.GetSize() / 60.0 / 1024.0,
+        trace.IsTruncated() ? ", truncated" : "");
+    printf("encode %.1f ns/event, decode %.1f ns/event, round trip %s\n",
+        encodeSec * 1e9 / count, decodeSec * 1e9 / count, BenchCheck(roundTrip) ? "ok" : "MISMATCH");
+
+    // Cost of recording spawns, expiries and clicks inside the simulated session
+    SimPlayer player;
+    player.reactionSdMs = 40.0f;
+    player.aimSpread = 0.4f;
+
+    FlicksSession session;
+    session.Configure(settings, field);
+    session.Seed(11);
+    const int sessions = 20000;
+    SessionsPerSec(session, player, sessions / 10);
+    const double plain = SessionsPerSec(session, player, sessions);
+    session.SetTrace(&trace);
+    const double traced = SessionsPerSec(session, player, sessions);
+    printf("simulated sessions/s: %.0f untraced, %.0f traced (%.1f%% slower)\n",
+        plain, traced, 100.0 * (plain - traced) / plain);
+}
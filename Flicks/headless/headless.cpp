@@ -0,0 +1,262 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "settings.h"
+#include "field.h"
+#include "loadgen.h"
+#include "presets.h"
+#include "scene.h"
+#include "session.h"
+#include "session_replay.h"
+#include "soft_renderer.h"
+#include "history.h"
+
+namespace {
+    struct Options {
+        const char* cfgPath = "res/cfg.ini";
+        const char* savePath = nullptr;
+        const char* preset = nullptr;
+        const char* framePath = nullptr;
+        const char* replayPath = nullptr;
+        const char* recordPath = nullptr;
+        double replaySpeed = 0.0;
+        int width = 1920;
+        int height = 1080;
+        long long sessions = 1;
+        int threads = 0;
+        uint64_t seed = 1;
+        bool sharedSchedule = false;
+        SimPlayer player;
+    };
+
+    void PrintUsage() {
+        printf(
+            "Usage: flicks_headless [options]\n"
+            "  --cfg <path>          settings file (default res/cfg.ini)\n"
+            "  --preset <name|all>   override the settings with a preset, or run every preset\n"
+            "  --size <w> <h>        virtual screen size (default 1920 1080)\n"
+            "  --sessions <n>        number of games to simulate per configuration (default 1)\n"
+            "  --threads <n>         worker threads (default: one per hardware thread)\n"
+            "  --seed <n>            base RNG seed (default 1)\n"
+            "  --shared-schedule     every game gets the same targets, derived from --seed\n"
+            "  --save <path>         append the summaries to a game history log (res/game_history.bin)\n"
+            "  --frame <path.ppm>    render the first target of game --seed on the CPU, print its hash and exit\n"
+            "  --record <path.flkt>  play one game with the player model and save its trace\n"
+            "  --replay <path.flkt>  replay a recorded game and check it against the recording\n"
+            "                        (exit 2 if it differs, 3 if it was recorded under other rules)\n"
+            "  --speed <x>           replay pace, rendering 60 frames/s on the CPU (default 0: as fast as possible, no rendering)\n"
+            "Player model:\n"
+            "  --reaction <ms>       mean reaction time (default 200)\n"
+            "  --reaction-sd <ms>    reaction time spread (default 0)\n"
+            "  --aim <radii>         landing point spread in hit radii (default 0)\n"
+            "  --miss-rate <p>       chance a flick misses regardless of aim (default 0)\n"
+            "  --correction <ms>     delay before re-clicking after a miss (default 80)\n");
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& opt) {
+        for (int i = 1; i < argc; ++i) {
+            const char* arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (strcmp(arg, "--cfg") == 0 && hasValue) opt.cfgPath = argv[++i];
+            else if (strcmp(arg, "--save") == 0 && hasValue) opt.savePath = argv[++i];
+            else if (strcmp(arg, "--preset") == 0 && hasValue) opt.preset = argv[++i];
+            else if (strcmp(arg, "--frame") == 0 && hasValue) opt.framePath = argv[++i];
+            else if (strcmp(arg, "--replay") == 0 && hasValue) opt.replayPath = argv[++i];
+            else if (strcmp(arg, "--record") == 0 && hasValue) opt.recordPath = argv[++i];
+            else if (strcmp(arg, "--speed") == 0 && hasValue) opt.replaySpeed = atof(argv[++i]);
+            else if (strcmp(arg, "--size") == 0 && i + 2 < argc) {
+                opt.width = atoi(argv[++i]);
+                opt.height = atoi(argv[++i]);
+            }
+            else if (strcmp(arg, "--sessions") == 0 && hasValue) opt.sessions = atoll(argv[++i]);
+            else if (strcmp(arg, "--threads") == 0 && hasValue) opt.threads = atoi(argv[++i]);
+            else if (strcmp(arg, "--seed") == 0 && hasValue) opt.seed = strtoull(argv[++i], nullptr, 10);
+            else if (strcmp(arg, "--shared-schedule") == 0) opt.sharedSchedule = true;
+            else if (strcmp(arg, "--reaction") == 0 && hasValue) opt.player.reactionMs = static_cast<float>(atof(argv[++i]));
+            else if (strcmp(arg, "--reaction-sd") == 0 && hasValue) opt.player.reactionSdMs = static_cast<float>(atof(argv[++i]));
+            else if (strcmp(arg, "--aim") == 0 && hasValue) opt.player.aimSpread = static_cast<float>(atof(argv[++i]));
+            else if (strcmp(arg, "--miss-rate") == 0 && hasValue) opt.player.missRate = static_cast<float>(atof(argv[++i]));
+            else if (strcmp(arg, "--correction") == 0 && hasValue) opt.player.correctionMs = static_cast<float>(atof(argv[++i]));
+            else return false;
+        }
+        return opt.sessions > 0 && opt.width > 0 && opt.height > 0 && opt.replaySpeed >= 0.0;
+    }
+
+    void PrintReport(const char* name, const LoadGenReport& r) {
+        printf("%-12s %10lld %8.3f %12.0f | score %8.1f +- %-7.1f [%7.1f %7.1f %7.1f] | hits %6.1f | rt %6.1f ms | acc %5.1f%%",
+            name, r.sessions, r.seconds, r.sessionsPerSec,
+            r.score.mean, r.score.stddev, r.score.p10, r.score.p50, r.score.p90,
+            r.hits.mean, r.avgReactionTime, r.accuracy);
+        if (r.spawnFallbacks > 0) printf(" | %lld spawn fallbacks", r.spawnFallbacks);
+        printf("\n");
+    }
+
+    // Golden frame: the game with the given seed at its first spawn, cursor at the center
+    int RenderFrame(const Options& opt, const GameSettings& settings) {
+        FieldCache field;
+        UpdateFieldCache(field, opt.width, opt.height, settings.scale, settings.circleRadiusNorm, settings.cursorRadiusNorm);
+
+        FlicksSession session;
+        session.Configure(settings, field);
+        session.Reset(opt.seed);
+        session.Start(0);
+        session.Tick(session.GetNextEventTimeUs());
+
+        SoftRenderer renderer(opt.width, opt.height);
+        DrawScene(renderer, session, field, settings, &field.center);
+
+        if (!renderer.WritePpm(opt.framePath)) {
+            fprintf(stderr, "Could not write %s\n", opt.framePath);
+            return 1;
+        }
+        printf("%s %dx%d seed %llu hash %016llx\n", opt.framePath, opt.width, opt.height,
+            static_cast<unsigned long long>(opt.seed), static_cast<unsigned long long>(renderer.Hash()));
+        return 0;
+    }
+
+    int RecordTrace(const Options& opt, const GameSettings& settings) {
+        FieldCache field;
+        UpdateFieldCache(field, opt.width, opt.height, settings.scale, settings.circleRadiusNorm, settings.cursorRadiusNorm);
+
+        SessionTrace trace;
+        FlicksSession session;
+        session.Configure(settings, field);
+        session.Seed(opt.seed);
+        session.SetTrace(&trace);
+        Rng rng(opt.seed, RNG_STREAM_PLAYER);
+        const GameResult& r = SimulateSession(session, opt.player, rng);
+
+        if (!trace.Write(opt.recordPath)) {
+            fprintf(stderr, "Could not write %s\n", opt.recordPath);
+            return 1;
+        }
+        printf("%s seed %016llx: hits %d/%d, score %.3f, %u events in %zu bytes\n", opt.recordPath,
+            static_cast<unsigned long long>(r.seed), r.hits, r.attempts, r.score, trace.GetEventCount(), trace.GetSize());
+        return 0;
+    }
+
+    // Replays a recorded game and checks that the current code reproduces it
+    int ReplayTrace(const Options& opt, const GameSettings& baseSettings) {
+        SessionReplay replay;
+        if (!replay.Load(opt.replayPath)) {
+            fprintf(stderr, "%s is missing or not a valid session trace\n", opt.replayPath);
+            return 1;
+        }
+
+        FlicksSession session;
+        replay.Begin(session, baseSettings);
+        long long frames = 0;
+        uint64_t lastHash = 0;
+        if (opt.replaySpeed <= 0.0) {
+            replay.Run();
+        }
+        else {
+            // The recorded screen: the field is centered on it
+            const FieldCache& field = replay.GetField();
+            const int width = static_cast<int>(field.fieldTL.x * 2.0f + field.fieldSize + 0.5f);
+            const int height = static_cast<int>(field.fieldTL.y * 2.0f + field.fieldSize + 0.5f);
+            SoftRenderer renderer(width, height);
+
+            const auto frameTime = std::chrono::microseconds(16667);
+            const long long frameTraceUs = static_cast<long long>(16667 * opt.replaySpeed);
+            auto nextFrame = std::chrono::steady_clock::now();
+            for (long long t = replay.GetStartTimeUs(); !replay.AdvanceTo(t); t += frameTraceUs) {
+                const ImVec2 cursor = replay.GetCursorPos();
+                DrawScene(renderer, session, field, replay.GetSettings(), &cursor);
+                lastHash = renderer.Hash();
+                frames++;
+                nextFrame += frameTime;
+                std::this_thread::sleep_until(nextFrame);
+            }
+        }
+        replay.End();
+
+        const ReplayCheck check = replay.Check();
+        const GameResult& r = replay.GetResult();
+        const TraceHeader& h = replay.GetHeader();
+        printf("%s seed %016llx, %.3f s of play\n", opt.replayPath, static_cast<unsigned long long>(h.seed),
+            (replay.GetEndTimeUs() - replay.GetStartTimeUs()) / 1e6);
+        printf("recorded: hits %d/%d, rt %.3f ms, score %.3f\n",
+            check.recorded.hits, check.recorded.attempts, check.recorded.avgReactionTime, check.recorded.score);
+        printf("replayed: hits %d/%d, rt %.3f ms, score %.3f\n", r.hits, r.attempts, r.avgReactionTime, r.score);
+        if (frames > 0) printf("rendered %lld frames at %.2fx, last frame hash %016llx\n",
+            frames, opt.replaySpeed, static_cast<unsigned long long>(lastHash));
+        if (h.truncated) printf("the recording is truncated\n");
+        if (!check.sameRules) {
+            printf("recorded under %s rules (version %u, now %u), so it cannot be checked\n",
+                h.rulesVersion < FlicksSession::kRulesVersion ? "older" : "newer", h.rulesVersion, FlicksSession::kRulesVersion);
+            return 3;
+        }
+        if (check.firstMismatch >= 0) printf("events differ from game event %d on\n", check.firstMismatch);
+        printf("events %s, result %s\n", check.eventsMatch ? "match" : "DIFFER", check.resultMatch ? "matches" : "DIFFERS");
+        return check.eventsMatch && check.resultMatch ? 0 : 2;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!ParseOptions(argc, argv, opt)) {
+        PrintUsage();
+        return 1;
+    }
+
+    GameSettings baseSettings;
+    LoadColorSettings(baseSettings, opt.cfgPath);
+
+    std::vector<const GamePreset*> runs;
+    if (opt.preset && strcmp(opt.preset, "all") == 0) {
+        for (int i = 0; i < g_presetCount; ++i) runs.push_back(&g_presets[i]);
+    }
+    else if (opt.preset) {
+        const GamePreset* preset = FindPreset(opt.preset);
+        if (!preset) {
+            fprintf(stderr, "Unknown preset: %s\n", opt.preset);
+            return 1;
+        }
+        runs.push_back(preset);
+    }
+    else {
+        runs.push_back(nullptr);
+    }
+
+    if (opt.replayPath) return ReplayTrace(opt, baseSettings);
+
+    if (opt.framePath || opt.recordPath) {
+        GameSettings settings = baseSettings;
+        if (!runs.empty() && runs[0]) ApplyPreset(settings, *runs[0]);
+        return opt.framePath ? RenderFrame(opt, settings) : RecordTrace(opt, settings);
+    }
+
+    GameHistory history;
+    if (opt.savePath) {
+        if (!history.Open(opt.savePath, nullptr)) {
+            fprintf(stderr, "Could not open history log %s\n", opt.savePath);
+            return 1;
+        }
+    }
+
+    printf("%-12s %10s %8s %12s | score mean +- sd [p10 p50 p90]\n", "config", "sessions", "sec", "sessions/s");
+    for (const GamePreset* preset : runs) {
+        LoadGenConfig config;
+        config.settings = baseSettings;
+        if (preset) ApplyPreset(config.settings, *preset);
+        UpdateFieldCache(config.field, opt.width, opt.height,
+            config.settings.scale, config.settings.circleRadiusNorm, config.settings.cursorRadiusNorm);
+        config.player = opt.player;
+        config.sessions = opt.sessions;
+        config.threads = opt.threads;
+        config.seed = opt.seed;
+        config.sharedSchedule = opt.sharedSchedule;
+        config.keepSummaries = (opt.savePath != nullptr);
+
+        LoadGenReport report = RunLoadGen(config);
+        PrintReport(preset ? preset->name : "cfg", report);
+        if (opt.savePath) history.Append(report.summaries.data(), report.summaries.size());
+    }
+
+    return 0;
+}
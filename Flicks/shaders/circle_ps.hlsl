@@ -0,0 +1,7 @@
+float4 main(float4 pos : SV_POSITION, float2 worldPos : TEXCOORD0,
+    nointerpolation float4 circle : TEXCOORD1, nointerpolation float4 color : COLOR0) : SV_Target {
+    float2 delta = worldPos - circle.xy;
+    float dist = length(delta);
+    float alpha = saturate( (circle.z - dist) / circle.w );
+    return float4(color.rgb, color.a * alpha);
+}
@@ -0,0 +1,32 @@
+cbuffer Transform : register(b0)
+{
+    float4 scale;
+    float4 translate;
+    float4 windowSize;
+};
+struct VS_INPUT
+{
+    float2 pos : POSITION;
+    float4 circle : CIRCLE;     // center.xy, radius, featherWidth
+    float4 color : COLOR;
+};
+struct VS_OUTPUT
+{
+    float4 pos : SV_POSITION;
+    float2 worldPos : TEXCOORD0;
+    nointerpolation float4 circle : TEXCOORD1;
+    nointerpolation float4 color : COLOR0;
+};
+VS_OUTPUT main(VS_INPUT input)
+{
+    VS_OUTPUT output;
+    float2 worldPos = input.circle.xy + (input.pos * 2.0 - 1.0) * input.circle.z;
+    output.worldPos = worldPos;
+    output.pos = float4(
+        (worldPos.x / windowSize.x) * 2.0 - 1.0,
+        (worldPos.y / windowSize.y) * -2.0 + 1.0,
+        0.0, 1.0);
+    output.circle = input.circle;
+    output.color = input.color;
+    return output;
+}
@@ -0,0 +1,8 @@
+cbuffer PS_Field : register(b0)
+{
+    float4 color;
+};
+float4 main() : SV_Target
+{
+    return color;
+}
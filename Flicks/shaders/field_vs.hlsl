@@ -0,0 +1,26 @@
+cbuffer Transform : register(b0)
+{
+    float4 scale;
+    float4 translate;
+    float4 windowSize;
+};
+struct VS_INPUT
+{
+    float2 pos : POSITION;
+};
+struct VS_OUTPUT
+{
+    float4 pos : SV_POSITION;
+    float2 worldPos : TEXCOORD0;
+};
+VS_OUTPUT main(VS_INPUT input)
+{
+    VS_OUTPUT output;
+    float2 worldPos = input.pos * scale.xy + translate.xy;
+    output.worldPos = worldPos;
+    output.pos = float4(
+        (worldPos.x / windowSize.x) * 2.0 - 1.0,
+        (worldPos.y / windowSize.y) * -2.0 + 1.0,
+        0.0, 1.0);
+    return output;
+}
@@ -0,0 +1,158 @@
+#include "audio_mixer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "simd.h"
+
+#ifdef FLICKS_SSE2
+#include <emmintrin.h>
+#endif
+
+// Both paths evaluate out + src * gain per float in the same voice order (no
+// FMA), so SSE2 and scalar mixes are bit-identical.
+namespace {
+    float DecodeSample(const uint8_t* p, int bits) {
+        switch (bits) {
+        case 8: return (static_cast<int>(p[0]) - 128) / 128.0f;
+        case 16: return static_cast<int16_t>(p[0] | p[1] << 8) / 32768.0f;
+        case 24: return static_cast<int32_t>(static_cast<uint32_t>(p[0] << 8 | p[1] << 16) | static_cast<uint32_t>(p[2]) << 24) / 2147483648.0f;
+        default: return static_cast<int32_t>(static_cast<uint32_t>(p[0] | p[1] << 8 | p[2] << 16) | static_cast<uint32_t>(p[3]) << 24) / 2147483648.0f;
+        }
+    }
+
+    void MixSpanScalar(float* out, const float* src, int count, float gain) {
+        for (int i = 0; i < count; ++i) out[i] += src[i] * gain;
+    }
+
+#ifdef FLICKS_SSE2
+    void MixSpanSse2(float* out, const float* src, int count, float gain) {
+        const __m128 g = _mm_set1_ps(gain);
+        int i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m128 a = _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_loadu_ps(src + i), g));
+            const __m128 b = _mm_add_ps(_mm_loadu_ps(out + i + 4), _mm_mul_ps(_mm_loadu_ps(src + i + 4), g));
+            _mm_storeu_ps(out + i, a);
+            _mm_storeu_ps(out + i + 4, b);
+        }
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+        }
+        MixSpanScalar(out + i, src + i, count - i, gain);
+    }
+#endif
+
+    int16_t ToPcm16(float v) {
+        v *= 32768.0f;
+        v = v < 32767.0f ? v : 32767.0f;
+        v = v > -32768.0f ? v : -32768.0f;
+        return static_cast<int16_t>(std::lrint(v));
+    }
+}
+
+int AudioMixer::AddSound(const PcmSound& pcm) {
+    const int bits = pcm.bitsPerSample;
+    if ((bits != 8 && bits != 16 && bits != 24 && bits != 32) || pcm.channels == 0 || pcm.sampleRate == 0 ||
+        pcm.blockAlign < pcm.channels * (bits / 8)) return -1;
+
+    // Decode to float stereo at the source rate: mono is copied to both sides,
+    // channels past the first two are dropped
+    const size_t frames = pcm.samples.size() / pcm.blockAlign;
+    const int bytes = bits / 8;
+    const int right = pcm.channels > 1 ? 1 : 0;
+    std::vector<float> decoded(frames * kChannels);
+    for (size_t i = 0; i < frames; ++i) {
+        const uint8_t* frame = pcm.samples.data() + i * pcm.blockAlign;
+        decoded[i * 2] = DecodeSample(frame, bits);
+        decoded[i * 2 + 1] = DecodeSample(frame + right * bytes, bits);
+    }
+
+    if (pcm.sampleRate == static_cast<uint32_t>(kSampleRate) || frames < 2) {
+        m_sounds.push_back(std::move(decoded));
+        return static_cast<int>(m_sounds.size()) - 1;
+    }
+
+    // Linear resampling; a hit sound is short enough that this stays a load-time cost
+    const double step = static_cast<double>(pcm.sampleRate) / kSampleRate;
+    const size_t outFrames = static_cast<size_t>(std::ceil(frames / step));
+    std::vector<float> resampled(outFrames * kChannels);
+    for (size_t i = 0; i < outFrames; ++i) {
+        const double pos = i * step;
+        const size_t i0 = std::min(static_cast<size_t>(pos), frames - 1);
+        const size_t i1 = std::min(i0 + 1, frames - 1);
+        const float t = static_cast<float>(pos - static_cast<double>(i0));
+        for (int c = 0; c < kChannels; ++c) {
+            const float a = decoded[i0 * 2 + c], b = decoded[i1 * 2 + c];
+            resampled[i * 2 + c] = a + (b - a) * t;
+        }
+    }
+    m_sounds.push_back(std::move(resampled));
+    return static_cast<int>(m_sounds.size()) - 1;
+}
+
+int AudioMixer::GetSoundFrames(int sound) const {
+    if (sound < 0 || sound >= GetSoundCount()) return 0;
+    return static_cast<int>(m_sounds[sound].size() / kChannels);
+}
+
+bool AudioMixer::Play(int sound, float gain) {
+    if (sound < 0 || sound >= GetSoundCount()) return false;
+    if (!m_queue.TryPush({ sound, gain })) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void AudioMixer::Start(const Command& command) {
+    const std::vector<float>& samples = m_sounds[command.sound];
+    if (samples.empty()) return;
+
+    Voice* voice;
+    if (m_voiceCount < kMaxVoices) {
+        voice = &m_voices[m_voiceCount++];
+    }
+    else {
+        voice = std::max_element(m_voices, m_voices + kMaxVoices,
+            [](const Voice& a, const Voice& b) { return a.position < b.position; });
+        m_stolen.fetch_add(1, std::memory_order_relaxed);
+    }
+    *voice = { samples.data(), static_cast<int>(samples.size() / kChannels), 0, command.gain };
+    m_played.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AudioMixer::Mix(float* out, int frames) {
+    m_queue.Drain([this](const Command& command) { Start(command); });
+
+    std::fill(out, out + static_cast<size_t>(frames) * kChannels, 0.0f);
+    for (int v = 0; v < m_voiceCount;) {
+        Voice& voice = m_voices[v];
+        const int count = std::min(frames, voice.frames - voice.position);
+        const float* src = voice.samples + static_cast<size_t>(voice.position) * kChannels;
+#ifdef FLICKS_SSE2
+        if (m_vectorized) MixSpanSse2(out, src, count * kChannels, voice.gain);
+        else
+#endif
+        MixSpanScalar(out, src, count * kChannels, voice.gain);
+
+        voice.position += count;
+        if (voice.position >= voice.frames) voice = m_voices[--m_voiceCount];
+        else ++v;
+    }
+    m_activeCount.store(m_voiceCount, std::memory_order_relaxed);
+}
+
+void MixToPcm16(const float* in, int16_t* out, int count) {
+    int i = 0;
+#ifdef FLICKS_SSE2
+    const __m128 scale = _mm_set1_ps(32768.0f);
+    const __m128 hi = _mm_set1_ps(32767.0f);
+    const __m128 lo = _mm_set1_ps(-32768.0f);
+    for (; i + 8 <= count; i += 8) {
+        const __m128 a = _mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(in + i), scale), hi), lo);
+        const __m128 b = _mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale), hi), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+#endif
+    for (; i < count; ++i) out[i] = ToPcm16(in[i]);
+}
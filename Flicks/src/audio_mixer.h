@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "spsc_ring.h"
+#include "wav.h"
+
+// Mixes one-shot sounds into interleaved float stereo for whatever drives the
+// output (the XAudio2 voice callback, or AudioFileSink off Windows). The game
+// thread only queues play commands into a ring: no device call, lock or
+// allocation in the frame that registers a hit. The audio thread drains the
+// ring at the start of every Mix, so a sound starts on the next device pass.
+class AudioMixer {
+public:
+    static const int kSampleRate = 48000;
+    static const int kChannels = 2;
+    static const int kMaxVoices = 64;
+    static const size_t kQueueCapacity = 256;
+
+    // Load time, before any thread calls Mix. Converts to the mix format
+    // (float stereo at kSampleRate) once; returns the sound id, or -1 if the
+    // format is not 8/16/24/32-bit PCM.
+    int AddSound(const PcmSound& pcm);
+    int GetSoundCount() const { return static_cast<int>(m_sounds.size()); }
+    int GetSoundFrames(int sound) const;
+
+    // Game thread only. False when the ring is full; the play is counted as
+    // dropped.
+    bool Play(int sound, float gain = 1.0f);
+
+    // Audio thread only: overwrites frames * kChannels floats. When all voices
+    // are busy a new sound takes over the one that has played longest.
+    void Mix(float* out, int frames);
+
+    void SetVectorized(bool vectorized) { m_vectorized = vectorized; }
+
+    int GetActiveVoices() const { return m_activeCount.load(std::memory_order_relaxed); }
+    long long GetPlayedCount() const { return m_played.load(std::memory_order_relaxed); }
+    long long GetDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+    long long GetStolenCount() const { return m_stolen.load(std::memory_order_relaxed); }
+
+private:
+    struct Command {
+        int sound;
+        float gain;
+    };
+    struct Voice {
+        const float* samples;   // interleaved, kChannels per frame
+        int frames;
+        int position;           // next frame to mix
+        float gain;
+    };
+
+    void Start(const Command& command);
+
+    std::vector<std::vector<float>> m_sounds;
+    SpscRing<Command, kQueueCapacity> m_queue;
+    Voice m_voices[kMaxVoices] = {};    // audio thread; the first m_voiceCount are playing
+    int m_voiceCount = 0;
+    bool m_vectorized = true;
+
+    std::atomic<int> m_activeCount{ 0 };
+    std::atomic<long long> m_played{ 0 };
+    std::atomic<long long> m_dropped{ 0 };
+    std::atomic<long long> m_stolen{ 0 };
+};
+
+// Saturating float [-1, 1] -> int16 for 16-bit outputs; SSE2 and scalar round
+// the same way (to nearest even)
+void MixToPcm16(const float* in, int16_t* out, int count);
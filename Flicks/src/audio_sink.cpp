@@ -0,0 +1,64 @@
+#include "audio_sink.h"
+#include "clock.h"
+#include "compat.h"
+
+#include <chrono>
+
+bool AudioFileSink::Start(AudioMixer& mixer, const char* wavPath) {
+    Stop();
+    if (wavPath) {
+        if (fopen_s(&m_file, wavPath, "wb") != 0) {
+            m_file = nullptr;
+            return false;
+        }
+        WriteWavHeader(m_file, AudioMixer::kChannels, AudioMixer::kSampleRate, 16, 0);
+    }
+
+    m_mixer = &mixer;
+    m_block.resize(static_cast<size_t>(kBlockFrames) * AudioMixer::kChannels);
+    m_pcm.resize(m_block.size());
+    m_mixedFrames.store(0, std::memory_order_relaxed);
+    m_maxMixNs.store(0, std::memory_order_relaxed);
+    m_lateBlocks.store(0, std::memory_order_relaxed);
+    m_stop.store(false, std::memory_order_relaxed);
+    m_thread = std::thread([this] { Run(); });
+    return true;
+}
+
+void AudioFileSink::Stop() {
+    if (!m_thread.joinable()) return;
+    m_stop.store(true, std::memory_order_release);
+    m_thread.join();
+
+    if (m_file) {
+        const long long dataBytes = GetMixedFrames() * AudioMixer::kChannels * 2;
+        fseek(m_file, 0, SEEK_SET);
+        WriteWavHeader(m_file, AudioMixer::kChannels, AudioMixer::kSampleRate, 16, static_cast<uint32_t>(dataBytes));
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+void AudioFileSink::Run() {
+    const long long blockNs = 1000000000LL * kBlockFrames / AudioMixer::kSampleRate;
+    long long deadlineNs = NowNs();
+    while (!m_stop.load(std::memory_order_acquire)) {
+        const long long startNs = NowNs();
+        if (startNs > deadlineNs + blockNs) m_lateBlocks.fetch_add(1, std::memory_order_relaxed);
+
+        m_mixer->Mix(m_block.data(), kBlockFrames);
+        const long long mixNs = NowNs() - startNs;
+        if (mixNs > m_maxMixNs.load(std::memory_order_relaxed)) m_maxMixNs.store(mixNs, std::memory_order_relaxed);
+
+        if (m_file) {
+            MixToPcm16(m_block.data(), m_pcm.data(), static_cast<int>(m_pcm.size()));
+            fwrite(m_pcm.data(), sizeof(int16_t), m_pcm.size(), m_file);
+        }
+        m_mixedFrames.fetch_add(kBlockFrames, std::memory_order_relaxed);
+
+        // Paced from the first block, not from each wakeup, so oversleeping does not drift
+        deadlineNs += blockNs;
+        const long long waitNs = deadlineNs - NowNs();
+        if (waitNs > 0) std::this_thread::sleep_for(std::chrono::nanoseconds(waitNs));
+    }
+}
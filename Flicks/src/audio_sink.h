@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "audio_mixer.h"
+
+// The output for machines without XAudio2: a thread that pulls a block from
+// the mixer every kBlockFrames of real time, like a device would, and either
+// discards it or appends it to a 16-bit WAV file. Lets the game-thread ->
+// mixer path run (and be measured) on Linux.
+class AudioFileSink {
+public:
+    static const int kBlockFrames = 480;    // 10 ms, one XAudio2 pass
+
+    ~AudioFileSink() { Stop(); }
+
+    // wavPath may be null for a null sink
+    bool Start(AudioMixer& mixer, const char* wavPath = nullptr);
+    // Finishes the current block and completes the WAV header
+    void Stop();
+
+    bool IsRunning() const { return m_thread.joinable(); }
+    long long GetMixedFrames() const { return m_mixedFrames.load(std::memory_order_relaxed); }
+    long long GetMaxMixNs() const { return m_maxMixNs.load(std::memory_order_relaxed); }
+    // Blocks that started more than a block past their deadline, where a device would have run dry
+    long long GetLateBlocks() const { return m_lateBlocks.load(std::memory_order_relaxed); }
+
+private:
+    void Run();
+
+    AudioMixer* m_mixer = nullptr;
+    FILE* m_file = nullptr;
+    std::vector<float> m_block;
+    std::vector<int16_t> m_pcm;
+    std::thread m_thread;
+    std::atomic<bool> m_stop{ false };
+
+    std::atomic<long long> m_mixedFrames{ 0 };
+    std::atomic<long long> m_maxMixNs{ 0 };
+    std::atomic<long long> m_lateBlocks{ 0 };
+};
@@ -1,83 +1,46 @@
 ﻿#include "audio_xa.h"
-#include <fstream>
-#include <cstring>
-#include <cstdlib>
+
+#include <algorithm>
 
 // Global audio variables
 IXAudio2* g_pXAudio2 = nullptr;
 IXAudio2MasteringVoice* g_pMasterVoice = nullptr;
-SoundDataXA g_hitSound;
-const int HIT_VOICE_COUNT = 4;
-IXAudio2SourceVoice* g_pHitVoices[HIT_VOICE_COUNT] = { nullptr };
-int g_nextHitVoiceIndex = 0;
+IXAudio2SourceVoice* g_pMixVoice = nullptr;
+AudioMixer g_audioMixer;
+int g_hitSoundId = -1;
 
 namespace {
-    bool LoadWAVFromFile(const wchar_t* filename, SoundDataXA& outSound) {
-        std::ifstream file(filename, std::ios::binary);
-        if (!file) return false;
-
-        auto cleanup = [&] {
-            if (outSound.pData) free(outSound.pData);
-            outSound = SoundDataXA{};
-            return false;
-            };
-
-        char chunkId[4];
-        uint32_t chunkSize;
-        char format[4];
-        file.read(chunkId, 4);
-        file.read(reinterpret_cast<char*>(&chunkSize), 4);
-        file.read(format, 4);
-        if (std::memcmp(chunkId, "RIFF", 4) != 0 || std::memcmp(format, "WAVE", 4) != 0)
-            return cleanup();
-
-        bool fmtFound = false, dataFound = false;
-        WAVEFORMATEX wfx = {};
-        BYTE* pData = nullptr;
-        uint32_t dataSize = 0;
-
-        while (file.read(chunkId, 4)) {
-            file.read(reinterpret_cast<char*>(&chunkSize), 4);
-            uint32_t chunkDataPos = static_cast<uint32_t>(file.tellg());
-
-            if (std::memcmp(chunkId, "fmt ", 4) == 0) {
-                if (chunkSize < 16) return cleanup();
-
-                WORD audioFormat, numChannels, blockAlign, bitsPerSample;
-                DWORD sampleRate, byteRate;
-                file.read(reinterpret_cast<char*>(&audioFormat), sizeof(audioFormat));
-                file.read(reinterpret_cast<char*>(&numChannels), sizeof(numChannels));
-                file.read(reinterpret_cast<char*>(&sampleRate), sizeof(sampleRate));
-                file.read(reinterpret_cast<char*>(&byteRate), sizeof(byteRate));
-                file.read(reinterpret_cast<char*>(&blockAlign), sizeof(blockAlign));
-                file.read(reinterpret_cast<char*>(&bitsPerSample), sizeof(bitsPerSample));
-
-                if (audioFormat != WAVE_FORMAT_PCM) return cleanup();
-                wfx = { audioFormat, numChannels, sampleRate, byteRate, blockAlign, bitsPerSample, 0 };
-                fmtFound = true;
-            }
-            else if (std::memcmp(chunkId, "data", 4) == 0) {
-                dataSize = chunkSize;
-                pData = static_cast<BYTE*>(malloc(dataSize));
-                if (!pData || !file.read(reinterpret_cast<char*>(pData), dataSize))
-                    return cleanup();
-                dataFound = true;
-            }
-            file.seekg(chunkDataPos + chunkSize, std::ios::beg);
+    const UINT32 kFrameBytes = AudioMixer::kChannels * sizeof(float);
+    const int kMaxPassFrames = 1024;    // a pass is 10 ms (480 frames) at 48 kHz
+    const int kMixBufferCount = 4;      // XAudio2 reads a submitted buffer until it ends
+
+    float g_mixBuffers[kMixBufferCount][kMaxPassFrames * AudioMixer::kChannels];
+    int g_nextMixBuffer = 0;
+
+    // Runs on the XAudio2 processing thread before every pass
+    class MixerVoiceCallback : public IXAudio2VoiceCallback {
+    public:
+        void STDMETHODCALLTYPE OnVoiceProcessingPassStart(UINT32 bytesRequired) override {
+            if (bytesRequired == 0) return;
+            const int frames = std::min(static_cast<int>((bytesRequired + kFrameBytes - 1) / kFrameBytes), kMaxPassFrames);
+            float* buffer = g_mixBuffers[g_nextMixBuffer];
+            g_nextMixBuffer = (g_nextMixBuffer + 1) % kMixBufferCount;
+            g_audioMixer.Mix(buffer, frames);
+
+            XAUDIO2_BUFFER submit = {};
+            submit.AudioBytes = frames * kFrameBytes;
+            submit.pAudioData = reinterpret_cast<const BYTE*>(buffer);
+            g_pMixVoice->SubmitSourceBuffer(&submit);
         }
-
-        if (!fmtFound || !dataFound) return cleanup();
-
-        outSound.wfx = wfx;
-        outSound.pData = pData;
-        outSound.dataSize = dataSize;
-        return true;
-    }
-
-    void UnloadSoundData(SoundDataXA& sound) {
-        if (sound.pData) free(sound.pData);
-        sound = SoundDataXA{};
-    }
+        void STDMETHODCALLTYPE OnVoiceProcessingPassEnd() override {}
+        void STDMETHODCALLTYPE OnStreamEnd() override {}
+        void STDMETHODCALLTYPE OnBufferStart(void*) override {}
+        void STDMETHODCALLTYPE OnBufferEnd(void*) override {}
+        void STDMETHODCALLTYPE OnLoopEnd(void*) override {}
+        void STDMETHODCALLTYPE OnVoiceError(void*, HRESULT) override {}
+    };
+
+    MixerVoiceCallback g_mixCallback;
 }
 
 bool InitXAudio2() {
@@ -89,24 +52,37 @@ bool InitXAudio2() {
         g_pXAudio2 = nullptr;
         return false;
     }
+    return true;
+}
 
-    if (LoadWAVFromFile(L"res/hit.wav", g_hitSound)) {
-        for (int i = 0; i < HIT_VOICE_COUNT; ++i) {
-            g_pXAudio2->CreateSourceVoice(&g_pHitVoices[i], &g_hitSound.wfx);
-        }
+bool LoadHitSound(const char* path) {
+    PcmSound pcm;
+    if (!LoadWav(path, pcm)) return false;
+    g_hitSoundId = g_audioMixer.AddSound(pcm);
+    return g_hitSoundId >= 0;
+}
+
+bool StartAudioMixer() {
+    if (!g_pXAudio2 || g_hitSoundId < 0) return false;
+
+    const WAVEFORMATEX wfx = { WAVE_FORMAT_IEEE_FLOAT, AudioMixer::kChannels, AudioMixer::kSampleRate,
+        AudioMixer::kSampleRate * kFrameBytes, static_cast<WORD>(kFrameBytes), 32, 0 };
+    if (FAILED(g_pXAudio2->CreateSourceVoice(&g_pMixVoice, &wfx, 0, XAUDIO2_DEFAULT_FREQ_RATIO, &g_mixCallback)))
+        return false;
+    if (FAILED(g_pMixVoice->Start())) {
+        g_pMixVoice->DestroyVoice();
+        g_pMixVoice = nullptr;
+        return false;
     }
     return true;
 }
 
 void CleanupXAudio2() {
-    for (int i = 0; i < HIT_VOICE_COUNT; ++i) {
-        if (g_pHitVoices[i]) {
-            g_pHitVoices[i]->DestroyVoice();
-            g_pHitVoices[i] = nullptr;
-        }
+    // Blocks until the callback has returned, so the mixer is idle afterwards
+    if (g_pMixVoice) {
+        g_pMixVoice->DestroyVoice();
+        g_pMixVoice = nullptr;
     }
-    UnloadSoundData(g_hitSound);
-
     if (g_pMasterVoice) {
         g_pMasterVoice->DestroyVoice();
         g_pMasterVoice = nullptr;
@@ -118,21 +94,5 @@ void CleanupXAudio2() {
 }
 
 void PlayHitSound() {
-    if (!g_hitSound.pData) return;
-
-    IXAudio2SourceVoice* voice = g_pHitVoices[g_nextHitVoiceIndex];
-    if (!voice) return;
-
-    voice->Stop();
-    voice->FlushSourceBuffers();
-
-    XAUDIO2_BUFFER buffer = {};
-    buffer.pAudioData = g_hitSound.pData;
-    buffer.AudioBytes = g_hitSound.dataSize;
-    buffer.Flags = XAUDIO2_END_OF_STREAM;
-
-    if (SUCCEEDED(voice->SubmitSourceBuffer(&buffer))) {
-        voice->Start();
-    }
-    g_nextHitVoiceIndex = (g_nextHitVoiceIndex + 1) % HIT_VOICE_COUNT;
+    g_audioMixer.Play(g_hitSoundId);
 }
\ No newline at end of file
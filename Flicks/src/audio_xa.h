@@ -1,20 +1,23 @@
 ﻿#pragma once
 #include <xaudio2.h>
-#include <cstdint>
 
-struct SoundDataXA {
-    WAVEFORMATEX wfx = {};
-    BYTE* pData = nullptr;
-    UINT32 dataSize = 0;
-};
+#include "audio_mixer.h"
 
+// XAudio2 is one output for the mixer: a single float stereo source voice
+// whose per-pass callback, on the XAudio2 thread, mixes exactly the bytes the
+// device asks for and submits them. Hits never touch a voice directly.
 extern IXAudio2* g_pXAudio2;
 extern IXAudio2MasteringVoice* g_pMasterVoice;
-extern SoundDataXA g_hitSound;
-extern IXAudio2SourceVoice* g_pHitVoices[];
-extern int g_nextHitVoiceIndex;
-extern const int HIT_VOICE_COUNT;
+extern IXAudio2SourceVoice* g_pMixVoice;
+extern AudioMixer g_audioMixer;
+extern int g_hitSoundId;
 
+// The device and mastering voice
 bool InitXAudio2();
+// Decodes the hit sound into the mixer; needs no device, so it may run alongside InitXAudio2
+bool LoadHitSound(const char* path = "res/hit.wav");
+// Starts the mixer voice, once both of the above are done
+bool StartAudioMixer();
 void CleanupXAudio2();
+// Game thread: queues the hit sound for the next pass
 void PlayHitSound();
\ No newline at end of file
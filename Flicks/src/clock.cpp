@@ -0,0 +1,68 @@
+#include "clock.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__linux__)
+#include <time.h>
+#else
+#include <chrono>
+#endif
+
+#ifdef _WIN32
+namespace {
+    long long QpcFrequency() {
+        static const long long frequency = [] {
+            LARGE_INTEGER f;
+            QueryPerformanceFrequency(&f);
+            return f.QuadPart;
+        }();
+        return frequency;
+    }
+
+    // Split to keep counter * scale from overflowing on long uptimes
+    long long QpcScale(long long counter, long long scale) {
+        const long long frequency = QpcFrequency();
+        const long long whole = counter / frequency;
+        const long long part = counter % frequency;
+        return whole * scale + part * scale / frequency;
+    }
+
+    long long QpcNow() {
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        return now.QuadPart;
+    }
+}
+
+long long QpcToUs(long long counter) {
+    return QpcScale(counter, 1000000);
+}
+
+long long NowUs() {
+    return QpcScale(QpcNow(), 1000000);
+}
+
+long long NowNs() {
+    return QpcScale(QpcNow(), 1000000000);
+}
+#elif defined(__linux__)
+long long NowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return static_cast<long long>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+long long NowUs() {
+    return NowNs() / 1000;
+}
+#else
+long long NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+long long NowUs() {
+    return NowNs() / 1000;
+}
+#endif
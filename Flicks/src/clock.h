@@ -0,0 +1,13 @@
+#pragma once
+
+// The monotonic clock everything in a game is stamped with: input reports,
+// frame stages, spawns, expiries and reaction times. QueryPerformanceCounter
+// on Windows, CLOCK_MONOTONIC_RAW on Linux (not slewed by NTP), steady_clock
+// elsewhere. Integer ticks, so nothing is rounded to whole milliseconds.
+long long NowUs();
+long long NowNs();
+
+#ifdef _WIN32
+// A raw QueryPerformanceCounter value (e.g. a DXGI vblank time) on the NowUs clock
+long long QpcToUs(long long counter);
+#endif
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdio>
+
+// MSVC secure CRT functions used by the file I/O, mapped onto the standard ones elsewhere
+#ifndef _MSC_VER
+inline int fopen_s(FILE** f, const char* name, const char* mode) {
+    *f = std::fopen(name, mode);
+    return *f ? 0 : errno;
+}
+#define sscanf_s sscanf
+#endif
+
+// fseek with a 64-bit offset from the start of the file
+inline int fseek64(FILE* f, long long offset) {
+#ifdef _MSC_VER
+    return _fseeki64(f, offset, SEEK_SET);
+#else
+    return fseeko(f, static_cast<off_t>(offset), SEEK_SET);
+#endif
+}
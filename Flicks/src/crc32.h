@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC-32 (IEEE, reflected), as used by zip and png
+inline uint32_t Crc32(const void* data, size_t size) {
+    static const auto table = [] {
+        struct Table { uint32_t v[256]; } t;
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : (c >> 1);
+            t.v[i] = c;
+        }
+        return t;
+    }();
+
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) crc = table.v[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
@@ -0,0 +1,30 @@
+#include "field.h"
+#include <algorithm>
+
+void UpdateFieldCache(FieldCache& cache, int width, int height, float scale, float circleRadiusNorm, float cursorRadiusNorm) {
+    float screenW = static_cast<float>(width);
+    float screenH = static_cast<float>(height);
+
+    if (screenW <= 0 || screenH <= 0) {
+        cache.valid = false;
+        return;
+    }
+
+    float fieldSize = std::min(screenW, screenH) * scale;
+    float halfField = fieldSize * 0.5f;
+    ImVec2 fieldTL{ (screenW - fieldSize) * 0.5f, (screenH - fieldSize) * 0.5f };
+    ImVec2 fieldBR{ fieldTL.x + fieldSize, fieldTL.y + fieldSize };
+    ImVec2 center{ fieldTL.x + halfField, fieldTL.y + halfField };
+    float circleRadiusPx = circleRadiusNorm * halfField;
+    float spawnMaxRadius = std::max(0.0f, halfField - circleRadiusPx);
+
+    cache.fieldSize = fieldSize;
+    cache.halfField = halfField;
+    cache.fieldTL = fieldTL;
+    cache.fieldBR = fieldBR;
+    cache.center = center;
+    cache.circleRadiusPx = circleRadiusPx;
+    cache.spawnMaxRadius = spawnMaxRadius;
+    cache.cursorRadiusPx = cursorRadiusNorm * halfField;
+    cache.valid = true;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <imgui.h>
+
+// Screen-space geometry of the square game field
+struct FieldCache {
+    float fieldSize = 0.0f;
+    ImVec2 fieldTL = ImVec2(0, 0);
+    ImVec2 fieldBR = ImVec2(0, 0);
+    ImVec2 center = ImVec2(0, 0);
+    float halfField = 0.0f;
+    float circleRadiusPx = 0.0f;
+    float spawnMaxRadius = 0.0f;
+    float cursorRadiusPx = 0.0f;
+    bool valid = false;
+};
+
+void UpdateFieldCache(FieldCache& cache, int width, int height, float scale, float circleRadiusNorm, float cursorRadiusNorm);
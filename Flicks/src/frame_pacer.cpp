@@ -0,0 +1,118 @@
+#include "frame_pacer.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+const char* GetFramePacingName(int pacing) {
+    switch (pacing) {
+    case PACING_UNCAPPED: return "Uncapped (tearing)";
+    case PACING_WAITABLE: return "Waitable (vsync)";
+    case PACING_CAPPED: return "Capped (tearing)";
+    case PACING_LATE_INPUT: return "Late input (vsync)";
+    default: return "?";
+    }
+}
+
+bool PacingUsesSwapChain(int pacing) {
+    return pacing == PACING_WAITABLE || pacing == PACING_LATE_INPUT;
+}
+
+PreciseSleeper::PreciseSleeper(Clock clock) : m_clock(clock) {
+#ifdef _WIN32
+    // Windows 10 1803+: wakes within a fraction of a millisecond without timeBeginPeriod
+    m_timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    m_defaultSpinUs = 500;
+    if (!m_timer) {
+        // A plain timer follows the scheduler tick and may wake a whole period late
+        m_timer = CreateWaitableTimerExW(NULL, NULL, 0, TIMER_ALL_ACCESS);
+        m_defaultSpinUs = 2000;
+    }
+#else
+    m_defaultSpinUs = 200;
+#endif
+}
+
+PreciseSleeper::~PreciseSleeper() {
+#ifdef _WIN32
+    if (m_timer) CloseHandle(m_timer);
+#endif
+}
+
+void PreciseSleeper::OsSleep(long long us) {
+#ifdef _WIN32
+    if (m_timer) {
+        LARGE_INTEGER due;
+        due.QuadPart = -us * 10;    // relative, in 100 ns units
+        if (SetWaitableTimer(m_timer, &due, 0, NULL, NULL, FALSE)) {
+            WaitForSingleObject(m_timer, INFINITE);
+            return;
+        }
+    }
+    Sleep(static_cast<DWORD>(us / 1000));
+#else
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+#endif
+}
+
+long long PreciseSleeper::SleepUntil(long long deadlineUs, long long spinUs) {
+    long long now = m_clock();
+    if (deadlineUs - now > spinUs) OsSleep(deadlineUs - now - spinUs);
+
+    now = m_clock();
+    while (now < deadlineUs) now = m_clock();
+    return now;
+}
+
+FramePacer::FramePacer(PreciseSleeper::Clock clock) : m_sleeper(clock) {
+}
+
+void FramePacer::SetMode(int pacing) {
+    if (pacing < 0 || pacing >= PACING_COUNT) pacing = PACING_WAITABLE;
+    if (pacing != m_mode) m_nextDeadlineUs = 0;
+    m_mode = pacing;
+}
+
+void FramePacer::SetCapFps(int fps) {
+    m_capPeriodUs = 1000000 / std::clamp(fps, 10, 2000);
+}
+
+long long FramePacer::Wait() {
+    const long long now = m_sleeper.GetClock()();
+    const long long spinUs = m_sleeper.GetDefaultSpinUs();
+
+    if (m_mode == PACING_CAPPED) {
+        // A fixed grid of start times; one that fell a whole period behind starts over
+        if (m_nextDeadlineUs == 0 || now - m_nextDeadlineUs > m_capPeriodUs) m_nextDeadlineUs = now;
+        const long long deadline = m_nextDeadlineUs;
+        m_nextDeadlineUs += m_capPeriodUs;
+        return deadline > now ? m_sleeper.SleepUntil(deadline, spinUs) : now;
+    }
+
+    if (m_mode == PACING_LATE_INPUT && m_lastVblankUs > 0 && m_refreshPeriodUs > 0) {
+        // Finish the work just ahead of the next vblank instead of right after the last one
+        const long long sinceVblank = now - m_lastVblankUs;
+        const long long nextVblank = m_lastVblankUs + (sinceVblank / m_refreshPeriodUs + 1) * m_refreshPeriodUs;
+        const long long start = nextVblank - GetPredictedWorkUs() - m_lateMarginUs;
+        return start > now ? m_sleeper.SleepUntil(start, spinUs) : now;
+    }
+
+    return now;
+}
+
+void FramePacer::EndFrame(long long workStartUs, long long presentEndUs) {
+    m_costs[m_costIndex] = presentEndUs - workStartUs;
+    m_costIndex = (m_costIndex + 1) % kCostHistory;
+}
+
+long long FramePacer::GetPredictedWorkUs() const {
+    return *std::max_element(m_costs, m_costs + kCostHistory);
+}
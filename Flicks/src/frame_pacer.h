@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+
+enum FramePacing {
+    PACING_UNCAPPED,        // Present with tearing as soon as a frame is done, one core busy
+    PACING_WAITABLE,        // block on the swap chain's latency object, Present on vblank
+    PACING_CAPPED,          // tearing, frames started at a fixed rate by a sleep-then-spin timer
+    PACING_LATE_INPUT,      // as WAITABLE, then start the frame as late as its cost allows
+    PACING_COUNT
+};
+
+const char* GetFramePacingName(int pacing);
+// The swap chain side of a mode: whether the loop waits on the latency object and Presents on vblank
+bool PacingUsesSwapChain(int pacing);
+
+// Sleeps to a deadline on a microsecond clock more precisely than the OS
+// scheduler: an OS sleep (a high resolution timer on Windows) covers all but
+// the last spinUs, which are spun off reading the clock.
+class PreciseSleeper {
+public:
+    using Clock = long long (*)();
+
+    explicit PreciseSleeper(Clock clock);
+    ~PreciseSleeper();
+    PreciseSleeper(const PreciseSleeper&) = delete;
+    PreciseSleeper& operator=(const PreciseSleeper&) = delete;
+
+    // spinUs 0 sleeps the whole way. Returns the time it woke at.
+    long long SleepUntil(long long deadlineUs, long long spinUs);
+    long long GetDefaultSpinUs() const { return m_defaultSpinUs; }
+    Clock GetClock() const { return m_clock; }
+
+private:
+    void OsSleep(long long us);
+
+    Clock m_clock;
+    void* m_timer = nullptr;        // Windows waitable timer
+    long long m_defaultSpinUs = 0;  // how early the OS sleep may wake up, plus slack
+};
+
+// Decides when the frame loop may start its next frame. The loop calls
+// Wait() at the top of every frame (after the swap chain wait when the mode
+// uses one) and EndFrame() once Present returns.
+class FramePacer {
+public:
+    explicit FramePacer(PreciseSleeper::Clock clock);
+
+    void SetMode(int pacing);
+    int GetMode() const { return m_mode; }
+    void SetCapFps(int fps);
+    void SetRefreshPeriodUs(long long periodUs) { m_refreshPeriodUs = periodUs; }
+    // Time kept between the predicted end of the frame's work and the vblank it aims for
+    void SetLateMarginUs(long long marginUs) { m_lateMarginUs = marginUs; }
+
+    // Sleeps as the mode asks; returns the time the frame's work may begin
+    long long Wait();
+    // workStartUs is what Wait() returned, presentEndUs when Present returned
+    void EndFrame(long long workStartUs, long long presentEndUs);
+    // The latest vblank a frame was shown at, to place the next one
+    void OnVblank(long long displayUs) { m_lastVblankUs = displayUs; }
+
+    // Slowest of the recent frames' work, what LATE_INPUT budgets for
+    long long GetPredictedWorkUs() const;
+    const PreciseSleeper& GetSleeper() const { return m_sleeper; }
+
+private:
+    static constexpr int kCostHistory = 32;
+
+    PreciseSleeper m_sleeper;
+    int m_mode = PACING_WAITABLE;
+    long long m_capPeriodUs = 1000000 / 240;
+    long long m_nextDeadlineUs = 0;
+    long long m_refreshPeriodUs = 1000000 / 60;
+    long long m_lateMarginUs = 1000;
+    long long m_lastVblankUs = 0;
+    long long m_costs[kCostHistory] = {};
+    int m_costIndex = 0;
+};
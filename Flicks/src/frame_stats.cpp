@@ -0,0 +1,194 @@
+#include "frame_stats.h"
+#include "compat.h"
+#include "stream_stats.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const char g_frameMagic[4] = { 'F', 'L', 'K', 'F' };
+    const uint32_t g_frameVersion = 3;
+
+    StageStats MakeStageStats(std::vector<double>& values) {
+        StageStats s;
+        s.count = static_cast<int>(values.size());
+        if (values.empty()) return s;
+
+        double sum = 0.0;
+        for (double v : values) {
+            sum += v;
+            s.max = std::max(s.max, v);
+        }
+        s.mean = sum / values.size();
+        s.p50 = ExactQuantile(values, 0.50);
+        s.p99 = ExactQuantile(values, 0.99);
+        s.p999 = ExactQuantile(values, 0.999);
+        return s;
+    }
+
+    double Ms(long long us) {
+        return us / 1000.0;
+    }
+}
+
+FrameTiming& FrameStats::BeginFrame(long long nowUs) {
+    m_current = {};
+    m_current.startUs = nowUs;
+    return m_current;
+}
+
+void FrameStats::EndFrame() {
+    // Stages the loop skipped take the previous stamp
+    FrameTiming& f = m_current;
+    f.waitEndUs = std::max(f.waitEndUs, f.startUs);
+    f.pumpEndUs = std::max(f.pumpEndUs, f.waitEndUs);
+    f.simEndUs = std::max(f.simEndUs, f.pumpEndUs);
+    f.uiEndUs = std::max(f.uiEndUs, f.simEndUs);
+    f.latchEndUs = std::max(f.latchEndUs, f.uiEndUs);
+    f.submitEndUs = std::max(f.submitEndUs, f.latchEndUs);
+    f.presentEndUs = std::max(f.presentEndUs, f.submitEndUs);
+
+    if (m_pendingCount == kMaxPending) {
+        Publish(m_pending[0]);
+        memmove(m_pending, m_pending + 1, (kMaxPending - 1) * sizeof(FrameTiming));
+        m_pendingCount--;
+    }
+    m_pending[m_pendingCount++] = f;
+}
+
+void FrameStats::MarkDisplayed(uint32_t presentCount, long long displayUs) {
+    size_t done = 0;
+    while (done < m_pendingCount && m_pending[done].presentCount <= presentCount) {
+        // Earlier presents were shown before the last poll or never shown at all
+        if (m_pending[done].presentCount == presentCount) m_pending[done].displayUs = displayUs;
+        Publish(m_pending[done]);
+        done++;
+    }
+    if (done > 0) {
+        memmove(m_pending, m_pending + done, (m_pendingCount - done) * sizeof(FrameTiming));
+        m_pendingCount -= done;
+    }
+}
+
+void FrameStats::Publish(const FrameTiming& frame) {
+    const uint64_t index = m_published.load(std::memory_order_relaxed);
+    m_frames[index & kMask] = frame;
+    m_published.store(index + 1, std::memory_order_release);
+}
+
+size_t FrameStats::Snapshot(std::vector<FrameTiming>& out, size_t maxFrames) const {
+    const uint64_t published = m_published.load(std::memory_order_acquire);
+    const uint64_t count = std::min<uint64_t>({ published, maxFrames, kCapacity });
+    const uint64_t first = published - count;
+
+    const size_t base = out.size();
+    out.resize(base + static_cast<size_t>(count));
+    for (uint64_t i = 0; i < count; ++i) out[base + i] = m_frames[(first + i) & kMask];
+
+    // The writer may have lapped the oldest slots while they were copied
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t now = m_published.load(std::memory_order_relaxed);
+    const uint64_t oldestIntact = (now + 1 > kCapacity) ? now + 1 - kCapacity : 0;
+    if (oldestIntact > first) {
+        const size_t torn = static_cast<size_t>(std::min(oldestIntact - first, count));
+        out.erase(out.begin() + base, out.begin() + base + torn);
+    }
+    return out.size() - base;
+}
+
+FrameStatsSummary SummarizeFrames(const std::vector<FrameTiming>& frames, int pacing, int latched) {
+    FrameStatsSummary summary;
+    if (frames.empty()) return summary;
+
+    std::vector<double> frame, wait, pump, sim, ui, latch, submit, present;
+    std::vector<double> inputToPresent, inputToDisplay, newestToPresent, newestToDisplay, eventToPresent, eventToDisplay;
+    const size_t n = frames.size();
+    for (std::vector<double>* v : { &frame, &wait, &pump, &sim, &ui, &latch, &submit, &present,
+        &inputToPresent, &inputToDisplay, &newestToPresent, &newestToDisplay, &eventToPresent, &eventToDisplay }) {
+        v->reserve(n);
+    }
+
+    auto selected = [pacing, latched](const FrameTiming& f) {
+        return (pacing < 0 || f.pacing == pacing) && (latched < 0 || f.latched == latched);
+    };
+    for (size_t i = 0; i < n; ++i) {
+        const FrameTiming& f = frames[i];
+        if (!selected(f)) continue;
+        if (i + 1 < n && selected(frames[i + 1])) {
+            const double ms = Ms(frames[i + 1].startUs - f.startUs);
+            frame.push_back(ms);
+            summary.seconds += ms / 1000.0;
+            const int bin = static_cast<int>(ms / FrameStatsSummary::kHistogramBinMs);
+            summary.histogram[std::clamp(bin, 0, FrameStatsSummary::kHistogramBins - 1)]++;
+        }
+        wait.push_back(Ms(f.waitEndUs - f.startUs));
+        pump.push_back(Ms(f.pumpEndUs - f.waitEndUs));
+        sim.push_back(Ms(f.simEndUs - f.pumpEndUs));
+        ui.push_back(Ms(f.uiEndUs - f.simEndUs));
+        latch.push_back(Ms(f.latchEndUs - f.uiEndUs));
+        submit.push_back(Ms(f.submitEndUs - f.latchEndUs));
+        present.push_back(Ms(f.presentEndUs - f.submitEndUs));
+        if (f.inputUs > 0) {
+            inputToPresent.push_back(Ms(f.presentEndUs - f.inputUs));
+            newestToPresent.push_back(Ms(f.presentEndUs - f.newestInputUs));
+            if (f.displayUs > 0) {
+                inputToDisplay.push_back(Ms(f.displayUs - f.inputUs));
+                newestToDisplay.push_back(Ms(f.displayUs - f.newestInputUs));
+            }
+        }
+        if (f.eventUs > 0) {
+            eventToPresent.push_back(Ms(f.presentEndUs - f.eventUs));
+            if (f.displayUs > 0) eventToDisplay.push_back(Ms(f.displayUs - f.eventUs));
+        }
+    }
+
+    summary.frame = MakeStageStats(frame);
+    summary.wait = MakeStageStats(wait);
+    summary.pump = MakeStageStats(pump);
+    summary.sim = MakeStageStats(sim);
+    summary.ui = MakeStageStats(ui);
+    summary.latch = MakeStageStats(latch);
+    summary.submit = MakeStageStats(submit);
+    summary.present = MakeStageStats(present);
+    summary.inputToPresent = MakeStageStats(inputToPresent);
+    summary.inputToDisplay = MakeStageStats(inputToDisplay);
+    summary.newestToPresent = MakeStageStats(newestToPresent);
+    summary.newestToDisplay = MakeStageStats(newestToDisplay);
+    summary.eventToPresent = MakeStageStats(eventToPresent);
+    summary.eventToDisplay = MakeStageStats(eventToDisplay);
+    return summary;
+}
+
+bool WriteFrameTimesCsv(const std::vector<FrameTiming>& frames, const char* path) {
+    FILE* f;
+    if (fopen_s(&f, path, "w") != 0) return false;
+
+    fprintf(f, "start_us,wait_end_us,pump_end_us,sim_end_us,ui_end_us,latch_end_us,submit_end_us,present_end_us,"
+        "input_us,newest_input_us,event_us,display_us,present_count,pacing,latched\n");
+    for (const FrameTiming& t : frames) {
+        fprintf(f, "%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%u,%u,%u\n",
+            t.startUs, t.waitEndUs, t.pumpEndUs, t.simEndUs, t.uiEndUs, t.latchEndUs, t.submitEndUs, t.presentEndUs,
+            t.inputUs, t.newestInputUs, t.eventUs, t.displayUs, t.presentCount, t.pacing, t.latched);
+    }
+    return fclose(f) == 0;
+}
+
+bool WriteFrameTimesBinary(const std::vector<FrameTiming>& frames, const char* path) {
+    FILE* f;
+    if (fopen_s(&f, path, "wb") != 0) return false;
+
+    struct {
+        char magic[4];
+        uint32_t version;
+        uint32_t recordSize;
+        uint32_t count;
+    } header;
+    memcpy(header.magic, g_frameMagic, sizeof(header.magic));
+    header.version = g_frameVersion;
+    header.recordSize = sizeof(FrameTiming);
+    header.count = static_cast<uint32_t>(frames.size());
+
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    if (ok && !frames.empty()) ok = fwrite(frames.data(), sizeof(FrameTiming), frames.size(), f) == frames.size();
+    return (fclose(f) == 0) && ok;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Where one iteration of the frame loop spent its time, as microsecond
+// stamps on the input clock. A stage the loop skipped keeps the previous
+// stage's stamp, so every stage duration is >= 0.
+struct FrameTiming {
+    long long startUs;          // iteration began
+    long long waitEndUs;        // pacing wait returned: latency object, cap or late start
+    long long pumpEndUs;        // window messages handled
+    long long simEndUs;         // input applied and the game ticked
+    long long uiEndUs;          // UI windows built
+    long long latchEndUs;       // late input latch applied the reports that came in meanwhile
+    long long submitEndUs;      // scene and UI recorded, Present about to be called
+    long long presentEndUs;     // Present returned
+    long long inputUs;          // oldest raw mouse report applied this frame, 0 if none
+    long long newestInputUs;    // newest one, what the drawn cursor reflects
+    long long eventUs;          // scheduled time of the earliest spawn/expiry/end this frame first shows, 0 if none
+    long long displayUs;        // vblank the frame reached the screen at, 0 if unknown
+    uint32_t presentCount;      // DXGI present id, ties displayUs to its frame
+    uint16_t pacing;            // FramePacing mode the frame ran under
+    uint16_t latched;           // 1 if the late input latch ran
+};
+static_assert(sizeof(FrameTiming) == 104, "frame timings are 104 bytes in dumps");
+
+// Fixed ring of the last kCapacity frames. The frame loop is the only
+// writer; any thread may take a snapshot without locking. A frame is held
+// back a few frames until DXGI reports when it was displayed, so every
+// record is final once published.
+class FrameStats {
+public:
+    static constexpr size_t kCapacity = 4096;
+
+    // Writer side. Fill the returned record during the frame, then EndFrame().
+    FrameTiming& BeginFrame(long long nowUs);
+    void EndFrame();
+    // DXGI's latest displayed present: stamps that frame and publishes every frame before it
+    void MarkDisplayed(uint32_t presentCount, long long displayUs);
+
+    // Any thread: appends up to maxFrames of the newest published frames, oldest first
+    size_t Snapshot(std::vector<FrameTiming>& out, size_t maxFrames = kCapacity) const;
+    uint64_t GetPublishedCount() const { return m_published.load(std::memory_order_acquire); }
+
+private:
+    void Publish(const FrameTiming& frame);
+
+    static constexpr size_t kMask = kCapacity - 1;
+    // Frames kept waiting for their display time; older ones are published without it
+    static constexpr size_t kMaxPending = 8;
+
+    FrameTiming m_current = {};
+    FrameTiming m_pending[kMaxPending] = {};
+    size_t m_pendingCount = 0;
+
+    FrameTiming m_frames[kCapacity] = {};
+    std::atomic<uint64_t> m_published{ 0 };
+};
+
+struct StageStats {
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p99 = 0.0;
+    double p999 = 0.0;
+    double max = 0.0;
+    int count = 0;
+};
+
+struct FrameStatsSummary {
+    static constexpr int kHistogramBins = 64;
+    static constexpr double kHistogramBinMs = 0.25;     // the last bin collects everything slower
+
+    double seconds = 0.0;      // sum of the frame times
+    StageStats frame;           // start to next start, ms
+    StageStats wait;
+    StageStats pump;
+    StageStats sim;
+    StageStats ui;
+    StageStats latch;
+    StageStats submit;
+    StageStats present;
+    StageStats inputToPresent;  // oldest report of the frame to Present returning
+    StageStats inputToDisplay;  // oldest report of the frame to its vblank
+    StageStats newestToPresent; // newest report of the frame to Present returning
+    StageStats newestToDisplay; // newest report of the frame to its vblank
+    StageStats eventToPresent;  // how late game events reach Present
+    StageStats eventToDisplay;  // how late game events reach the screen
+    int histogram[kHistogramBins] = {};
+};
+
+// All stages in milliseconds. pacing >= 0 keeps only the frames run under that
+// mode, latched >= 0 only those with (1) or without (0) the late input latch.
+FrameStatsSummary SummarizeFrames(const std::vector<FrameTiming>& frames, int pacing = -1, int latched = -1);
+
+bool WriteFrameTimesCsv(const std::vector<FrameTiming>& frames, const char* path);
+// 16-byte header ("FLKF", version 3, record size, count) and the raw records
+bool WriteFrameTimesBinary(const std::vector<FrameTiming>& frames, const char* path);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <climits>
+
+enum GameEventType {
+    GAME_EVENT_END,         // no more targets: the time or spawn limit was reached
+    GAME_EVENT_EXPIRE,      // the live target's lifetime ran out
+    GAME_EVENT_SPAWN,       // the next target appears
+    GAME_EVENT_COUNT
+};
+
+// Deadlines of a session's pending events in microseconds. At most one event
+// of each type is pending, so this is a slot per type; the earliest is found
+// by a scan of three when the earliest one changes. Events due at the same time run
+// in type order: the end first, then an expiry, then a spawn.
+class GameEventQueue {
+public:
+    static constexpr long long kNone = LLONG_MAX;
+
+    void Clear() {
+        for (long long& t : m_timeUs) t = kNone;
+        m_next = 0;
+    }
+    void Schedule(GameEventType type, long long timeUs) {
+        const long long nextUs = m_timeUs[m_next];
+        m_timeUs[type] = timeUs;
+        if (timeUs < nextUs || (timeUs == nextUs && type < m_next)) m_next = type;
+        else if (type == m_next) FindNext();
+    }
+    void Cancel(GameEventType type) {
+        m_timeUs[type] = kNone;
+        if (type == m_next) FindNext();
+    }
+
+    // kNone when nothing is pending
+    long long GetNextTimeUs() const { return m_timeUs[m_next]; }
+
+    // Removes the earliest event if it is due at or before nowUs
+    bool PopDue(long long nowUs, GameEventType& type, long long& timeUs) {
+        if (m_timeUs[m_next] > nowUs || m_timeUs[m_next] == kNone) return false;
+        type = static_cast<GameEventType>(m_next);
+        timeUs = m_timeUs[m_next];
+        Cancel(type);
+        return true;
+    }
+
+private:
+    void FindNext() {
+        m_next = 0;
+        for (int i = 1; i < GAME_EVENT_COUNT; ++i) {
+            if (m_timeUs[i] < m_timeUs[m_next]) m_next = i;
+        }
+    }
+
+    long long m_timeUs[GAME_EVENT_COUNT] = { kNone, kNone, kNone };
+    int m_next = 0;
+};
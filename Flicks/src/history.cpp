@@ -0,0 +1,248 @@
+#include "history.h"
+#include "compat.h"
+#include "crc32.h"
+#include "summaries.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+    struct HistoryHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t recordSize;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(HistoryHeader) == 16, "history header is 16 bytes on disk");
+
+    const char g_historyMagic[4] = { 'F', 'L', 'K', 'H' };
+    const uint32_t g_historyVersion = 1;
+
+    uint32_t RecordCrc(const HistoryRecord& record) {
+        return Crc32(&record, offsetof(HistoryRecord, crc));
+    }
+
+    HistoryHeader MakeHeader() {
+        HistoryHeader header = {};
+        memcpy(header.magic, g_historyMagic, sizeof(header.magic));
+        header.version = g_historyVersion;
+        header.recordSize = sizeof(HistoryRecord);
+        return header;
+    }
+
+    bool ReadHeader(FILE* f) {
+        HistoryHeader header;
+        return fread(&header, sizeof(header), 1, f) == 1 &&
+            memcmp(header.magic, g_historyMagic, sizeof(header.magic)) == 0 &&
+            header.version == g_historyVersion &&
+            header.recordSize == sizeof(HistoryRecord);
+    }
+
+    void ReadRecords(FILE* f, std::vector<GameSummary>& summaries, int& dropped) {
+        dropped = 0;
+        HistoryRecord records[256];
+        size_t count;
+        while ((count = fread(records, 1, sizeof(records), f)) > 0) {
+            const size_t whole = count / sizeof(HistoryRecord);
+            for (size_t i = 0; i < whole; ++i) {
+                if (records[i].crc == RecordCrc(records[i])) summaries.push_back(MakeGameSummary(records[i]));
+                else dropped++;
+            }
+            if (count % sizeof(HistoryRecord) != 0) {
+                dropped++;
+                break;
+            }
+        }
+    }
+}
+
+HistoryRecord MakeHistoryRecord(const GameSummary& summary) {
+    HistoryRecord record = {};
+    record.timestamp = static_cast<int64_t>(summary.timestamp);
+    record.seed = summary.seed;
+    record.circleRadiusNorm = summary.circleRadiusNorm;
+    record.cursorRadiusNorm = summary.cursorRadiusNorm;
+    record.circleLifetimeMs = summary.circleLifetimeMs;
+    record.gameTimeSec = summary.gameTimeSec;
+    record.minSpawnDelayMs = summary.minSpawnDelayMs;
+    record.maxSpawnDelayMs = summary.maxSpawnDelayMs;
+    record.endBySpawnCount = summary.endBySpawnCount ? 1 : 0;
+    record.maxSpawnCount = summary.maxSpawnCount;
+    record.hits = summary.hits;
+    record.avgReactionTime = summary.avgReactionTime;
+    record.score = summary.score;
+    record.crc = RecordCrc(record);
+    return record;
+}
+
+GameSummary MakeGameSummary(const HistoryRecord& record) {
+    GameSummary summary;
+    summary.circleRadiusNorm = record.circleRadiusNorm;
+    summary.cursorRadiusNorm = record.cursorRadiusNorm;
+    summary.circleLifetimeMs = record.circleLifetimeMs;
+    summary.gameTimeSec = record.gameTimeSec;
+    summary.endBySpawnCount = (record.endBySpawnCount != 0);
+    summary.maxSpawnCount = record.maxSpawnCount;
+    summary.minSpawnDelayMs = record.minSpawnDelayMs;
+    summary.maxSpawnDelayMs = record.maxSpawnDelayMs;
+    summary.hits = record.hits;
+    summary.avgReactionTime = record.avgReactionTime;
+    summary.score = record.score;
+    summary.timestamp = static_cast<std::time_t>(record.timestamp);
+    summary.seed = record.seed;
+    return summary;
+}
+
+bool ReadGameHistory(std::vector<GameSummary>& summaries, const char* path, int* dropped, long long firstRecord) {
+    FILE* f;
+    if (fopen_s(&f, path, "rb") != 0) return false;
+
+    int droppedRecords = 0;
+    bool ok = ReadHeader(f);
+    if (ok && firstRecord > 0) {
+        std::error_code ec;
+        const long long size = static_cast<long long>(std::filesystem::file_size(path, ec));
+        const long long offset = static_cast<long long>(sizeof(HistoryHeader)) + firstRecord * static_cast<long long>(sizeof(HistoryRecord));
+        ok = !ec && offset <= size && fseek64(f, offset) == 0;
+    }
+    if (ok) ReadRecords(f, summaries, droppedRecords);
+    fclose(f);
+    if (dropped) *dropped = droppedRecords;
+    return ok;
+}
+
+long long CountGameHistoryRecords(const char* path) {
+    FILE* f;
+    if (fopen_s(&f, path, "rb") != 0) return -1;
+    bool ok = ReadHeader(f);
+    fclose(f);
+    if (!ok) return -1;
+
+    std::error_code ec;
+    const long long size = static_cast<long long>(std::filesystem::file_size(path, ec));
+    if (ec) return -1;
+    return (size - static_cast<long long>(sizeof(HistoryHeader))) / static_cast<long long>(sizeof(HistoryRecord));
+}
+
+uint32_t GameHistoryIdentity(const char* path, long long records) {
+    // Over the header and the record CRCs: a CRC over whole records would come
+    // out the same for any records, as each one ends in its own CRC
+    const long long kFirstRecords = 64;
+    HistoryRecord read[kFirstRecords + 1];
+    struct { HistoryHeader header; uint32_t crcs[kFirstRecords + 1]; } identity = {};
+    FILE* f;
+    if (fopen_s(&f, path, "rb") != 0) return 0;
+
+    size_t count = static_cast<size_t>(std::min(records, kFirstRecords));
+    bool ok = fread(&identity.header, sizeof(identity.header), 1, f) == 1 &&
+        fread(read, sizeof(HistoryRecord), count, f) == count;
+    if (ok && records > kFirstRecords) {
+        const long long offset = static_cast<long long>(sizeof(HistoryHeader)) + (records - 1) * static_cast<long long>(sizeof(HistoryRecord));
+        ok = fseek64(f, offset) == 0 && fread(&read[count], sizeof(HistoryRecord), 1, f) == 1;
+        count++;
+    }
+    fclose(f);
+    if (!ok) return 0;
+    for (size_t i = 0; i < count; ++i) identity.crcs[i] = read[i].crc;
+    return Crc32(&identity, sizeof(identity.header) + count * sizeof(uint32_t));
+}
+
+bool WriteGameHistory(const std::vector<GameSummary>& summaries, const char* path) {
+    // Written beside the target and renamed over it, so a crash leaves either log intact
+    const std::string tempPath = std::string(path) + ".tmp";
+    FILE* f;
+    if (fopen_s(&f, tempPath.c_str(), "wb") != 0) return false;
+
+    const HistoryHeader header = MakeHeader();
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    std::vector<HistoryRecord> records;
+    records.reserve(summaries.size());
+    for (const GameSummary& s : summaries) records.push_back(MakeHistoryRecord(s));
+    if (ok && !records.empty()) ok = fwrite(records.data(), sizeof(HistoryRecord), records.size(), f) == records.size();
+    ok = (fclose(f) == 0) && ok;
+
+    std::error_code ec;
+    if (ok) std::filesystem::rename(tempPath, path, ec);
+    if (!ok || ec) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+bool GameHistory::Open(const char* path, const char* importCsvPath) {
+    Close();
+    m_recordCount = 0;
+
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) {
+        // First start with the binary log: carry the old CSV history over once
+        std::vector<GameSummary> imported;
+        if (importCsvPath) LoadGameSummaries(imported, importCsvPath);
+        if (!WriteGameHistory(imported, path)) return false;
+    }
+    else {
+        // Never append to something that is not our log
+        FILE* f;
+        if (fopen_s(&f, path, "rb") != 0) return false;
+        bool ok = ReadHeader(f);
+        fclose(f);
+        if (!ok) return false;
+    }
+
+    const long long size = static_cast<long long>(std::filesystem::file_size(path, ec));
+    if (ec) return false;
+    const long long recordBytes = size - static_cast<long long>(sizeof(HistoryHeader));
+    m_recordCount = recordBytes / static_cast<long long>(sizeof(HistoryRecord));
+
+    // Cut a torn tail so the next record starts on a record boundary
+    if (recordBytes % static_cast<long long>(sizeof(HistoryRecord)) != 0) {
+        const long long validBytes = size - recordBytes % static_cast<long long>(sizeof(HistoryRecord));
+        std::filesystem::resize_file(path, static_cast<uintmax_t>(validBytes), ec);
+        if (ec) return false;
+    }
+
+    return fopen_s(&m_file, path, "ab") == 0;
+}
+
+bool GameHistory::Append(const GameSummary* summaries, size_t count) {
+    if (!m_file) return false;
+    if (count == 1) {
+        const HistoryRecord record = MakeHistoryRecord(*summaries);
+        if (fwrite(&record, sizeof(record), 1, m_file) != 1) return false;
+        m_recordCount++;
+        return fflush(m_file) == 0;
+    }
+
+    std::vector<HistoryRecord> records;
+    records.reserve(count);
+    for (size_t i = 0; i < count; ++i) records.push_back(MakeHistoryRecord(summaries[i]));
+    const size_t written = fwrite(records.data(), sizeof(HistoryRecord), count, m_file);
+    m_recordCount += static_cast<long long>(written);
+    return written == count && fflush(m_file) == 0;
+}
+
+bool GameHistory::Sync() {
+    if (!m_file || fflush(m_file) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(m_file)) == 0;
+#else
+    return fsync(fileno(m_file)) == 0;
+#endif
+}
+
+void GameHistory::Close() {
+    if (m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
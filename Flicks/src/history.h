@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "session.h"
+
+// Append-only log of finished games. A 16-byte header is followed by fixed
+// 64-byte little-endian records, each closed by a CRC-32 of its first 60
+// bytes. Finishing a game is one fwrite of one record; a crash can at worst
+// leave a torn last record, which the next Open() cuts off.
+struct HistoryRecord {
+    int64_t timestamp;
+    uint64_t seed;
+    float circleRadiusNorm;
+    float cursorRadiusNorm;
+    int32_t circleLifetimeMs;
+    int32_t gameTimeSec;
+    int32_t minSpawnDelayMs;
+    int32_t maxSpawnDelayMs;
+    int32_t endBySpawnCount;
+    int32_t maxSpawnCount;
+    int32_t hits;
+    float avgReactionTime;
+    float score;
+    uint32_t crc;
+};
+static_assert(sizeof(HistoryRecord) == 64, "history records are 64 bytes on disk");
+
+HistoryRecord MakeHistoryRecord(const GameSummary& summary);
+GameSummary MakeGameSummary(const HistoryRecord& record);
+
+class GameHistory {
+public:
+    ~GameHistory() { Close(); }
+
+    // Opens the log for appending. When it does not exist yet it is created,
+    // importing importCsvPath (the old game_summaries.csv) if that file is
+    // there. A torn last record left by a crash is cut off.
+    bool Open(const char* path = "res/game_history.bin", const char* importCsvPath = "res/game_summaries.csv");
+    bool Append(const GameSummary& summary) { return Append(&summary, 1); }
+    bool Append(const GameSummary* summaries, size_t count);
+    // Waits until everything appended is on the disk, not just in the OS cache
+    bool Sync();
+    void Close();
+
+    bool IsOpen() const { return m_file != nullptr; }
+    // Complete records in the file, damaged ones included
+    long long GetRecordCount() const { return m_recordCount; }
+
+private:
+    FILE* m_file = nullptr;
+    long long m_recordCount = 0;
+};
+
+// Reads the valid records from record firstRecord on. dropped counts the
+// ones skipped for a bad checksum or a torn tail.
+bool ReadGameHistory(std::vector<GameSummary>& summaries, const char* path, int* dropped = nullptr, long long firstRecord = 0);
+// Complete records in the log at path, damaged ones included; -1 when it is not a log
+long long CountGameHistoryRecords(const char* path);
+// CRC-32 of the log header and the checksums of the first 64 of the first
+// records records and of the last of them. A snapshot built from the log stores it to recognize the log
+// again; 0 when the log cannot be read that far.
+uint32_t GameHistoryIdentity(const char* path, long long records);
+// Replaces the file at path with a log holding exactly these games
+bool WriteGameHistory(const std::vector<GameSummary>& summaries, const char* path);
@@ -0,0 +1,217 @@
+#include "history_columns.h"
+#include "compat.h"
+#include "history.h"
+#include "settings_key.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+namespace {
+    struct SnapshotHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t count;
+        uint64_t logRecords;        // log records the snapshot covers, damaged ones included
+        uint64_t offsets[4];        // byte offsets of score, avgReactionTime, settingsKey, timestamp
+        uint32_t logIdentity;       // GameHistoryIdentity() of those records
+        uint32_t reserved;
+    };
+    static_assert(sizeof(SnapshotHeader) == 64, "snapshot header is 64 bytes on disk");
+
+    const char g_snapshotMagic[4] = { 'F', 'L', 'K', 'C' };
+    const uint32_t g_snapshotVersion = 2;
+    const size_t g_columnSizes[4] = { sizeof(float), sizeof(float), sizeof(uint64_t), sizeof(int64_t) };
+
+    // Columns start on cache lines
+    uint64_t AlignUp(uint64_t v) {
+        return (v + 63) & ~uint64_t(63);
+    }
+
+    const void* ColumnData(const HistoryColumnSpan& span, int column) {
+        switch (column) {
+        case 0: return span.score;
+        case 1: return span.avgReactionTime;
+        case 2: return span.settingsKey;
+        default: return span.timestamp;
+        }
+    }
+
+    bool WriteSnapshotFile(const char* path, const HistoryColumnSpan* spans, int spanCount, long long logRecords, uint32_t logIdentity) {
+        FILE* f;
+        if (fopen_s(&f, path, "wb") != 0) return false;
+
+        SnapshotHeader header = {};
+        memcpy(header.magic, g_snapshotMagic, sizeof(header.magic));
+        header.version = g_snapshotVersion;
+        for (int i = 0; i < spanCount; ++i) header.count += spans[i].count;
+        header.logRecords = static_cast<uint64_t>(logRecords);
+        header.logIdentity = logIdentity;
+        uint64_t offset = AlignUp(sizeof(header));
+        for (int c = 0; c < 4; ++c) {
+            header.offsets[c] = offset;
+            offset = AlignUp(offset + header.count * g_columnSizes[c]);
+        }
+
+        bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+        static const char padding[64] = {};
+        uint64_t written = sizeof(header);
+        for (int c = 0; c < 4 && ok; ++c) {
+            ok = fwrite(padding, 1, header.offsets[c] - written, f) == header.offsets[c] - written;
+            written = header.offsets[c];
+            for (int i = 0; i < spanCount && ok; ++i) {
+                if (spans[i].count == 0) continue;
+                ok = fwrite(ColumnData(spans[i], c), g_columnSizes[c], spans[i].count, f) == spans[i].count;
+                written += spans[i].count * g_columnSizes[c];
+            }
+        }
+        return (fclose(f) == 0) && ok;
+    }
+}
+
+bool WriteHistorySnapshot(const char* snapshotPath, const HistoryColumnSpan* spans, int spanCount, long long logRecords, uint32_t logIdentity) {
+    const std::string tempPath = std::string(snapshotPath) + ".tmp";
+    std::error_code ec;
+    if (WriteSnapshotFile(tempPath.c_str(), spans, spanCount, logRecords, logIdentity)) {
+        std::filesystem::rename(tempPath, snapshotPath, ec);
+        if (!ec) return true;
+    }
+    std::filesystem::remove(tempPath, ec);
+    return false;
+}
+
+bool HistoryColumns::MapSnapshot(const char* snapshotPath) {
+    m_mapped = HistoryColumnSpan();
+    m_snapshotLogRecords = 0;
+    m_snapshotLogIdentity = 0;
+    if (!m_file.Open(snapshotPath)) return false;
+
+    const size_t size = m_file.GetSize();
+    const unsigned char* base = static_cast<const unsigned char*>(m_file.GetData());
+    SnapshotHeader header;
+    bool ok = size >= sizeof(header);
+    if (ok) {
+        memcpy(&header, base, sizeof(header));
+        ok = memcmp(header.magic, g_snapshotMagic, sizeof(header.magic)) == 0 &&
+            header.version == g_snapshotVersion &&
+            header.count <= size;
+    }
+    for (int c = 0; c < 4 && ok; ++c) {
+        ok = header.offsets[c] % 8 == 0 && header.offsets[c] <= size &&
+            header.count <= (size - header.offsets[c]) / g_columnSizes[c];
+    }
+    if (!ok) {
+        m_file.Close();
+        return false;
+    }
+
+    m_mapped.score = reinterpret_cast<const float*>(base + header.offsets[0]);
+    m_mapped.avgReactionTime = reinterpret_cast<const float*>(base + header.offsets[1]);
+    m_mapped.settingsKey = reinterpret_cast<const uint64_t*>(base + header.offsets[2]);
+    m_mapped.timestamp = reinterpret_cast<const int64_t*>(base + header.offsets[3]);
+    m_mapped.count = static_cast<size_t>(header.count);
+    m_snapshotLogRecords = static_cast<long long>(header.logRecords);
+    m_snapshotLogIdentity = header.logIdentity;
+    return true;
+}
+
+bool HistoryColumns::Open(const char* logPath, const char* snapshotPath) {
+    Close();
+
+    const long long logRecords = CountGameHistoryRecords(logPath);
+    if (logRecords < 0) return false;
+
+    // A snapshot that claims more than the log holds, or whose records hash
+    // differently, belongs to another log
+    if (MapSnapshot(snapshotPath) && (m_snapshotLogRecords > logRecords ||
+        GameHistoryIdentity(logPath, m_snapshotLogRecords) != m_snapshotLogIdentity)) {
+        m_file.Close();
+        m_mapped = HistoryColumnSpan();
+        m_snapshotLogRecords = 0;
+        m_snapshotLogIdentity = 0;
+    }
+
+    std::vector<GameSummary> tail;
+    if (!ReadGameHistory(tail, logPath, nullptr, m_snapshotLogRecords)) {
+        Close();
+        return false;
+    }
+    for (const GameSummary& s : tail) Append(s);
+
+    if (m_file.GetData() && m_tailScore.size() < kCompactThreshold) return true;
+
+    // Fold the tail into a new snapshot so the next start only maps it. The
+    // old mapping has to go before the rename; until then it is the source.
+    const std::string tempPath = std::string(snapshotPath) + ".tmp";
+    const HistoryColumnSpan spans[2] = { m_mapped, GetTail() };
+    if (!WriteSnapshotFile(tempPath.c_str(), spans, 2, logRecords, GameHistoryIdentity(logPath, logRecords))) return true;
+
+    std::vector<GameSummary>().swap(tail);
+    m_file.Close();
+    std::error_code ec;
+    std::filesystem::rename(tempPath, snapshotPath, ec);
+    if (ec || !MapSnapshot(snapshotPath)) {
+        // Keep working from memory: reread everything into the tail
+        std::filesystem::remove(tempPath, ec);
+        ClearTail();
+        m_mapped = HistoryColumnSpan();
+        if (!ReadGameHistory(tail, logPath)) return false;
+        for (const GameSummary& s : tail) Append(s);
+        return true;
+    }
+    ClearTail();
+    return true;
+}
+
+void HistoryColumns::Close() {
+    m_file.Close();
+    m_mapped = HistoryColumnSpan();
+    m_snapshotLogRecords = 0;
+    m_snapshotLogIdentity = 0;
+    ClearTail();
+}
+
+void HistoryColumns::ClearTail() {
+    m_tailScore.clear();
+    m_tailAvgReactionTime.clear();
+    m_tailSettingsKey.clear();
+    m_tailTimestamp.clear();
+}
+
+void HistoryColumns::Append(const GameSummary& summary) {
+    m_tailScore.push_back(summary.score);
+    m_tailAvgReactionTime.push_back(summary.avgReactionTime);
+    m_tailSettingsKey.push_back(MakeSettingsKey(summary));
+    m_tailTimestamp.push_back(static_cast<int64_t>(summary.timestamp));
+}
+
+void HistoryColumns::Reserve(size_t count) {
+    const size_t size = m_tailScore.size() + count;
+    if (size <= m_tailScore.capacity()) return;
+    // At least doubling, so reserving one game at a time stays amortized
+    const size_t capacity = std::max(size, 2 * m_tailScore.capacity());
+    m_tailScore.reserve(capacity);
+    m_tailAvgReactionTime.reserve(capacity);
+    m_tailSettingsKey.reserve(capacity);
+    m_tailTimestamp.reserve(capacity);
+}
+
+HistoryColumnSpan HistoryColumns::GetTail() const {
+    HistoryColumnSpan span;
+    span.score = m_tailScore.data();
+    span.avgReactionTime = m_tailAvgReactionTime.data();
+    span.settingsKey = m_tailSettingsKey.data();
+    span.timestamp = m_tailTimestamp.data();
+    span.count = m_tailScore.size();
+    return span;
+}
+
+void HistoryColumns::Select(uint64_t settingsKey, std::vector<uint32_t>& rows) const {
+    for (size_t i = 0; i < m_mapped.count; ++i) {
+        if (m_mapped.settingsKey[i] == settingsKey) rows.push_back(static_cast<uint32_t>(i));
+    }
+    for (size_t i = 0; i < m_tailSettingsKey.size(); ++i) {
+        if (m_tailSettingsKey[i] == settingsKey) rows.push_back(static_cast<uint32_t>(m_mapped.count + i));
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "mapped_file.h"
+#include "session.h"
+
+// One contiguous array per field, for a range of games
+struct HistoryColumnSpan {
+    const float* score = nullptr;
+    const float* avgReactionTime = nullptr;
+    const uint64_t* settingsKey = nullptr;
+    const int64_t* timestamp = nullptr;
+    size_t count = 0;
+};
+
+// The game history as columns, for the results and statistics views.
+// Startup maps a columnar snapshot of the log read-only, so nothing is
+// parsed or allocated per game; only the log records written after the
+// snapshot are read and kept in memory. Open() rewrites the snapshot when
+// it is missing, damaged, built from another log or too far behind this one.
+class HistoryColumns {
+public:
+    static const size_t kCompactThreshold = 4096;
+
+    bool Open(const char* logPath = "res/game_history.bin", const char* snapshotPath = "res/game_history.cols");
+    void Close();
+    // A game that was just appended to the log
+    void Append(const GameSummary& summary);
+    // Makes room for count more games, so that many Append()s do not allocate
+    void Reserve(size_t count);
+
+    size_t GetCount() const { return m_mapped.count + m_tailScore.size(); }
+    // Games [0, mapped.count) come from the snapshot, the rest from the tail
+    const HistoryColumnSpan& GetMapped() const { return m_mapped; }
+    HistoryColumnSpan GetTail() const;
+
+    float GetScore(size_t row) const {
+        return row < m_mapped.count ? m_mapped.score[row] : m_tailScore[row - m_mapped.count];
+    }
+    float GetAvgReactionTime(size_t row) const {
+        return row < m_mapped.count ? m_mapped.avgReactionTime[row] : m_tailAvgReactionTime[row - m_mapped.count];
+    }
+    uint64_t GetSettingsKey(size_t row) const {
+        return row < m_mapped.count ? m_mapped.settingsKey[row] : m_tailSettingsKey[row - m_mapped.count];
+    }
+    // Appends the rows played with this settings key, in game order
+    void Select(uint64_t settingsKey, std::vector<uint32_t>& rows) const;
+
+private:
+    bool MapSnapshot(const char* snapshotPath);
+    void ClearTail();
+
+    MappedFile m_file;
+    HistoryColumnSpan m_mapped;
+    long long m_snapshotLogRecords = 0;
+    uint32_t m_snapshotLogIdentity = 0;
+
+    std::vector<float> m_tailScore;
+    std::vector<float> m_tailAvgReactionTime;
+    std::vector<uint64_t> m_tailSettingsKey;
+    std::vector<int64_t> m_tailTimestamp;
+};
+
+// Writes spans (in order) as one snapshot covering the first logRecords
+// records of the log, whose GameHistoryIdentity() over those records is
+// logIdentity. Goes through a temporary file and a rename.
+bool WriteHistorySnapshot(const char* snapshotPath, const HistoryColumnSpan* spans, int spanCount, long long logRecords, uint32_t logIdentity);
@@ -0,0 +1,56 @@
+#include "history_index.h"
+
+#include <algorithm>
+
+void HistoryIndex::Accumulate(SettingsStats& stats, uint32_t row, float score, float avgReactionTime) {
+    stats.rows.push_back(row);
+    stats.score.AddMoments(score);
+    stats.reactionTimeRange.Add(avgReactionTime);
+    if (avgReactionTime > 0.0f) stats.reactionTime.AddMoments(avgReactionTime);
+}
+
+void HistoryIndex::Build(const HistoryColumns& columns) {
+    m_groups.clear();
+
+    const HistoryColumnSpan spans[2] = { columns.GetMapped(), columns.GetTail() };
+    size_t row = 0;
+    uint64_t lastKey = 0;
+    SettingsStats* last = nullptr;
+    for (const HistoryColumnSpan& span : spans) {
+        for (size_t i = 0; i < span.count; ++i, ++row) {
+            // Games come in sessions of one drill, so the previous group usually matches
+            const uint64_t key = span.settingsKey[i];
+            if (!last || key != lastKey) {
+                last = &m_groups[key];
+                lastKey = key;
+            }
+            Accumulate(*last, static_cast<uint32_t>(row), span.score[i], span.avgReactionTime[i]);
+        }
+    }
+}
+
+void HistoryIndex::Add(const HistoryColumns& columns, size_t row) {
+    Accumulate(m_groups[columns.GetSettingsKey(row)], static_cast<uint32_t>(row),
+        columns.GetScore(row), columns.GetAvgReactionTime(row));
+}
+
+void HistoryIndex::Reserve(uint64_t settingsKey) {
+    std::vector<uint32_t>& rows = m_groups[settingsKey].rows;
+    if (rows.size() < rows.capacity()) return;
+    rows.reserve(std::max<size_t>(16, 2 * rows.capacity()));
+}
+
+const SettingsStats* HistoryIndex::Find(const HistoryColumns& columns, uint64_t settingsKey) {
+    auto it = m_groups.find(settingsKey);
+    // Reserve() may have added a group no game has been played in yet
+    if (it == m_groups.end() || it->second.rows.empty()) return nullptr;
+
+    SettingsStats& stats = it->second;
+    for (; stats.quantileRows < stats.rows.size(); ++stats.quantileRows) {
+        const uint32_t row = stats.rows[stats.quantileRows];
+        stats.score.AddQuantiles(columns.GetScore(row));
+        const float reactionTime = columns.GetAvgReactionTime(row);
+        if (reactionTime > 0.0f) stats.reactionTime.AddQuantiles(reactionTime);
+    }
+    return &stats;
+}
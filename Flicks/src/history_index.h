@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "history_columns.h"
+#include "stream_stats.h"
+
+// Games played with one settings key and their running statistics
+struct SettingsStats {
+    std::vector<uint32_t> rows;     // rows of HistoryColumns, in game order
+
+    StreamStats score;
+    // Average reaction time of games that recorded a reaction at all
+    StreamStats reactionTime;
+    // Range over every game, for the plot axes
+    RunningStats reactionTimeRange;
+    // Rows already fed to the quantile estimators; Find() catches up the rest
+    size_t quantileRows = 0;
+
+    int GetGameCount() const { return static_cast<int>(rows.size()); }
+};
+
+// Settings key -> games and aggregates, built once from the columns and then
+// kept current one game at a time, so the statistics view never scans
+// the history. Quantiles are only estimated for keys someone looks at: the
+// first Find() of a key streams its games once, later ones just the new game.
+class HistoryIndex {
+public:
+    void Build(const HistoryColumns& columns);
+    // Row of a game just appended to the columns
+    void Add(const HistoryColumns& columns, size_t row);
+    // Makes sure the next Add() of a game with this key does not allocate
+    void Reserve(uint64_t settingsKey);
+    void Clear() { m_groups.clear(); }
+
+    // nullptr when no game was played with this key
+    const SettingsStats* Find(const HistoryColumns& columns, uint64_t settingsKey);
+    size_t GetGroupCount() const { return m_groups.size(); }
+
+private:
+    static void Accumulate(SettingsStats& stats, uint32_t row, float score, float avgReactionTime);
+
+    std::unordered_map<uint64_t, SettingsStats> m_groups;
+};
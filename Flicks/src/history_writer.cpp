@@ -0,0 +1,88 @@
+#include "history_writer.h"
+
+#include <cstdio>
+
+bool HistoryWriter::Start(const char* path, const char* importCsvPath) {
+    Stop();
+    if (!m_history.Open(path, importCsvPath)) return false;
+
+    m_batch.reserve(kQueueCapacity);
+    m_stop.store(false, std::memory_order_relaxed);
+    m_thread = std::thread([this] { Run(); });
+    return true;
+}
+
+void HistoryWriter::Stop() {
+    if (!m_thread.joinable()) return;
+    m_stop.store(true, std::memory_order_release);
+    m_signal.fetch_add(1, std::memory_order_release);
+    m_signal.notify_one();
+    m_thread.join();
+    m_history.Close();
+}
+
+bool HistoryWriter::Push(const GameSummary& summary) {
+    if (!m_thread.joinable() || !m_queue.TryPush(summary)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    m_signal.fetch_add(1, std::memory_order_release);
+    m_signal.notify_one();
+    return true;
+}
+
+bool HistoryWriter::PushTrace(const SessionTrace& trace, const char* path) {
+    if (!m_thread.joinable()) {
+        m_droppedTraces.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (IsWritingTrace()) return false;
+    snprintf(m_tracePath, sizeof(m_tracePath), "%s", path);
+    m_trace.store(&trace, std::memory_order_release);
+    m_signal.fetch_add(1, std::memory_order_release);
+    m_signal.notify_one();
+    return true;
+}
+
+void HistoryWriter::WaitForTrace() const {
+    const SessionTrace* trace = m_trace.load(std::memory_order_acquire);
+    while (trace) {
+        m_trace.wait(trace, std::memory_order_acquire);
+        trace = m_trace.load(std::memory_order_acquire);
+    }
+}
+
+void HistoryWriter::Run() {
+    uint32_t seen = 0;
+    for (;;) {
+        m_signal.wait(seen, std::memory_order_acquire);
+        seen = m_signal.load(std::memory_order_acquire);
+        // Read before draining, so every push that came before Stop is written
+        const bool stop = m_stop.load(std::memory_order_acquire);
+        WriteQueued();
+        WriteTrace();
+        if (stop) break;
+    }
+}
+
+void HistoryWriter::WriteQueued() {
+    m_batch.clear();
+    m_queue.Drain([this](const GameSummary& s) { m_batch.push_back(s); });
+    if (m_batch.empty()) return;
+
+    const bool ok = m_history.Append(m_batch.data(), m_batch.size()) && m_history.Sync();
+    const long long count = static_cast<long long>(m_batch.size());
+    if (ok) m_written.fetch_add(count, std::memory_order_relaxed);
+    else m_failed.fetch_add(count, std::memory_order_relaxed);
+    m_syncs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void HistoryWriter::WriteTrace() {
+    const SessionTrace* trace = m_trace.load(std::memory_order_acquire);
+    if (!trace) return;
+    if (trace->Write(m_tracePath)) m_traces.fetch_add(1, std::memory_order_relaxed);
+    else m_failedTraces.fetch_add(1, std::memory_order_relaxed);
+    // Hands the trace back to the frame thread
+    m_trace.store(nullptr, std::memory_order_release);
+    m_trace.notify_all();
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "history.h"
+#include "session_trace.h"
+#include "spsc_ring.h"
+
+// Appends finished games to the history log on its own thread, so the frame
+// that ends a game only copies a summary into a ring: no lock, allocation or
+// file access. The thread writes whatever is queued in one fwrite and syncs
+// it to disk; games that finish while a sync is in flight share the next one.
+// It also saves the trace of a finished game, which the frame hands over by
+// pointer instead of writing up to 16 MB itself.
+class HistoryWriter {
+public:
+    static const size_t kQueueCapacity = 256;
+
+    ~HistoryWriter() { Stop(); }
+
+    // Opens the log (see GameHistory::Open) and starts the thread
+    bool Start(const char* path = "res/game_history.bin", const char* importCsvPath = "res/game_summaries.csv");
+    // Writes and syncs everything queued, then closes the log
+    void Stop();
+
+    // Frame thread only. False when the ring is full or the writer is not
+    // running; the game is then counted as dropped.
+    bool Push(const GameSummary& summary);
+    // Frame thread only. Writes trace to path; the trace must not change
+    // until IsWritingTrace() is false. False while the previous trace is
+    // still being written, for the caller to try again, or when the writer
+    // is not running; only the latter counts the trace as dropped.
+    bool PushTrace(const SessionTrace& trace, const char* path);
+    bool IsWritingTrace() const { return m_trace.load(std::memory_order_acquire) != nullptr; }
+    // Blocks until the trace handed over last is written
+    void WaitForTrace() const;
+
+    bool IsRunning() const { return m_thread.joinable(); }
+    long long GetWrittenCount() const { return m_written.load(std::memory_order_relaxed); }
+    long long GetSyncCount() const { return m_syncs.load(std::memory_order_relaxed); }
+    long long GetDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+    long long GetFailedCount() const { return m_failed.load(std::memory_order_relaxed); }
+    long long GetTraceCount() const { return m_traces.load(std::memory_order_relaxed); }
+    long long GetDroppedTraceCount() const { return m_droppedTraces.load(std::memory_order_relaxed); }
+    long long GetFailedTraceCount() const { return m_failedTraces.load(std::memory_order_relaxed); }
+
+private:
+    void Run();
+    void WriteQueued();
+    void WriteTrace();
+
+    GameHistory m_history;
+    SpscRing<GameSummary, kQueueCapacity> m_queue;
+    std::vector<GameSummary> m_batch;       // writer thread, sized for a full ring
+    std::atomic<const SessionTrace*> m_trace{ nullptr };   // set by the frame, cleared once written
+    char m_tracePath[256] = {};
+    std::thread m_thread;
+    std::atomic<uint32_t> m_signal{ 0 };    // bumped on every push and on Stop
+    std::atomic<bool> m_stop{ false };
+
+    std::atomic<long long> m_written{ 0 };
+    std::atomic<long long> m_syncs{ 0 };
+    std::atomic<long long> m_dropped{ 0 };
+    std::atomic<long long> m_failed{ 0 };   // games whose write or sync reported an error
+    std::atomic<long long> m_traces{ 0 };   // traces written
+    std::atomic<long long> m_droppedTraces{ 0 };
+    std::atomic<long long> m_failedTraces{ 0 };
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "spsc_ring.h"
+
+// One raw mouse report, stamped when it was read so a click can be judged at
+// its own time and cursor position instead of the frame's
+struct InputEvent {
+    long long timeUs;
+    int dx;
+    int dy;
+    bool leftDown;
+};
+
+// Input thread -> frame loop. 4096 reports is half a second of an 8 kHz mouse.
+using InputRing = SpscRing<InputEvent, 4096>;
@@ -0,0 +1,113 @@
+#include "input_thread.h"
+
+namespace {
+    InputThread* s_instance = nullptr;
+    const wchar_t* kWindowClass = L"FlicksInputClass";
+}
+
+InputThread::~InputThread() {
+    Stop();
+}
+
+bool InputThread::Start(InputRing& ring) {
+    if (m_thread.joinable()) return true;
+
+    m_ring = &ring;
+    s_instance = this;
+
+    std::promise<bool> ready;
+    std::future<bool> started = ready.get_future();
+    m_thread = std::thread([this, &ready] { Run(ready); });
+
+    if (!started.get()) {
+        m_thread.join();
+        s_instance = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void InputThread::Stop() {
+    if (!m_thread.joinable()) return;
+    PostThreadMessage(m_threadId, WM_QUIT, 0, 0);
+    m_thread.join();
+    s_instance = nullptr;
+}
+
+void InputThread::Run(std::promise<bool>& ready) {
+    m_threadId = GetCurrentThreadId();
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+
+    HINSTANCE hInstance = GetModuleHandle(NULL);
+    WNDCLASSEX wc = { sizeof(WNDCLASSEX), 0, WndProc, 0, 0, hInstance, NULL, NULL, NULL, NULL, kWindowClass, NULL };
+    RegisterClassEx(&wc);
+    m_hWnd = CreateWindowEx(0, kWindowClass, L"", 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, hInstance, NULL);
+
+    RAWINPUTDEVICE rid[1];
+    rid[0].usUsagePage = 0x01;
+    rid[0].usUsage = 0x02;
+    rid[0].dwFlags = RIDEV_INPUTSINK;
+    rid[0].hwndTarget = m_hWnd;
+    if (!m_hWnd || !RegisterRawInputDevices(rid, 1, sizeof(rid[0]))) {
+        if (m_hWnd) DestroyWindow(m_hWnd);
+        m_hWnd = NULL;
+        UnregisterClass(kWindowClass, hInstance);
+        ready.set_value(false);
+        return;
+    }
+    ready.set_value(true);
+
+    MSG msg;
+    while (GetMessage(&msg, NULL, 0, 0) > 0) {
+        DispatchMessage(&msg);
+    }
+
+    rid[0].dwFlags = RIDEV_REMOVE;
+    rid[0].hwndTarget = NULL;
+    RegisterRawInputDevices(rid, 1, sizeof(rid[0]));
+    DestroyWindow(m_hWnd);
+    m_hWnd = NULL;
+    UnregisterClass(kWindowClass, hInstance);
+}
+
+LRESULT CALLBACK InputThread::WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+    if (msg == WM_INPUT && s_instance) {
+        s_instance->ReadPending((HRAWINPUT)lParam);
+        return 0;
+    }
+    return DefWindowProc(hWnd, msg, wParam, lParam);
+}
+
+void InputThread::ReadPending(HRAWINPUT first) {
+    const long long nowUs = NowUs();
+
+    // The report that woke us up
+    UINT size = sizeof(m_batch);
+    if (GetRawInputData(first, RID_INPUT, m_batch, &size, sizeof(RAWINPUTHEADER)) != static_cast<UINT>(-1)) {
+        Push(reinterpret_cast<RAWINPUT*>(m_batch), nowUs);
+    }
+
+    // Then everything queued behind it, without a message round trip per report
+    for (;;) {
+        size = sizeof(m_batch);
+        UINT count = GetRawInputBuffer(reinterpret_cast<RAWINPUT*>(m_batch), &size, sizeof(RAWINPUTHEADER));
+        if (count == 0 || count == static_cast<UINT>(-1)) break;
+
+        RAWINPUT* raw = reinterpret_cast<RAWINPUT*>(m_batch);
+        for (UINT i = 0; i < count; ++i) {
+            Push(raw, nowUs);
+            raw = NEXTRAWINPUTBLOCK(raw);
+        }
+    }
+}
+
+void InputThread::Push(const RAWINPUT* raw, long long timeUs) {
+    if (raw->header.dwType != RIM_TYPEMOUSE) return;
+
+    InputEvent e;
+    e.timeUs = timeUs;
+    e.dx = raw->data.mouse.lLastX;
+    e.dy = raw->data.mouse.lLastY;
+    e.leftDown = (raw->data.mouse.usButtonFlags & RI_MOUSE_BUTTON_1_DOWN) != 0;
+    if (!m_ring->TryPush(e)) m_dropped.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <windows.h>
+#include <atomic>
+#include <future>
+#include <thread>
+
+#include "clock.h"
+#include "input.h"
+
+// Owns raw mouse input: a high-priority thread with a message-only window reads
+// WM_INPUT in batches through GetRawInputBuffer and queues stamped reports, so
+// they are never held up behind ImGui, rendering or Present on the UI thread.
+class InputThread {
+public:
+    ~InputThread();
+
+    // Returns once the device is registered; false if that failed
+    bool Start(InputRing& ring);
+    void Stop();
+
+    // Reports lost because the frame loop fell more than a ring behind
+    unsigned long long GetDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    void Run(std::promise<bool>& ready);
+    void ReadPending(HRAWINPUT first);
+    void Push(const RAWINPUT* raw, long long timeUs);
+    static LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
+
+    InputRing* m_ring = nullptr;
+    std::thread m_thread;
+    DWORD m_threadId = 0;
+    HWND m_hWnd = NULL;
+    std::atomic<unsigned long long> m_dropped{ 0 };
+
+    alignas(8) BYTE m_batch[16 * 1024];
+};
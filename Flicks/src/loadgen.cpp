@@ -0,0 +1,115 @@
+#include "loadgen.h"
+#include "clock.h"
+#include "stream_stats.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <thread>
+
+namespace {
+    struct WorkerResult {
+        std::vector<float> scores;
+        std::vector<float> hits;
+        std::vector<GameSummary> summaries;
+        double reactionSum = 0.0;
+        long long reactionCount = 0;
+        long long totalHits = 0;
+        long long totalAttempts = 0;
+        long long spawnFallbacks = 0;
+    };
+
+    void RunWorker(const LoadGenConfig& config, int index, long long sessions, WorkerResult& out) {
+        Rng seeds(config.seed, static_cast<uint64_t>(index));
+
+        FlicksSession session;
+        session.Configure(config.settings, config.field);
+        session.Seed(seeds.Next64());
+        Rng playerRng(seeds.Next64(), RNG_STREAM_PLAYER);
+
+        out.scores.reserve(sessions);
+        out.hits.reserve(sessions);
+        if (config.keepSummaries) out.summaries.reserve(sessions);
+        const std::time_t now = std::time(nullptr);
+
+        for (long long i = 0; i < sessions; ++i) {
+            if (config.sharedSchedule) session.Seed(config.seed);
+            const GameResult& result = SimulateSession(session, config.player, playerRng);
+            out.scores.push_back(result.score);
+            out.hits.push_back(static_cast<float>(result.hits));
+            out.totalHits += result.hits;
+            out.totalAttempts += result.attempts;
+            out.spawnFallbacks += result.spawnFallbacks;
+            if (result.hits > 0) {
+                out.reactionSum += result.avgReactionTime;
+                out.reactionCount++;
+            }
+            if (config.keepSummaries) out.summaries.push_back(MakeGameSummary(result, now));
+        }
+    }
+
+    Distribution Describe(std::vector<float>& values) {
+        Distribution d;
+        if (values.empty()) return d;
+
+        RunningStats stats;
+        for (float v : values) stats.Add(v);
+        d.min = stats.GetMin();
+        d.max = stats.GetMax();
+        d.mean = stats.GetMean();
+        d.stddev = stats.GetStddev();
+        d.p10 = ExactQuantile(values, 0.10);
+        d.p50 = ExactQuantile(values, 0.50);
+        d.p90 = ExactQuantile(values, 0.90);
+        return d;
+    }
+}
+
+LoadGenReport RunLoadGen(const LoadGenConfig& config) {
+    int threadCount = config.threads;
+    if (threadCount <= 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = static_cast<int>(std::min<long long>(threadCount, std::max(1LL, config.sessions)));
+
+    std::vector<WorkerResult> results(threadCount);
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount);
+
+    const long long beginNs = NowNs();
+    for (int t = 0; t < threadCount; ++t) {
+        long long share = config.sessions / threadCount + (t < config.sessions % threadCount ? 1 : 0);
+        workers.emplace_back(RunWorker, std::cref(config), t, share, std::ref(results[t]));
+    }
+    for (std::thread& worker : workers) worker.join();
+    double seconds = (NowNs() - beginNs) / 1e9;
+
+    LoadGenReport report;
+    report.sessions = config.sessions;
+    report.threads = threadCount;
+    report.seconds = seconds;
+    report.sessionsPerSec = seconds > 0.0 ? config.sessions / seconds : 0.0;
+
+    std::vector<float> scores;
+    std::vector<float> hits;
+    scores.reserve(config.sessions);
+    hits.reserve(config.sessions);
+    double reactionSum = 0.0;
+    long long reactionCount = 0;
+    long long totalHits = 0;
+    long long totalAttempts = 0;
+
+    for (WorkerResult& r : results) {
+        scores.insert(scores.end(), r.scores.begin(), r.scores.end());
+        hits.insert(hits.end(), r.hits.begin(), r.hits.end());
+        report.summaries.insert(report.summaries.end(), r.summaries.begin(), r.summaries.end());
+        reactionSum += r.reactionSum;
+        reactionCount += r.reactionCount;
+        totalHits += r.totalHits;
+        totalAttempts += r.totalAttempts;
+        report.spawnFallbacks += r.spawnFallbacks;
+    }
+
+    report.score = Describe(scores);
+    report.hits = Describe(hits);
+    report.avgReactionTime = reactionCount > 0 ? reactionSum / reactionCount : 0.0;
+    report.accuracy = totalAttempts > 0 ? 100.0 * totalHits / totalAttempts : 0.0;
+    return report;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "settings.h"
+#include "field.h"
+#include "session.h"
+#include "simulate.h"
+
+struct LoadGenConfig {
+    GameSettings settings;
+    FieldCache field;
+    SimPlayer player;
+    long long sessions = 1000;
+    int threads = 0;                // 0 = one per hardware thread
+    uint64_t seed = 1;              // each thread derives its own session and player streams
+    bool sharedSchedule = false;    // every game uses seed as its game seed, so all players face the same targets
+    bool keepSummaries = false;
+};
+
+struct Distribution {
+    double min = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0;
+    double p10 = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+};
+
+struct LoadGenReport {
+    long long sessions = 0;
+    int threads = 0;
+    double seconds = 0.0;
+    double sessionsPerSec = 0.0;
+    Distribution score;
+    Distribution hits;
+    double avgReactionTime = 0.0;   // mean over sessions with at least one hit
+    double accuracy = 0.0;
+    long long spawnFallbacks = 0;
+    std::vector<GameSummary> summaries;
+};
+
+// Runs config.sessions simulated games split across worker threads
+LoadGenReport RunLoadGen(const LoadGenConfig& config);
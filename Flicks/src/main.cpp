@@ -3,12 +3,9 @@
 #include <d3d11.h>
 #include <dxgi.h>
 #include <dxgi1_2.h>
-#include <d3dcompiler.h>
 #include <wrl/client.h>
 #include <tchar.h>
 #include <cmath>
-#include <random>
-#include <chrono>
 #include <cstdlib>
 #include <ctime>
 #include <algorithm>
@@ -17,9 +14,10 @@
 #include <fstream>
 #include <cstring>
 #include <filesystem>
+#include <string>
+#include <thread>
 #pragma comment(lib, "winmm.lib")
 #pragma comment(lib, "xaudio2.lib")
-#pragma comment(lib, "d3dcompiler.lib")
 
 #include "imgui.h"
 #include "implot.h"
@@ -30,6 +28,20 @@
 #include "renderer.h"
 #include "audio_xa.h"
 #include "ImguiTheme.h"
+#include "session.h"
+#include "session_trace.h"
+#include "session_replay.h"
+#include "history_writer.h"
+#include "history_columns.h"
+#include "history_index.h"
+#include "settings_key.h"
+#include "presets.h"
+#include "input_thread.h"
+#include "clock.h"
+#include "frame_stats.h"
+#include "frame_pacer.h"
+#include "scene.h"
+#include "startup.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -38,303 +50,67 @@ HWND g_hWnd = NULL;
 int g_WindowWidth = 800;
 int g_WindowHeight = 600;
 Renderer g_renderer;
-Renderer::FieldCache g_fieldCache;
+FieldCache g_fieldCache;
+FlicksSession g_session;
 // Mouse global variables
 static bool g_active = true;
 static double g_cursorPosX = 0;
 static double g_cursorPosY = 0;
-static int g_accumulatedMouseDeltaX = 0;
-static int g_accumulatedMouseDeltaY = 0;
-static bool g_leftButtonPressedRaw = false;
-static bool g_leftButtonPressed = false;
+// Raw mouse reports from the input thread, drained every frame
+static InputRing g_inputRing;
+static InputThread g_inputThread;
 static UINT g_mouseSpeed = 10;
 float g_mouseSpeedMultiplier = 1.0f;
 static bool g_mouseCaptured = false;
 
-struct GameSettings {
-    ImVec4 bgColor = ImVec4(0.2f, 0.2f, 0.2f, 1.0f);
-    ImVec4 fieldColor = ImVec4(0.1f, 0.1f, 0.1f, 1.0f);
-    ImVec4 circleColor = ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
-    ImVec4 cursorColor = ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
-    float cursorThickness = 0.0f;
-    ImVec4 cursorOutlineColor = ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
-    bool useCustomCursor = true;
-
-    float scale = 0.9f;
-    float circleRadiusNorm = 0.112f;
-    float cursorRadiusNorm = 0.015f;
-
-    int circleLifetimeMs = 250;
-    int gameTimeSec = 60;
-    float distanceRatio = 0.2f;
-
-    int minSpawnDelayMs = 0;
-    int maxSpawnDelayMs = 0;
-
-    bool endBySpawnCount = false;
-    int maxSpawnCount = 0;
-
-    UINT frameLatency = 1;
-} settings;
-
-struct GameResult {
-    GameSettings settings;
-    int hits = 0;
-    int attempts = 0;
-    float accuracy = 0.0f;
-    float avgReactionTime = 0.0f;
-    float score = 0.0f;
-    std::vector<int> scoreHistory;
-    std::vector<int> reactionTimes;
-};
-
-struct GameSummary {
-    float circleRadiusNorm;
-    float cursorRadiusNorm;
-    int circleLifetimeMs;
-    int gameTimeSec;
-    bool endBySpawnCount;
-    int maxSpawnCount;
-    int minSpawnDelayMs;
-    int maxSpawnDelayMs;
-    int hits;
-    float avgReactionTime;
-    float score;
-    std::time_t timestamp;
-};
-
-// Global vectors for summaries
-std::vector<GameSummary> g_allGameSummaries;
-std::vector<GameSummary> g_currentSettingSummaries;
-static std::vector<int> g_reactionTimes;
-static int g_lastReactionTime = 0;
-static std::vector<double> reaction_xs, reaction_ys;
-// Global variables to store initial settings and last game results
-GameSettings gameStartSettings;
+GameSettings settings;
+
+// Finished games are appended to the log by a writer thread; the views
+// read the same history as columns
+HistoryWriter g_historyWriter;
+HistoryColumns g_historyColumns;
+// Games and aggregates per settings key, kept current as games finish
+HistoryIndex g_historyIndex;
+// Whether startup could read the earlier games, and whether the last game
+// made it into the writer's queue; the results window reports both
+static bool g_historyLoaded = false;
+static bool g_lastGameQueued = true;
+// Last finished game shown in the results window
 GameResult lastGameResult;
+// Every event of the running game. When it ends its buffer goes to the
+// history writer to be saved to res/traces and stays as it is for the
+// replay; the next game records into the other buffer.
+SessionTrace g_sessionTraces[2];
+SessionTrace* g_sessionTrace = &g_sessionTraces[0];
+const SessionTrace* g_lastTrace = nullptr;
+// A finished game's trace the writer could not take yet, being still busy
+// with the one before; it stays in g_sessionTrace until handed over
+static bool g_tracePending = false;
+static char g_pendingTracePath[64];
+// Plays the last recorded game back through g_session instead of live input
+SessionReplay g_replay;
+static float g_replaySpeed = 1.0f;
+static long long g_replayWallStartUs = 0;
+static bool g_replayChecked = false;
+static ReplayCheck g_replayCheck;
+// Stage timings of the last frames, for the overlay and the dumps
+FrameStats g_frameStats;
+// When each frame may start, per settings.framePacing
+FramePacer g_framePacer(NowUs);
+// Summaries of the ring, overall and per pacing mode, refreshed twice a second
+static FrameStatsSummary g_frameSummary;
+static FrameStatsSummary g_pacingSummaries[PACING_COUNT][2];     // [mode][late latch]
 
-// Spawn delay management
-bool isCircleActive = false;
-bool isLastCircle = false;
-long long nextSpawnTimeMs = 0;
-
-int randomInt(int min, int max) {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    if (min > max) std::swap(min, max);
-    std::uniform_int_distribution<int> dis(min, max);
-    return dis(gen);
-}
-
-// Cfg
-void SaveColorSettings() {
-    FILE* f;
-    if (fopen_s(&f, "res/cfg.ini", "w") == 0) {
-        fprintf(f, "bgColor=%.3f,%.3f,%.3f,%.3f\n",
-            settings.bgColor.x, settings.bgColor.y, settings.bgColor.z, settings.bgColor.w);
-        fprintf(f, "fieldColor=%.3f,%.3f,%.3f,%.3f\n",
-            settings.fieldColor.x, settings.fieldColor.y, settings.fieldColor.z, settings.fieldColor.w);
-        fprintf(f, "circleColor=%.3f,%.3f,%.3f,%.3f\n",
-            settings.circleColor.x, settings.circleColor.y, settings.circleColor.z, settings.circleColor.w);
-        fprintf(f, "cursorColor=%.3f,%.3f,%.3f,%.3f\n",
-            settings.cursorColor.x, settings.cursorColor.y, settings.cursorColor.z, settings.cursorColor.w);
-        fprintf(f, "cursorThickness=%.3f\n", settings.cursorThickness);
-        fprintf(f, "cursorOutlineColor=%.3f,%.3f,%.3f,%.3f\n",
-            settings.cursorOutlineColor.x, settings.cursorOutlineColor.y,
-            settings.cursorOutlineColor.z, settings.cursorOutlineColor.w);
-        fprintf(f, "useCustomCursor=%d\n", settings.useCustomCursor ? 1 : 0);
-        fprintf(f, "scale=%.3f\n", settings.scale);
-        fprintf(f, "circleRadiusNorm=%.3f\n", settings.circleRadiusNorm);
-        fprintf(f, "cursorRadiusNorm=%.3f\n", settings.cursorRadiusNorm);
-        fprintf(f, "circleLifetimeMs=%d\n", settings.circleLifetimeMs);
-        fprintf(f, "gameTimeSec=%d\n", settings.gameTimeSec);
-        fprintf(f, "minSpawnDelayMs=%d\n", settings.minSpawnDelayMs);
-        fprintf(f, "maxSpawnDelayMs=%d\n", settings.maxSpawnDelayMs);
-        fprintf(f, "endBySpawnCount=%d\n", settings.endBySpawnCount ? 1 : 0);
-        fprintf(f, "maxSpawnCount=%d\n", settings.maxSpawnCount);
-
-        fprintf(f, "frameLatency=%d\n", settings.frameLatency);
-
-        fclose(f);
-    }
-}
-
-void LoadColorSettings() {
-    FILE* f;
-    if (fopen_s(&f, "res/cfg.ini", "r") == 0) {
-        char line[256];
-        while (fgets(line, sizeof(line), f)) {
-            float r, g, b, a;
-            float thickness;
-            float scaleValue;
-            int useCustom;
-            int intVal;
-            if (sscanf_s(line, "bgColor=%f,%f,%f,%f", &r, &g, &b, &a) == 4) {
-                settings.bgColor = ImVec4(r, g, b, a);
-            }
-            else if (sscanf_s(line, "fieldColor=%f,%f,%f,%f", &r, &g, &b, &a) == 4) {
-                settings.fieldColor = ImVec4(r, g, b, a);
-            }
-            else if (sscanf_s(line, "circleColor=%f,%f,%f,%f", &r, &g, &b, &a) == 4) {
-                settings.circleColor = ImVec4(r, g, b, a);
-            }
-            else if (sscanf_s(line, "cursorColor=%f,%f,%f,%f", &r, &g, &b, &a) == 4) {
-                settings.cursorColor = ImVec4(r, g, b, a);
-            }
-            if (sscanf_s(line, "cursorThickness=%f", &thickness) == 1) {
-                settings.cursorThickness = thickness;
-            }
-            else if (sscanf_s(line, "cursorOutlineColor=%f,%f,%f,%f", &r, &g, &b, &a) == 4) {
-                settings.cursorOutlineColor = ImVec4(r, g, b, a);
-            }
-            else if (sscanf_s(line, "useCustomCursor=%d", &useCustom) == 1) {
-                settings.useCustomCursor = (useCustom != 0);
-            }
-            else if (sscanf_s(line, "scale=%f", &scaleValue) == 1) {
-                settings.scale = scaleValue;
-            }
-            else if (sscanf_s(line, "circleRadiusNorm=%f", &scaleValue) == 1) {
-                settings.circleRadiusNorm = scaleValue;
-            }
-            else if (sscanf_s(line, "cursorRadiusNorm=%f", &scaleValue) == 1) {
-                settings.cursorRadiusNorm = scaleValue;
-            }
-            else if (sscanf_s(line, "circleLifetimeMs=%d", &intVal) == 1) {
-                settings.circleLifetimeMs = intVal;
-            }
-            else if (sscanf_s(line, "gameTimeSec=%d", &intVal) == 1) {
-                settings.gameTimeSec = intVal;
-            }
-            else if (sscanf_s(line, "minSpawnDelayMs=%d", &intVal) == 1) {
-                settings.minSpawnDelayMs = intVal;
-            }
-            else if (sscanf_s(line, "maxSpawnDelayMs=%d", &intVal) == 1) {
-                settings.maxSpawnDelayMs = intVal;
-            }
-            else if (sscanf_s(line, "endBySpawnCount=%d", &intVal) == 1) {
-                settings.endBySpawnCount = (intVal != 0);
-            }
-            else if (sscanf_s(line, "maxSpawnCount=%d", &intVal) == 1) {
-                settings.maxSpawnCount = intVal;
-            }
-
-            else if (sscanf_s(line, "frameLatency=%d", &intVal) == 1) {
-                settings.frameLatency = intVal;
-            }
-        }
-        fclose(f);
-    }
-}
-
-// game_summaries
-void SaveGameSummaries() {
-    FILE* f;
-    if (fopen_s(&f, "res/game_summaries.csv", "w") == 0) {
-        fprintf(f,
-            "circleRadiusNorm,"
-            "cursorRadiusNorm,"
-            "circleLifetimeMs,"
-            "gameTimeSec,"
-            "minSpawnDelayMs,"
-            "maxSpawnDelayMs,"
-            "endBySpawnCount,"
-            "maxSpawnCount,"
-            "hits,"
-            "avgReactionTime,"
-            "score,"
-            "timestamp\n"
-        );
-
-        for (const auto& s : g_allGameSummaries) {
-            fprintf(f,
-                "%.3f,%.3f,%d,%d,%d,%d,%d,%d,%d,%.1f,%.1f,%lld\n",
-                s.circleRadiusNorm,
-                s.cursorRadiusNorm,
-                s.circleLifetimeMs,
-                s.gameTimeSec,
-                s.minSpawnDelayMs,
-                s.maxSpawnDelayMs,
-                s.endBySpawnCount ? 1 : 0,
-                s.maxSpawnCount,
-                s.hits,
-                s.avgReactionTime,
-                s.score,
-                static_cast<long long>(s.timestamp)
-            );
-        }
-        fclose(f);
-    }
-}
-
-void LoadGameSummaries() {
-    FILE* f;
-    if (fopen_s(&f, "res/game_summaries.csv", "r") == 0) {
-        char line[512];
-        fgets(line, sizeof(line), f);
-        while (fgets(line, sizeof(line), f)) {
-            GameSummary s;
-            long long ts = 0;
-            int tempEnd = 0;
-            int tempMax = 0;
-            float avgRT = 0.0f;
-            int count = sscanf_s(
-                line,
-                "%f,%f,%d,%d,%d,%d,%d,%d,%d,%f,%f,%lld",
-                &s.circleRadiusNorm,
-                &s.cursorRadiusNorm,
-                &s.circleLifetimeMs,
-                &s.gameTimeSec,
-                &s.minSpawnDelayMs,
-                &s.maxSpawnDelayMs,
-                &tempEnd,
-                &tempMax,
-                &s.hits,
-                &avgRT,
-                &s.score,
-                &ts
-            );
-            if (count == 12) {
-                s.endBySpawnCount = (tempEnd != 0);
-                s.maxSpawnCount = tempMax;
-                s.avgReactionTime = avgRT;
-                s.timestamp = static_cast<std::time_t>(ts);
-                g_allGameSummaries.push_back(s);
-            }
-        }
-        fclose(f);
-    }
-}
-
-enum GameState {
-    GAME_NOT_STARTED,
-    GAME_RUNNING,
-    GAME_FINISHED
-};
-GameState gameState = GAME_NOT_STARTED;
-
-// Game variables
-long long gameStartTimeMs = 0;
-long long circleSpawnTimeMs = 0;
-ImVec2 circlePos = ImVec2(0, 0);
-int hits = 0;
-int attempts = 0;
-int spawnCount = 0;
 bool showSettings = false;
 bool showResults = false;
+bool showFrameStats = false;
 
-static ImVec2 lastCirclePos(0, 0);
-static bool firstCircle = true;
-static std::random_device rd;
-static std::mt19937 gen(rd());
-
-static std::vector<int> g_scoreHistory;
-static int g_lastSampleSecond = 0;
-
-void ResetGame();
-void StartGame();
-void SpawnCircle(int screenW, int screenH);
 void ShowResultsWindow();
 void ShowSettingsWindow();
+void ShowFrameStatsOverlay();
+static void UpdateFrameSummaries();
+static void DumpFrameTimes(bool binary);
+static void StartReplay();
 
 // Cursor update
 void UpdateCursor() {
@@ -427,17 +203,6 @@ void ReleaseMouseFromWindow(HWND hWnd) {
     UpdateCursor();
 }
 
-float randomFloat(float min, float max) {
-    std::uniform_real_distribution<float> dis(min, max);
-    return dis(gen);
-}
-
-float distance(float x1, float y1, float x2, float y2) {
-    float dx = x1 - x2;
-    float dy = y1 - y2;
-    return std::sqrt(dx * dx + dy * dy);
-}
-
 DEVMODE getCurrentDisplayMode() {
     DEVMODE dm = {};
     dm.dmSize = sizeof(dm);
@@ -454,93 +219,23 @@ void UpdateFieldCache() {
     );
 }
 
-void ResetGame() {
-    hits = 0;
-    attempts = 0;
-    spawnCount = 0;
-    gameState = GAME_NOT_STARTED;
-    showResults = false;
-    firstCircle = true;
-    lastCirclePos = ImVec2(0, 0);
-    isCircleActive = false;
-    isLastCircle = false;
-    nextSpawnTimeMs = 0;
-
-    g_scoreHistory.clear();
-    g_scoreHistory.reserve(settings.gameTimeSec + 1);
-
-    g_reactionTimes.clear();
-    g_reactionTimes.reserve(settings.endBySpawnCount ?
-        settings.maxSpawnCount :
-        settings.gameTimeSec * 10);
-    g_lastReactionTime = 0;
-}
-
-void StartGame() {
-    gameState = GAME_RUNNING;
-    gameStartTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::steady_clock::now().time_since_epoch()
-    ).count();
-    g_scoreHistory.clear();
-    g_scoreHistory.push_back(0);
-    g_lastSampleSecond = 0;
-    spawnCount = 0;
-    isLastCircle = false;
-
-    // Capture settings at game start
-    gameStartSettings = settings;
-
-    // Initialize spawn delay variables
-    isCircleActive = false;
-
-    // Установка задержки перед первым спауном
-    int delay = randomInt(settings.minSpawnDelayMs, settings.maxSpawnDelayMs);
-    nextSpawnTimeMs = gameStartTimeMs + delay;
+// Plot getter over the games of one settings key: x is the game number
+struct HistoryPlotData {
+    const std::vector<uint32_t>* rows;
+    bool reactionTime;
+};
 
-    showResults = false;
+static ImPlotPoint GetHistoryPoint(int idx, void* data) {
+    const HistoryPlotData* plot = static_cast<const HistoryPlotData*>(data);
+    const uint32_t row = (*plot->rows)[idx];
+    return ImPlotPoint(idx + 1,
+        plot->reactionTime ? g_historyColumns.GetAvgReactionTime(row) : g_historyColumns.GetScore(row));
 }
 
-void SpawnCircle(int screenW, int screenH) {
-    float halfField = g_fieldCache.halfField;
-    ImVec2 center = g_fieldCache.center;
-    float R = g_fieldCache.circleRadiusPx;
-    float a = g_fieldCache.spawnMaxRadius;
-    float minDistance = std::max(0.0f, (g_fieldCache.fieldSize - 2.0f * R) * settings.distanceRatio);
-
-    if (a <= 0.0f) {
-        circlePos = center;
-        circleSpawnTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now().time_since_epoch()
-        ).count();
-        return;
-    }
-
-    float x, y;
-    int attemptsLocal = 0;
-    const int maxAttempts = 50;
-
-    do {
-        float t = randomFloat(0.0f, 2.0f * 3.1415926535f);
-        float r = std::sqrt(randomFloat(0.0f, 1.0f));
-        x = center.x + a * r * std::cos(t);
-        y = center.y + a * r * std::sin(t);
-        attemptsLocal++;
-    } while (!firstCircle &&
-        attemptsLocal < maxAttempts &&
-        distance(x, y, lastCirclePos.x, lastCirclePos.y) < minDistance);
-
-    if (attemptsLocal >= maxAttempts) {
-        // Fallback to center if placement fails
-        x = center.x;
-        y = center.y;
-    }
-
-    circlePos = ImVec2(x, y);
-    circleSpawnTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::steady_clock::now().time_since_epoch()
-    ).count();
-    lastCirclePos = circlePos;
-    firstCircle = false;
+// Reaction times of the last game in ms; x is the circle number
+static ImPlotPoint GetReactionPoint(int idx, void* data) {
+    const std::vector<int>* reactionTimesUs = static_cast<const std::vector<int>*>(data);
+    return ImPlotPoint(idx + 1, (*reactionTimesUs)[idx] / 1000.0);
 }
 
 void ShowResultsWindow() {
@@ -570,27 +265,12 @@ void ShowResultsWindow() {
         hitsValues.push_back(static_cast<float>(lastGameResult.scoreHistory[i]));
     }
 
-    int min_val = 0;
-    int max_val = 0;
+    float min_val = 0.0f;
+    float max_val = 0.0f;
     float avgReaction = 0.0f;
 
-    // Filter previous games to fit current settings
-    g_currentSettingSummaries.clear();
-    const float EPS = 0.001f;
-
-    for (const auto& s : g_allGameSummaries) {
-        if (std::abs(s.circleRadiusNorm - lastGameResult.settings.circleRadiusNorm) < EPS
-            && std::abs(s.cursorRadiusNorm - lastGameResult.settings.cursorRadiusNorm) < EPS
-            && s.circleLifetimeMs == lastGameResult.settings.circleLifetimeMs
-            && s.gameTimeSec == lastGameResult.settings.gameTimeSec
-            && s.minSpawnDelayMs == lastGameResult.settings.minSpawnDelayMs
-            && s.maxSpawnDelayMs == lastGameResult.settings.maxSpawnDelayMs
-            && s.endBySpawnCount == lastGameResult.settings.endBySpawnCount
-            && (!s.endBySpawnCount || s.maxSpawnCount == lastGameResult.settings.maxSpawnCount)
-            ) {
-            g_currentSettingSummaries.push_back(s);
-        }
-    }
+    // Previous games with the same settings
+    const SettingsStats* settingStats = g_historyIndex.Find(g_historyColumns, MakeSettingsKey(lastGameResult.settings));
 
     if (ImGui::BeginTabBar("##ResultsTabs")) {
         if (ImGui::BeginTabItem("Current Game")) {
@@ -612,31 +292,13 @@ void ShowResultsWindow() {
                 }
             }
 
-            if (!lastGameResult.reactionTimes.empty()) {
-                reaction_xs.clear();
-                reaction_ys.clear();
-
-                reaction_xs.reserve(lastGameResult.reactionTimes.size());
-                reaction_ys.reserve(lastGameResult.reactionTimes.size());
-
-                for (size_t i = 0; i < lastGameResult.reactionTimes.size(); ++i) {
-                    reaction_xs.push_back(static_cast<double>(i + 1));
-                    reaction_ys.push_back(static_cast<double>(lastGameResult.reactionTimes[i]));
-                }
-
-                const double x_max = static_cast<double>(reaction_xs.size());
+            if (!lastGameResult.reactionTimesUs.empty()) {
+                const int reactionCount = static_cast<int>(lastGameResult.reactionTimesUs.size());
+                const double x_max = static_cast<double>(reactionCount);
 
-                // Calculate dynamic limits for Y
-                min_val = lastGameResult.reactionTimes[0];
-                max_val = lastGameResult.reactionTimes[0];
-                long long sum = lastGameResult.reactionTimes[0];
-
-                for (size_t i = 1; i < lastGameResult.reactionTimes.size(); ++i) {
-                    const int rt = lastGameResult.reactionTimes[i];
-                    if (rt < min_val) min_val = rt;
-                    if (rt > max_val) max_val = rt;
-                    sum += rt;
-                }
+                // Limits for Y come from the stats collected during the game
+                min_val = static_cast<float>(lastGameResult.reactionStats.GetMin());
+                max_val = static_cast<float>(lastGameResult.reactionStats.GetMax());
 
                 // rt avg 
                 avgReaction = lastGameResult.avgReactionTime;
@@ -656,10 +318,10 @@ void ShowResultsWindow() {
                     ImPlot::SetupAxisLimits(ImAxis_Y1, y_min, y_max, ImPlotCond_Always);
 
                     ImPlot::SetNextLineStyle(ImVec4(0.55f, 0.0f, 0.95f, 1.0f), 2.0f);
-                    ImPlot::PlotLine("##ReactionLine",
-                        reaction_xs.data(),
-                        reaction_ys.data(),
-                        static_cast<int>(reaction_xs.size()));
+                    ImPlot::PlotLineG("##ReactionLine",
+                        GetReactionPoint,
+                        &lastGameResult.reactionTimesUs,
+                        reactionCount);
                     ImPlot::EndPlot();
                 }
             }
@@ -670,10 +332,14 @@ void ShowResultsWindow() {
             ImGui::Text("Hits: %d", lastGameResult.hits);
             ImGui::Text("Accuracy: %.2f%%", lastGameResult.accuracy);
             ImGui::Separator();
-            if (!lastGameResult.reactionTimes.empty()) {
-                ImGui::Text("Min reaction time: %d ms", min_val);
-                ImGui::Text("Max reaction time: %d ms", max_val);
-                ImGui::Text("Avg reaction time: %.1f ms", avgReaction);
+            if (!lastGameResult.reactionTimesUs.empty()) {
+                ImGui::Text("Min reaction time: %.2f ms", min_val);
+                ImGui::Text("Max reaction time: %.2f ms", max_val);
+                ImGui::Text("Avg reaction time: %.2f ms", avgReaction);
+                ImGui::Text("Reaction time p50 / p90 / p99: %.2f / %.2f / %.2f ms",
+                    lastGameResult.reactionQuantiles.p50,
+                    lastGameResult.reactionQuantiles.p90,
+                    lastGameResult.reactionQuantiles.p99);
             }
             else {
                 ImGui::Text("No reaction data available");
@@ -693,6 +359,58 @@ void ShowResultsWindow() {
             }
             ImGui::Text("Cursor hitbox size: %.1f%%",
                 lastGameResult.settings.cursorRadiusNorm * 100.0f);
+            ImGui::Text("Seed: %llu", static_cast<unsigned long long>(lastGameResult.seed));
+
+            // Games that never reach the log are gone after a restart
+            const ImVec4 warningColor(1.0f, 0.4f, 0.4f, 1.0f);
+            if (!g_historyWriter.IsRunning()) {
+                ImGui::TextColored(warningColor, "History is not being saved: res/game_history.bin could not be opened");
+            }
+            else if (!g_lastGameQueued) {
+                ImGui::TextColored(warningColor, "This game was not saved: the history writer is behind");
+            }
+            const long long dropped = g_historyWriter.GetDroppedCount();
+            const long long failed = g_historyWriter.GetFailedCount();
+            if (dropped > 0 || failed > 0) {
+                ImGui::TextColored(warningColor, "Not saved this session: %lld dropped, %lld failed to write", dropped, failed);
+            }
+            const long long droppedTraces = g_historyWriter.GetDroppedTraceCount();
+            const long long failedTraces = g_historyWriter.GetFailedTraceCount();
+            if (droppedTraces > 0 || failedTraces > 0) {
+                ImGui::TextColored(warningColor, "Traces not saved this session: %lld dropped, %lld failed to write", droppedTraces, failedTraces);
+            }
+            if (!g_historyLoaded) {
+                ImGui::TextDisabled("Earlier games could not be read from res/game_history.bin");
+            }
+
+            // Replay of the recorded game, checked against what was recorded
+            if (!g_sessionTrace->IsRecording() && g_lastTrace && g_lastTrace->GetEventCount() > 0) {
+                ImGui::Separator();
+                static const float speeds[] = { 1.0f, 2.0f, 4.0f, 8.0f };
+                static const char* speedNames[] = { "1x", "2x", "4x", "8x" };
+                static int speedIndex = 0;
+                ImGui::SetNextItemWidth(80.0f);
+                ImGui::Combo("##replaySpeed", &speedIndex, speedNames, IM_ARRAYSIZE(speedNames));
+                ImGui::SameLine();
+                if (ImGui::Button("Replay")) {
+                    g_replaySpeed = speeds[speedIndex];
+                    StartReplay();
+                }
+                if (g_replayChecked) {
+                    ImGui::SameLine();
+                    if (g_replayCheck.eventsMatch && g_replayCheck.resultMatch) {
+                        ImGui::Text("Replay reproduces the recorded game");
+                    }
+                    else if (!g_replayCheck.sameRules) {
+                        ImGui::TextDisabled("Recorded under older rules; the replay is not expected to match");
+                    }
+                    else {
+                        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Replay differs: events %s, score %s (recorded %.1f)",
+                            g_replayCheck.eventsMatch ? "match" : "differ", g_replayCheck.resultMatch ? "matches" : "differs",
+                            g_replayCheck.recorded.score);
+                    }
+                }
+            }
 
             ImGui::Spacing(); ImGui::Separator();
             ImGui::Text("'R' to restart");
@@ -700,33 +418,12 @@ void ShowResultsWindow() {
         }
 
         if (ImGui::BeginTabItem("Statistics")) {
-            const int gameCount = static_cast<int>(g_currentSettingSummaries.size());
+            const int gameCount = settingStats ? settingStats->GetGameCount() : 0;
             if (gameCount > 0) {
-                float maxScore = 0.0f;
-                float minScore = FLT_MAX;
-                float totalScore = 0.0f;
-
-                for (const auto& sum : g_currentSettingSummaries) {
-                    maxScore = std::max(maxScore, sum.score);
-                    minScore = std::min(minScore, sum.score);
-                    totalScore += sum.score;
-                }
-
-                float avgScore = totalScore / gameCount;
-
-                // Prepare data
-                static std::vector<float> xs, ys;
-                static bool statsBuffersInitialized = false;
-                if (!statsBuffersInitialized) {
-                    xs.reserve(1000);
-                    ys.reserve(1000);
-                    statsBuffersInitialized = true;
-                }
-                xs.clear(); ys.clear();
-                for (int i = 0; i < gameCount; ++i) {
-                    xs.push_back(static_cast<float>(i + 1));
-                    ys.push_back(static_cast<float>(g_currentSettingSummaries[i].score));
-                }
+                const SettingsStats& stats = *settingStats;
+                float maxScore = static_cast<float>(stats.score.moments.GetMax());
+                float minScore = static_cast<float>(stats.score.moments.GetMin());
+                float avgScore = static_cast<float>(stats.score.moments.GetMean());
 
                 float yRange = static_cast<float>(maxScore - minScore);
                 float paddingHistory = yRange * 0.1f; 
@@ -736,90 +433,68 @@ void ShowResultsWindow() {
                 float yMax = static_cast<float>(maxScore) + paddingHistory;
                 if (yMin < 0) yMin = 0;
 
+                HistoryPlotData scorePlot = { &stats.rows, false };
                 ImGui::Text("History:");
                 if (ImPlot::BeginPlot("##AllScoresLine", ImVec2(-1, 200))) {
                     ImPlot::SetupAxes("Game #", "Score");
                     ImPlot::SetupAxisLimits(ImAxis_X1, 1, gameCount, ImPlotCond_Always);
                     ImPlot::SetupAxisLimits(ImAxis_Y1, yMin, yMax, ImPlotCond_Always);
                     ImPlot::SetNextLineStyle(ImVec4(0.55f, 1.0f, 0.55f, 1.0f), 2.0f);
-                    ImPlot::PlotLine("line", xs.data(), ys.data(), gameCount);
+                    ImPlot::PlotLineG("line", GetHistoryPoint, &scorePlot, gameCount);
                     ImPlot::SetNextMarkerStyle(
                         ImPlotMarker_Circle, 3.0f,
                         ImVec4(0.55f, 1.0f, 0.55f, 1.0f),
                         0.0f,
                         ImVec4(1.0f, 0.2f, 0.2f, 1.0f)
                     );
-                    ImPlot::PlotScatter("##Points", xs.data(), ys.data(), gameCount);
+                    ImPlot::PlotScatterG("##Points", GetHistoryPoint, &scorePlot, gameCount);
                     ImPlot::EndPlot();
                 }
 
-                static bool rtBuffersInitialized = false;
-                static std::vector<float> xs_rt, ys_rt;
-                if (!rtBuffersInitialized) {
-                    xs_rt.reserve(1000);
-                    ys_rt.reserve(1000);
-                    rtBuffersInitialized = true;
-                }
-                xs_rt.clear();
-                ys_rt.clear();
-
-                float maxRT = 0.0f;
-                float minRT = FLT_MAX;
-                float totalRT = 0.0f;
-                int rtCount = 0;
-
-                float globalMinRT = FLT_MAX;
-                float globalMaxRT = 0.0f;
-
-                for (int i = 0; i < gameCount; ++i) {
-                    float rt = g_currentSettingSummaries[i].avgReactionTime;
-                    xs_rt.push_back(static_cast<float>(i + 1));
-                    ys_rt.push_back(rt);
-                    maxRT = std::max(maxRT, rt);
-                    minRT = std::min(minRT, rt);
-
-                    if (rt > 0) {
-                        totalRT += rt;
-                        rtCount++;
-                        globalMinRT = std::min(globalMinRT, rt);
-                        globalMaxRT = std::max(globalMaxRT, rt);
-                    }
-                }
-                float globalAvgRT = (rtCount > 0) ? (totalRT / rtCount) : 0.0f;
+                float maxRT = static_cast<float>(stats.reactionTimeRange.GetMax());
+                float minRT = static_cast<float>(stats.reactionTimeRange.GetMin());
+                int rtCount = static_cast<int>(stats.reactionTime.moments.GetCount());
+                float globalMinRT = static_cast<float>(stats.reactionTime.moments.GetMin());
+                float globalMaxRT = static_cast<float>(stats.reactionTime.moments.GetMax());
+                float globalAvgRT = static_cast<float>(stats.reactionTime.moments.GetMean());
                 float paddingRT = (maxRT - minRT) * 0.1f;
                 if (paddingRT < 5.0f) paddingRT = 5.0f;
 
+                HistoryPlotData reactionPlot = { &stats.rows, true };
                 ImGui::Text("Avg Reaction Time History:");
                 if (ImPlot::BeginPlot("##AvgRTLine", ImVec2(-1, 200))) {
                     ImPlot::SetupAxes("Game #", "Avg Reaction (ms)");
                     ImPlot::SetupAxisLimits(ImAxis_X1, 1, gameCount, ImPlotCond_Always);
                     ImPlot::SetupAxisLimits(ImAxis_Y1, minRT - paddingRT, maxRT + paddingRT, ImPlotCond_Always);
                     ImPlot::SetNextLineStyle(ImVec4(0.55f, 0.0f, 0.95f, 1.0f), 2.0f);
-                    ImPlot::PlotLine("line", xs_rt.data(), ys_rt.data(), gameCount);
+                    ImPlot::PlotLineG("line", GetHistoryPoint, &reactionPlot, gameCount);
                     ImPlot::SetNextMarkerStyle(
                         ImPlotMarker_Circle, 3.0f,
                         ImVec4(0.55f, 0.0f, 0.95f, 0.8f),
                         0.0f,
                         ImVec4(1.0f, 1.0f, 1.0f, 0.8f));
-                    ImPlot::PlotScatter("##scatter", xs_rt.data(), ys_rt.data(), gameCount);
+                    ImPlot::PlotScatterG("##scatter", GetHistoryPoint, &reactionPlot, gameCount);
 
                     ImPlot::EndPlot();
                 }
 
                 ImGui::Separator();
-                if (gameStartSettings.endBySpawnCount) {
+                if (lastGameResult.settings.endBySpawnCount) {
                     ImGui::Text("Min score: %.1f", minScore);
                 }
                 else {
                     ImGui::Text("Max score: %.1f", maxScore);
                 }
-                ImGui::Text("Avg score: %.1f", avgScore);
+                ImGui::Text("Avg score: %.1f (sd %.1f)", avgScore, stats.score.moments.GetStddev());
+                ImGui::Text("Recent trend: %.1f", stats.score.trend.Get());
                 ImGui::Text("Played: %d", gameCount);
                 ImGui::Separator();
                 if (rtCount > 0) {
                     ImGui::Text("Min reaction time: %.1f ms", globalMinRT);
                     ImGui::Text("Max reaction time: %.1f ms", globalMaxRT);
                     ImGui::Text("Avg reaction time: %.1f ms", globalAvgRT);
+                    const Quantiles q = stats.reactionTime.GetQuantiles();
+                    ImGui::Text("Reaction time p50 / p90 / p99: %.1f / %.1f / %.1f ms", q.p50, q.p90, q.p99);
                 }
                 else {
                     ImGui::Text("  No reaction data available");
@@ -874,13 +549,13 @@ void ShowSettingsWindow() {
             UpdateFieldCache();
 
         ImGui::Text("Circle size:");
-        if (gameState == GAME_RUNNING) ImGui::BeginDisabled();
+        if (g_session.GetState() == GAME_RUNNING) ImGui::BeginDisabled();
         float circlePercent = settings.circleRadiusNorm * 1000.0f;
         if (ImGui::DragFloat("##radius", &circlePercent, 0.1f, 1.0f, 1000.0f, "%.0f%%", ImGuiSliderFlags_AlwaysClamp)) {
             settings.circleRadiusNorm = circlePercent / 1000.0f;
             UpdateFieldCache();
         }
-        if (gameState == GAME_RUNNING) ImGui::EndDisabled();
+        if (g_session.GetState() == GAME_RUNNING) ImGui::EndDisabled();
     }
 
     if (ImGui::CollapsingHeader("Cursor", ImGuiTreeNodeFlags_DefaultOpen)) {
@@ -888,13 +563,13 @@ void ShowSettingsWindow() {
         ImGui::Checkbox("Use custom cursor", &settings.useCustomCursor);
         if (prevUseCustom != settings.useCustomCursor) ForceCursorUpdate();
 
-        if (gameState == GAME_RUNNING) ImGui::BeginDisabled();
+        if (g_session.GetState() == GAME_RUNNING) ImGui::BeginDisabled();
         float cursorPercent = settings.cursorRadiusNorm * 100.0f;
         if (ImGui::DragFloat("Cursor hitbox size (%)", &cursorPercent, 0.5f, 0.0f, 100.0f, "%.1f%%", ImGuiSliderFlags_AlwaysClamp)) {
             settings.cursorRadiusNorm = cursorPercent / 100.0f;
             UpdateFieldCache();
         }
-        if (gameState == GAME_RUNNING) ImGui::EndDisabled();
+        if (g_session.GetState() == GAME_RUNNING) ImGui::EndDisabled();
 
         ImGui::ColorEdit3("Cursor color", (float*)&settings.cursorColor);
         ImGui::ColorEdit3("Cursor outline", (float*)&settings.cursorOutlineColor);
@@ -907,14 +582,63 @@ void ShowSettingsWindow() {
         ImGui::Checkbox("DisableFiltering", &DisableFiltering);
     }
 
+    if (ImGui::CollapsingHeader("Frame pacing", ImGuiTreeNodeFlags_DefaultOpen)) {
+        const char* preview = GetFramePacingName(settings.framePacing);
+        if (ImGui::BeginCombo("Mode##pacing", preview)) {
+            for (int i = 0; i < PACING_COUNT; ++i) {
+                if (ImGui::Selectable(GetFramePacingName(i), settings.framePacing == i)) settings.framePacing = i;
+            }
+            ImGui::EndCombo();
+        }
+        if (settings.framePacing == PACING_CAPPED) {
+            ImGui::DragInt("Cap##pacing", &settings.frameCapFps, 1.0f, 10, 2000, "%d fps", ImGuiSliderFlags_AlwaysClamp);
+        }
+        ImGui::Checkbox("Late input latch (apply input again right before drawing)", &settings.lateInputLatch);
+
+        // Measured over the frames still in the ring, for every mode used recently
+        UpdateFrameSummaries();
+        // The cursor shows the newest report, so its age is the latency that matters
+        if (ImGui::BeginTable("pacing", 6, ImGuiTableFlags_SizingFixedFit)) {
+            ImGui::TableSetupColumn("mode");
+            ImGui::TableSetupColumn("latch");
+            ImGui::TableSetupColumn("frame p50");
+            ImGui::TableSetupColumn("frame p99");
+            ImGui::TableSetupColumn("input>present p50/p99");
+            ImGui::TableSetupColumn("input>display p50/p99");
+            ImGui::TableHeadersRow();
+            for (int i = 0; i < PACING_COUNT; ++i) {
+                for (int latched = 0; latched < 2; ++latched) {
+                    const FrameStatsSummary& s = g_pacingSummaries[i][latched];
+                    if (s.frame.count == 0) continue;
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn(); ImGui::TextUnformatted(GetFramePacingName(i));
+                    ImGui::TableNextColumn(); ImGui::TextUnformatted(latched ? "on" : "off");
+                    ImGui::TableNextColumn(); ImGui::Text("%.3f ms", s.frame.p50);
+                    ImGui::TableNextColumn(); ImGui::Text("%.3f ms", s.frame.p99);
+                    ImGui::TableNextColumn(); ImGui::Text("%.2f / %.2f ms", s.newestToPresent.p50, s.newestToPresent.p99);
+                    ImGui::TableNextColumn();
+                    if (s.newestToDisplay.count > 0) ImGui::Text("%.2f / %.2f ms", s.newestToDisplay.p50, s.newestToDisplay.p99);
+                    else ImGui::TextUnformatted("-");
+                }
+            }
+            ImGui::EndTable();
+        }
+    }
+
+    if (ImGui::CollapsingHeader("Recording", ImGuiTreeNodeFlags_DefaultOpen)) {
+        if (g_session.GetState() == GAME_RUNNING) ImGui::BeginDisabled();
+        ImGui::Checkbox("Save a trace of every game to res/traces", &settings.recordTraces);
+        if (g_session.GetState() == GAME_RUNNING) ImGui::EndDisabled();
+    }
+
     if (ImGui::CollapsingHeader("Time", ImGuiTreeNodeFlags_DefaultOpen)) {
         ImGui::Text("Circle lifetime (ms):");
-        if (gameState == GAME_RUNNING) ImGui::BeginDisabled();
+        if (g_session.GetState() == GAME_RUNNING) ImGui::BeginDisabled();
         ImGui::DragInt("##lifetime", &settings.circleLifetimeMs, 10.0f, 50, 2000, "%d ms", ImGuiSliderFlags_AlwaysClamp);
-        if (gameState == GAME_RUNNING) ImGui::EndDisabled();
+        if (g_session.GetState() == GAME_RUNNING) ImGui::EndDisabled();
 
         if (ImGui::CollapsingHeader("End Condition", ImGuiTreeNodeFlags_DefaultOpen)) {
-            if (gameState == GAME_RUNNING) ImGui::BeginDisabled();
+            if (g_session.GetState() == GAME_RUNNING) ImGui::BeginDisabled();
             if (ImGui::RadioButton("By Time", !settings.endBySpawnCount)) {
                 settings.endBySpawnCount = false;
             }
@@ -928,126 +652,28 @@ void ShowSettingsWindow() {
             else {
                 ImGui::DragInt("Max spawns", &settings.maxSpawnCount, 1, 1, 1000, "%d spawns");
             }
-            if (gameState == GAME_RUNNING) ImGui::EndDisabled();
+            if (g_session.GetState() == GAME_RUNNING) ImGui::EndDisabled();
         }
 
         // Added spawn delay settings
         ImGui::Text("Spawn Delay (ms):");
-        if (gameState == GAME_RUNNING) ImGui::BeginDisabled();
+        if (g_session.GetState() == GAME_RUNNING) ImGui::BeginDisabled();
         ImGui::DragInt("Min##spawn", &settings.minSpawnDelayMs, 10.0f, 0, 5000, "Min: %d ms", ImGuiSliderFlags_AlwaysClamp);
         ImGui::DragInt("Max##spawn", &settings.maxSpawnDelayMs, 10.0f, 0, 5000, "Max: %d ms", ImGuiSliderFlags_AlwaysClamp);
-        if (gameState == GAME_RUNNING) ImGui::EndDisabled();
+        if (g_session.GetState() == GAME_RUNNING) ImGui::EndDisabled();
     }
 
     if (ImGui::CollapsingHeader("Presets", ImGuiTreeNodeFlags_DefaultOpen)) {
-        if (gameState == GAME_RUNNING) ImGui::BeginDisabled();
-
-        if (ImGui::Button("BB250ms", buttonSize)) {
-            settings.circleRadiusNorm = 0.112f;
-            settings.circleLifetimeMs = 250;
-            settings.cursorRadiusNorm = 0.015f;
-            settings.gameTimeSec = 60;
-            settings.endBySpawnCount = false;
-            settings.maxSpawnCount = 10;
-            settings.minSpawnDelayMs = 0;
-            settings.maxSpawnDelayMs = 0;
-            UpdateFieldCache();
-        }
-        ImGui::SameLine();
-        if (ImGui::Button("randBB250ms", buttonSize)) {
-            settings.circleRadiusNorm = 0.112f;
-            settings.circleLifetimeMs = 250;
-            settings.cursorRadiusNorm = 0.015f;
-            settings.gameTimeSec = 60;
-            settings.endBySpawnCount = true;
-            settings.maxSpawnCount = 60;
-            settings.minSpawnDelayMs = 0;
-            settings.maxSpawnDelayMs = 1200;
-            UpdateFieldCache();
-        }
-        ImGui::SameLine();
-        if (ImGui::Button("RTDA225ms", buttonSize)) {
-            settings.circleRadiusNorm = 0.112f;
-            settings.circleLifetimeMs = 225;
-            settings.cursorRadiusNorm = 0.015f;
-            settings.gameTimeSec = 60;
-            settings.endBySpawnCount = true;
-            settings.maxSpawnCount = 80;
-            settings.minSpawnDelayMs = 200;
-            settings.maxSpawnDelayMs = 500;
-            UpdateFieldCache();
-        }
-        if (ImGui::Button("BB230ms", buttonSize)) {
-            settings.circleRadiusNorm = 0.120f;
-            settings.circleLifetimeMs = 230;
-            settings.cursorRadiusNorm = 0.015f;
-            settings.gameTimeSec = 30;
-            settings.endBySpawnCount = false;
-            settings.maxSpawnCount = 10;
-            settings.minSpawnDelayMs = 0;
-            settings.maxSpawnDelayMs = 0;
-            UpdateFieldCache();
-        }
-        ImGui::SameLine();
-        if (ImGui::Button("TDA200ms", buttonSize)) {
-            settings.circleRadiusNorm = 0.120f;
-            settings.circleLifetimeMs = 200;
-            settings.cursorRadiusNorm = 0.015f;
-            settings.gameTimeSec = 60;
-            settings.endBySpawnCount = false;
-            settings.maxSpawnCount = 10;
-            settings.minSpawnDelayMs = 500;
-            settings.maxSpawnDelayMs = 500;
-            UpdateFieldCache();
-        }
-        ImGui::SameLine();
-        if (ImGui::Button("PRflick", buttonSize)) {
-            settings.circleRadiusNorm = 0.125f;
-            settings.circleLifetimeMs = 2000;
-            settings.cursorRadiusNorm = 0.015f;
-            settings.gameTimeSec = 60;
-            settings.endBySpawnCount = true;
-            settings.maxSpawnCount = 10;
-            settings.minSpawnDelayMs = 500;
-            settings.maxSpawnDelayMs = 3000;
-            UpdateFieldCache();
-        }
-        if (ImGui::Button("SB270ms", buttonSize)) {
-            settings.circleRadiusNorm = 0.065f;
-            settings.circleLifetimeMs = 270;
-            settings.cursorRadiusNorm = 0.015f;
-            settings.gameTimeSec = 60;
-            settings.endBySpawnCount = false;
-            settings.maxSpawnCount = 10;
-            settings.minSpawnDelayMs = 0;
-            settings.maxSpawnDelayMs = 0;
-            UpdateFieldCache();
-        }
-        ImGui::SameLine();
-        if (ImGui::Button("1w1t500ms", buttonSize)) {
-            settings.circleRadiusNorm = 0.035f;
-            settings.circleLifetimeMs = 500;
-            settings.cursorRadiusNorm = 0.015f;
-            settings.gameTimeSec = 60;
-            settings.endBySpawnCount = false;
-            settings.maxSpawnCount = 10;
-            settings.minSpawnDelayMs = 0;
-            settings.maxSpawnDelayMs = 0;
-            UpdateFieldCache();
-        }
-        ImGui::SameLine();
-        if (ImGui::Button("randSB270ms", buttonSize)) {
-            settings.circleRadiusNorm = 0.065f;
-            settings.circleLifetimeMs = 270;
-            settings.cursorRadiusNorm = 0.015f;
-            settings.gameTimeSec = 60;
-            settings.endBySpawnCount = true;
-            settings.maxSpawnCount = 60;
-            settings.minSpawnDelayMs = 0;
-            settings.maxSpawnDelayMs = 1200;
-            UpdateFieldCache();
+        if (g_session.GetState() == GAME_RUNNING) ImGui::BeginDisabled();
+
+        for (int i = 0; i < g_presetCount; ++i) {
+            if (i % 3 != 0) ImGui::SameLine();
+            if (ImGui::Button(g_presets[i].name, buttonSize)) {
+                ApplyPreset(settings, g_presets[i]);
+                UpdateFieldCache();
+            }
         }
-        if (gameState == GAME_RUNNING) ImGui::EndDisabled();
+        if (g_session.GetState() == GAME_RUNNING) ImGui::EndDisabled();
     }
 
     ImGui::Spacing(); ImGui::Separator(); ImGui::Spacing();
@@ -1055,19 +681,103 @@ void ShowSettingsWindow() {
     ImGui::Text("FPS: %.1f", io.Framerate);
     ImGui::SameLine();
     ImGui::Text("frame time: %.3f ms", 1000.0f / io.Framerate);
+    if (ImGui::Button("Dump frame times (CSV)")) DumpFrameTimes(false);
+    ImGui::SameLine();
+    if (ImGui::Button("Dump frame times (binary)")) DumpFrameTimes(true);
     ImGui::Spacing(); ImGui::Separator(); ImGui::Spacing();
 
-    if (gameState == GAME_RUNNING) ImGui::BeginDisabled();
+    if (g_session.GetState() == GAME_RUNNING) ImGui::BeginDisabled();
     if (ImGui::Button("Reset config")) {
         settings = GameSettings();
         UpdateFieldCache();
     }
-    if (gameState == GAME_RUNNING) ImGui::EndDisabled();
+    if (g_session.GetState() == GAME_RUNNING) ImGui::EndDisabled();
 
     ImGui::Spacing(); ImGui::Separator(); ImGui::Spacing();
     ImGui::Text("'M' - settings");
     ImGui::SameLine();
     ImGui::Text("'R' - restart");
+    ImGui::SameLine();
+    ImGui::Text("'F' - frame stats");
+    ImGui::End();
+}
+
+// Passive overlay: stage percentiles and the frame time histogram, refreshed twice a second
+static void UpdateFrameSummaries() {
+    static std::vector<FrameTiming> frames;
+    static long long lastUpdateUs = 0;
+
+    const long long nowUs = NowUs();
+    if (nowUs - lastUpdateUs < 500000) return;
+    lastUpdateUs = nowUs;
+
+    frames.clear();
+    g_frameStats.Snapshot(frames);
+    g_frameSummary = SummarizeFrames(frames);
+    for (int i = 0; i < PACING_COUNT; ++i) {
+        for (int latched = 0; latched < 2; ++latched) g_pacingSummaries[i][latched] = SummarizeFrames(frames, i, latched);
+    }
+}
+
+void ShowFrameStatsOverlay() {
+    static double binCenters[FrameStatsSummary::kHistogramBins];
+    static double binCounts[FrameStatsSummary::kHistogramBins];
+
+    UpdateFrameSummaries();
+    const FrameStatsSummary& summary = g_frameSummary;
+    for (int i = 0; i < FrameStatsSummary::kHistogramBins; ++i) {
+        binCenters[i] = (i + 0.5) * FrameStatsSummary::kHistogramBinMs;
+        binCounts[i] = summary.histogram[i];
+    }
+
+    ImGui::SetNextWindowPos(ImVec2(10.0f, 10.0f), ImGuiCond_Always);
+    ImGui::SetNextWindowBgAlpha(0.75f);
+    ImGui::Begin("Frame stats", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize |
+        ImGuiWindowFlags_NoInputs | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav);
+
+    ImGui::Text("%s, %d frames over %.1f s", GetFramePacingName(settings.framePacing), summary.frame.count, summary.seconds);
+    if (ImGui::BeginTable("stages", 6, ImGuiTableFlags_SizingFixedFit)) {
+        const char* headers[] = { "ms", "mean", "p50", "p99", "p99.9", "max" };
+        for (const char* h : headers) ImGui::TableSetupColumn(h);
+        ImGui::TableHeadersRow();
+
+        auto row = [](const char* name, const StageStats& s) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(name);
+            if (s.count == 0) {
+                ImGui::TableNextColumn(); ImGui::TextUnformatted("-");
+                return;
+            }
+            const double values[] = { s.mean, s.p50, s.p99, s.p999, s.max };
+            for (double v : values) {
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", v);
+            }
+        };
+        row("frame", summary.frame);
+        row("wait", summary.wait);
+        row("pump", summary.pump);
+        row("sim", summary.sim);
+        row("ui", summary.ui);
+        row("latch", summary.latch);
+        row("submit", summary.submit);
+        row("present", summary.present);
+        row("input>present", summary.inputToPresent);
+        row("input>display", summary.inputToDisplay);
+        row("newest>present", summary.newestToPresent);
+        row("newest>display", summary.newestToDisplay);
+        row("event>present", summary.eventToPresent);
+        row("event>display", summary.eventToDisplay);
+        ImGui::EndTable();
+    }
+
+    if (ImPlot::BeginPlot("##frametimes", ImVec2(360, 140), ImPlotFlags_NoLegend | ImPlotFlags_NoMouseText)) {
+        ImPlot::SetupAxes("frame time, ms", nullptr, 0, ImPlotAxisFlags_AutoFit);
+        ImPlot::SetupAxisLimits(ImAxis_X1, 0.0, FrameStatsSummary::kHistogramBins * FrameStatsSummary::kHistogramBinMs, ImPlotCond_Always);
+        ImPlot::PlotBars("frames", binCenters, binCounts, FrameStatsSummary::kHistogramBins,
+            FrameStatsSummary::kHistogramBinMs);
+        ImPlot::EndPlot();
+    }
     ImGui::End();
 }
 
@@ -1114,6 +824,130 @@ float GetMouseSpeedMultiplier(int mouseSpeed) {
     return y0 + t * (y1 - y0);
 }
 
+// Session time never runs backwards: a report stamped just before the last
+// tick but drained after it is applied at the tick time
+static long long g_sessionTimeUs = 0;
+
+static void StartReplay() {
+    if (!g_lastTrace || !g_replay.Load(*g_lastTrace)) return;
+    g_replay.Begin(g_session, settings);
+    g_replayWallStartUs = NowUs();
+    g_replayChecked = false;
+    showResults = false;
+}
+
+// Advances the replay by the wall time since it started; shows the results once it ends
+static void AdvanceReplay() {
+    const long long elapsedUs = static_cast<long long>((NowUs() - g_replayWallStartUs) * static_cast<double>(g_replaySpeed));
+    if (!g_replay.AdvanceTo(g_replay.GetStartTimeUs() + elapsedUs)) return;
+
+    g_replay.End();
+    lastGameResult = g_replay.GetResult();
+    g_replayCheck = g_replay.Check();
+    g_replayChecked = true;
+    showResults = true;
+}
+
+// Writes the frames in the ring to res/frames_<time>.csv or .bin
+static void DumpFrameTimes(bool binary) {
+    std::vector<FrameTiming> frames;
+    g_frameStats.Snapshot(frames);
+    char path[64];
+    snprintf(path, sizeof(path), "res/frames_%lld.%s", static_cast<long long>(std::time(nullptr)), binary ? "bin" : "csv");
+    if (binary) WriteFrameTimesBinary(frames, path);
+    else WriteFrameTimesCsv(frames, path);
+}
+
+// Gives a pending trace to the writer and moves recording to the other
+// buffer. Without wait it stays pending while the writer is busy; callers
+// about to reset or start a game wait, so no trace is recorded over.
+static void HandOverTrace(bool wait) {
+    if (!g_tracePending) return;
+    if (wait) g_historyWriter.WaitForTrace();
+    if (g_historyWriter.PushTrace(*g_sessionTrace, g_pendingTracePath)) {
+        // The writer is done with the other buffer once it takes this one
+        g_sessionTrace = (g_sessionTrace == &g_sessionTraces[0]) ? &g_sessionTraces[1] : &g_sessionTraces[0];
+        g_session.SetTrace(settings.recordTraces ? g_sessionTrace : nullptr);
+    }
+    else if (g_historyWriter.IsRunning()) {
+        return;
+    }
+    g_tracePending = false;
+}
+
+// Advances the game and records it when it ends
+static void TickSession(long long nowUs) {
+    g_sessionTimeUs = std::max(g_sessionTimeUs, nowUs);
+    if (!g_session.Tick(g_sessionTimeUs)) return;
+
+    // Copy-assigned into the capacity reserved at the start click
+    lastGameResult = g_session.GetResult();
+    g_lastGameQueued = true;
+    if (!g_session.WasForceFinished()) {
+        GameSummary summary = MakeGameSummary(lastGameResult, std::time(nullptr));
+        g_lastGameQueued = g_historyWriter.Push(summary);
+        g_historyColumns.Append(summary);
+        g_historyIndex.Add(g_historyColumns, g_historyColumns.GetCount() - 1);
+    }
+    g_replayChecked = false;
+    // Only a trace begun with this very game can be replayed against it;
+    // with tracing off the buffer still holds an earlier game
+    const TraceHeader& traced = g_sessionTrace->GetHeader();
+    const bool recorded = traced.seed == lastGameResult.seed && traced.startTimeUs == g_session.GetGameStartTimeUs();
+    g_lastTrace = recorded ? g_sessionTrace : nullptr;
+    if (recorded && settings.recordTraces) {
+        snprintf(g_pendingTracePath, sizeof(g_pendingTracePath), "res/traces/%lld_%016llx.flkt",
+            static_cast<long long>(std::time(nullptr)), static_cast<unsigned long long>(lastGameResult.seed));
+        g_tracePending = true;
+        HandOverTrace(false);
+    }
+    showResults = true;
+}
+
+static void ClickSession(float x, float y, long long timeUs) {
+    TickSession(timeUs);
+    // The click may start the next game, which records into g_sessionTrace
+    if (g_session.GetState() != GAME_RUNNING) HandOverTrace(true);
+    FlicksSession::ClickResult click = g_session.Click(x, y, g_sessionTimeUs);
+
+    if (click == FlicksSession::CLICK_STARTED) {
+        showResults = false;
+        // Room for this game in the history views, so the frame that ends
+        // it does not allocate; its first target is a spawn delay away
+        g_historyColumns.Reserve(1);
+        g_historyIndex.Reserve(MakeSettingsKey(settings));
+        // Copying the result into lastGameResult then reuses this room
+        const GameResult& running = g_session.GetResult();
+        lastGameResult.scoreHistory.reserve(running.scoreHistory.capacity());
+        lastGameResult.reactionTimesUs.reserve(running.reactionTimesUs.capacity());
+    }
+    else if (click == FlicksSession::CLICK_HIT) {
+        PlayHitSound();
+    }
+}
+
+// Drains the raw reports queued so far: moves the cursor and applies clicks
+// unless apply is false
+static void ApplyQueuedInput(bool apply, FrameTiming& frame) {
+    const double speedFactor = static_cast<double>(g_mouseSpeedMultiplier);
+    g_inputRing.Drain([&](const InputEvent& e) {
+        if (!apply) return;
+        if (frame.inputUs == 0) frame.inputUs = e.timeUs;
+        frame.newestInputUs = e.timeUs;
+        g_sessionTrace->RecordMove(e.dx, e.dy, e.timeUs);
+
+        g_cursorPosX += static_cast<double>(e.dx) * speedFactor;
+        g_cursorPosY += static_cast<double>(e.dy) * speedFactor;
+
+        g_cursorPosX = std::clamp(g_cursorPosX, 0.0, static_cast<double>(g_WindowWidth));
+        g_cursorPosY = std::clamp(g_cursorPosY, 0.0, static_cast<double>(g_WindowHeight));
+
+        if (e.leftDown) {
+            ClickSession(static_cast<float>(g_cursorPosX), static_cast<float>(g_cursorPosY), e.timeUs);
+        }
+    });
+}
+
 extern LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
     if (ImGui_ImplWin32_WndProcHandler(hWnd, msg, wParam, lParam)) return true;
@@ -1137,38 +971,6 @@ LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
         }
         return 0;
 
-    case WM_INPUT: {
-        UINT dwSize = 0;
-        // Get the required buffer size
-        if (GetRawInputData((HRAWINPUT)lParam, RID_INPUT, nullptr, &dwSize, sizeof(RAWINPUTHEADER)) == static_cast<UINT>(-1)) {
-            return 0;
-        }
-        if (dwSize == 0) return 0;
-
-        // Using static buffer
-        static constexpr UINT BUFFER_SIZE = 128;
-        if (dwSize > BUFFER_SIZE) {
-            return 0;
-        }
-
-        static BYTE buffer[BUFFER_SIZE];
-        if (GetRawInputData((HRAWINPUT)lParam, RID_INPUT, buffer, &dwSize, sizeof(RAWINPUTHEADER)) != dwSize) {
-            return 0; 
-        }
-
-        RAWINPUT* raw = reinterpret_cast<RAWINPUT*>(buffer);
-        if (raw->header.dwType == RIM_TYPEMOUSE) {
-            g_accumulatedMouseDeltaX += raw->data.mouse.lLastX;
-            g_accumulatedMouseDeltaY += raw->data.mouse.lLastY;
-
-            // Button handling
-            if (raw->data.mouse.usButtonFlags & RI_MOUSE_BUTTON_1_DOWN) {
-                g_leftButtonPressedRaw = true;
-            }
-        }
-        return 0;
-    }
-
     case WM_SETCURSOR:
         if (LOWORD(lParam) == HTCLIENT) {
             UpdateCursor();
@@ -1207,84 +1009,149 @@ int WINAPI wWinMain(
     _In_ LPWSTR lpCmdLine,
     _In_ int nShowCmd
 ) {
-    srand((unsigned)time(NULL));
-    ResetGame();
-    LoadColorSettings();
     DEVMODE dm = getCurrentDisplayMode();
     if (dm.dmPelsWidth > 0 && dm.dmPelsHeight > 0) {
         g_WindowWidth = dm.dmPelsWidth;
         g_WindowHeight = dm.dmPelsHeight;
     }
     int refreshRate = (dm.dmDisplayFrequency > 0) ? dm.dmDisplayFrequency : 60;
-
     WNDCLASSEX wc = { sizeof(WNDCLASSEX), CS_CLASSDC, WndProc, 0, 0, hInstance, NULL, NULL, NULL, NULL, _T("CircleGameClass"), NULL };
-    RegisterClassEx(&wc);
-    g_hWnd = CreateWindowEx(
-        0,
-        wc.lpszClassName,
-        _T("Flicks"),
-        WS_POPUP,
-        0, 0, g_WindowWidth, g_WindowHeight,
-        NULL, NULL, hInstance, NULL
-    );
 
-    if (g_hWnd == NULL) return 1;
-
-    POINT initialPos;
-    GetCursorPos(&initialPos);
-    ScreenToClient(g_hWnd, &initialPos);
-    g_cursorPosX = static_cast<double>(initialPos.x);
-    g_cursorPosY = static_cast<double>(initialPos.y);
-
-    // Raw Input
-    RAWINPUTDEVICE rid[1];
-    rid[0].usUsagePage = 0x01;
-    rid[0].usUsage = 0x02;
-    rid[0].dwFlags = RIDEV_INPUTSINK;
-    rid[0].hwndTarget = g_hWnd;
-    if (!RegisterRawInputDevices(rid, 1, sizeof(rid[0]))) {
-        MessageBox(NULL, L"Failed to register raw input devices", L"Error", MB_OK);
+    // Independent stages run side by side; the window, the device and ImGui
+    // stay on this thread, which owns the window's messages. The window waits
+    // for the settings because its WndProc already reads them.
+    StartupGraph startup;
+    const int settingsStage = startup.Add("settings", [] {
+        LoadColorSettings(settings);
+        return true;
+    });
+    const int windowStage = startup.Add("window", [&] {
+        RegisterClassEx(&wc);
+        g_hWnd = CreateWindowEx(
+            0,
+            wc.lpszClassName,
+            _T("Flicks"),
+            WS_POPUP,
+            0, 0, g_WindowWidth, g_WindowHeight,
+            NULL, NULL, hInstance, NULL
+        );
+        if (g_hWnd == NULL) return false;
+
+        POINT initialPos;
+        GetCursorPos(&initialPos);
+        ScreenToClient(g_hWnd, &initialPos);
+        g_cursorPosX = static_cast<double>(initialPos.x);
+        g_cursorPosY = static_cast<double>(initialPos.y);
+
+        ShowWindow(g_hWnd, SW_SHOWDEFAULT);
+        UpdateWindow(g_hWnd);
+        return true;
+    }, { settingsStage }, true);
+    bool rawInputStarted = false;
+    startup.Add("input", [&] {
+        // Raw Input
+        rawInputStarted = g_inputThread.Start(g_inputRing);
+
+        // Get OS sens
+        SystemParametersInfo(SPI_GETMOUSESPEED, 0, &g_mouseSpeed, 0);
+        g_mouseSpeedMultiplier = GetMouseSpeedMultiplier(g_mouseSpeed);
+        for (SessionTrace& trace : g_sessionTraces) trace.SetMouseScale(g_mouseSpeedMultiplier);
+        return true;
+    });
+    const int shaderStage = startup.Add("shaders", [] { return g_renderer.LoadShaders(); });
+    const int deviceStage = startup.Add("device", [&] {
+        if (!g_renderer.CreateDevice(g_hWnd, g_WindowWidth, g_WindowHeight, refreshRate)) return false;
+        g_renderer.SetMaxFrameLatency(settings.frameLatency);
+        g_framePacer.SetRefreshPeriodUs(1000000 / refreshRate);
+        return true;
+    }, { windowStage, settingsStage }, true);
+    const int graphicsStage = startup.Add("graphics", [] { return g_renderer.CreateGraphics(); }, { deviceStage, shaderStage }, true);
+    const int imguiStage = startup.Add("imgui", [] {
+        IMGUI_CHECKVERSION();
+        ImGui::CreateContext();
+        ImPlot::CreateContext();
+        ImGuiIO& io = ImGui::GetIO();
+        io.ConfigFlags |= ImGuiConfigFlags_NoMouseCursorChange;
+        ImGui::StyleColorsDark();
+        ImguiTheme();
+        return ImGui_ImplWin32_Init(g_hWnd);
+    }, { windowStage }, true);
+    const int imguiDx11Stage = startup.Add("imgui dx11", [] {
+        return ImGui_ImplDX11_Init(
+            g_renderer.GetDevice(),
+            g_renderer.GetDeviceContext()
+        );
+    }, { imguiStage, deviceStage }, true);
+    const int audioStage = startup.Add("audio device", [] { return InitXAudio2(); });
+    const int soundStage = startup.Add("hit sound", [] { return LoadHitSound(); });
+    startup.Add("audio mixer", [] { return StartAudioMixer(); }, { audioStage, soundStage });
+    startup.Add("history", [] {
+        CreateDirectory(L"res", NULL);
+        CreateDirectory(L"res\\traces", NULL);
+        // Without a log the game still runs; the results window says nothing is saved
+        const bool started = g_historyWriter.Start();
+        g_historyLoaded = g_historyColumns.Open();
+        g_historyIndex.Build(g_historyColumns);
+        return started;
+    });
+    startup.Add("session", [] {
+        UpdateFieldCache();
+        g_session.Configure(settings, g_fieldCache);
+        g_session.Reset();
+        return true;
+    }, { settingsStage, deviceStage }, true);
+
+    startup.Run(static_cast<int>(std::max(2u, std::thread::hardware_concurrency()) - 1));
+    const std::string startupReport = startup.FormatReport();
+    OutputDebugStringA(startupReport.c_str());
+    FILE* reportFile;
+    if (fopen_s(&reportFile, "res/startup.txt", "w") == 0) {
+        fputs(startupReport.c_str(), reportFile);
+        fclose(reportFile);
     }
 
-    // Get OS sens
-    SystemParametersInfo(SPI_GETMOUSESPEED, 0, &g_mouseSpeed, 0);
-    g_mouseSpeedMultiplier = GetMouseSpeedMultiplier(g_mouseSpeed);
-
-    ShowWindow(g_hWnd, SW_SHOWDEFAULT);
-    UpdateWindow(g_hWnd);
-
-    if (!g_renderer.Initialize(g_hWnd, g_WindowWidth, g_WindowHeight, refreshRate)) {
+    // Undoes whatever startup brought up, on the normal exit and when a start
+    // fails alike; above all the audio thread must stop calling into the
+    // mixer before static destruction
+    auto teardown = [&] {
+        HandOverTrace(true);
+        g_historyWriter.Stop();
+        g_historyColumns.Close();
+        g_inputThread.Stop();
+        CleanupXAudio2();
+        if (startup.Succeeded(imguiDx11Stage)) ImGui_ImplDX11_Shutdown();
+        if (startup.Succeeded(imguiStage)) ImGui_ImplWin32_Shutdown();
+        if (ImPlot::GetCurrentContext()) ImPlot::DestroyContext();
+        if (ImGui::GetCurrentContext()) ImGui::DestroyContext();
+        g_renderer.Cleanup();
         UnregisterClass(wc.lpszClassName, hInstance);
+    };
+
+    if (!startup.Succeeded(windowStage) || !startup.Succeeded(graphicsStage)) {
+        if (g_hWnd) DestroyWindow(g_hWnd);
+        teardown();
         return 1;
     }
-
-    g_renderer.SetMaxFrameLatency(settings.frameLatency);
-
-    IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
-    ImPlot::CreateContext();
-    ImGuiIO& io = ImGui::GetIO();
-    io.ConfigFlags |= ImGuiConfigFlags_NoMouseCursorChange;
-    ImGui::StyleColorsDark();
-    ImguiTheme();
-    ImGui_ImplWin32_Init(g_hWnd);
-    ImGui_ImplDX11_Init(
-        g_renderer.GetDevice(),
-        g_renderer.GetDeviceContext()
-    );
-
-    InitXAudio2();
-    CreateDirectory(L"res", NULL);
-    LoadGameSummaries();
-    UpdateFieldCache();
+    if (!rawInputStarted) {
+        MessageBox(NULL, L"Failed to register raw input devices", L"Error", MB_OK);
+    }
 
     bool done = false;
     bool prevShowAny = false;
-    bool isLastCircle = false;
     bool prevWantCaptureMouse = true;
-    bool forceFinish = false;
 
     while (!done) {
+        // Pacing: the swap chain's latency wait, then whatever delay the mode adds
+        g_framePacer.SetMode(settings.framePacing);
+        g_framePacer.SetCapFps(settings.frameCapFps);
+        const bool swapChainPaced = PacingUsesSwapChain(g_framePacer.GetMode());
+        g_renderer.SetVsync(swapChainPaced);
+
+        FrameTiming& frame = g_frameStats.BeginFrame(NowUs());
+        frame.pacing = static_cast<uint32_t>(g_framePacer.GetMode());
+        if (swapChainPaced) g_renderer.WaitForFrameLatencyObject();
+        frame.waitEndUs = g_framePacer.Wait();
+
         MSG msg;
         while (PeekMessage(&msg, NULL, 0U, 0U, PM_REMOVE)) {
             TranslateMessage(&msg);
@@ -1292,11 +1159,7 @@ int WINAPI wWinMain(
             if (msg.message == WM_QUIT) done = true;
         }
         if (done) break;
-
-        const auto currentTime = std::chrono::steady_clock::now();
-        const long long currentTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-            currentTime.time_since_epoch()
-        ).count();
+        frame.pumpEndUs = NowUs();
 
         ImGui_ImplDX11_NewFrame();
         ImGui_ImplWin32_NewFrame();
@@ -1310,251 +1173,46 @@ int WINAPI wWinMain(
             ScreenToClient(g_hWnd, &pt);
             g_cursorPosX = static_cast<double>(pt.x);
             g_cursorPosY = static_cast<double>(pt.y);
-
-            g_accumulatedMouseDeltaX = 0;
-            g_accumulatedMouseDeltaY = 0;
-        }
-        else if (g_active) {
-            const double speedFactor = static_cast<double>(g_mouseSpeedMultiplier);
-            g_cursorPosX += static_cast<double>(g_accumulatedMouseDeltaX) * speedFactor;
-            g_cursorPosY += static_cast<double>(g_accumulatedMouseDeltaY) * speedFactor;
-
-            g_cursorPosX = std::clamp(g_cursorPosX, 0.0, static_cast<double>(g_WindowWidth));
-            g_cursorPosY = std::clamp(g_cursorPosY, 0.0, static_cast<double>(g_WindowHeight));
-
-            g_accumulatedMouseDeltaX = 0;
-            g_accumulatedMouseDeltaY = 0;
-        }
-
-        if (g_leftButtonPressedRaw) {
-            g_leftButtonPressed = (g_active && !io.WantCaptureMouse);
-            g_leftButtonPressedRaw = false;
         }
 
         bool prevShowSettings = showSettings;
         bool prevShowResults = showResults;
 
-        if (ImGui::IsKeyPressed(ImGuiKey_R)) {
-            ResetGame();
-            isLastCircle = false;
-            forceFinish = false;
-        }
-        if (ImGui::IsKeyPressed(ImGuiKey_M)) showSettings = !showSettings;
-        if (ImGui::IsKeyPressed(ImGuiKey_Escape)) PostQuitMessage(0);
-        if (ImGui::IsKeyPressed(ImGuiKey_E) && gameState == GAME_RUNNING) {
-            forceFinish = true;
-        }
-
-        // Handle circle spawning
-        if (gameState == GAME_RUNNING) {
-            const long long elapsedGameMs = currentTimeMs - gameStartTimeMs;
-            const int elapsedSec = static_cast<int>(elapsedGameMs / 1000);
+        const bool restart = ImGui::IsKeyPressed(ImGuiKey_R);
+        if (restart) g_replay.End();
 
-            if (elapsedSec > g_lastSampleSecond) {
-                for (int s = g_lastSampleSecond + 1; s <= elapsedSec; ++s) {
-                    g_scoreHistory.push_back(hits);
-                }
-                g_lastSampleSecond = elapsedSec;
-            }
-
-            if (!isLastCircle) {
-                if (forceFinish) {
-                    isLastCircle = true;
-                }
-                else if (gameStartSettings.endBySpawnCount && spawnCount >= gameStartSettings.maxSpawnCount) {
-                    isLastCircle = true;
-                }
-                else if (!gameStartSettings.endBySpawnCount &&
-                    elapsedGameMs >= static_cast<long long>(gameStartSettings.gameTimeSec) * 1000) {
-                    isLastCircle = true;
-                }
-            }
-
-            if (isCircleActive) {
-                const long long elapsedCircleMs = currentTimeMs - circleSpawnTimeMs;
-                if (elapsedCircleMs >= gameStartSettings.circleLifetimeMs) {
-                    isCircleActive = false;
-                    if (!isLastCircle) {
-                        int delay = randomInt(gameStartSettings.minSpawnDelayMs, gameStartSettings.maxSpawnDelayMs);
-                        nextSpawnTimeMs = currentTimeMs + delay;
-                    }
-                }
-            }
-
-            if (!isCircleActive && !isLastCircle && currentTimeMs >= nextSpawnTimeMs) {
-                SpawnCircle(g_WindowWidth, g_WindowHeight);
-                isCircleActive = true;
-                spawnCount++;
-            }
-
-            if (isLastCircle && !isCircleActive) {
-                gameState = GAME_FINISHED;
-
-                if (elapsedSec > g_lastSampleSecond) {
-                    for (int s = g_lastSampleSecond + 1; s <= elapsedSec; ++s) {
-                        g_scoreHistory.push_back(hits);
-                    }
-                    g_lastSampleSecond = elapsedSec;
-                }
-
-                lastGameResult.avgReactionTime = 0.0f;
-                if (!g_reactionTimes.empty()) {
-                    long long sum = 0;
-                    for (int rt : g_reactionTimes) sum += rt;
-                    lastGameResult.avgReactionTime = static_cast<float>(sum) / g_reactionTimes.size();
-                }
-
-                float finalScore;
-                if (gameStartSettings.endBySpawnCount) {
-                    float sqrtValue = static_cast<float>(
-                        std::sqrt(std::max(0, gameStartSettings.maxSpawnCount - hits))
-                        );
-                    finalScore = sqrtValue * 100.0f + lastGameResult.avgReactionTime;
-                }
-                else {
-                    finalScore = static_cast<float>(hits);
-                }
-
-                lastGameResult.settings = gameStartSettings;
-                lastGameResult.hits = hits;
-                lastGameResult.attempts = attempts;
-                lastGameResult.accuracy = (attempts > 0) ? (100.0f * hits / attempts) : 0.0f;
-                lastGameResult.score = finalScore;
-                lastGameResult.scoreHistory = g_scoreHistory;
-                lastGameResult.reactionTimes = g_reactionTimes;
-
-                GameSummary summary;
-                summary.circleRadiusNorm = lastGameResult.settings.circleRadiusNorm;
-                summary.cursorRadiusNorm = lastGameResult.settings.cursorRadiusNorm;
-                summary.circleLifetimeMs = lastGameResult.settings.circleLifetimeMs;
-                summary.gameTimeSec = lastGameResult.settings.gameTimeSec;
-                summary.minSpawnDelayMs = lastGameResult.settings.minSpawnDelayMs;
-                summary.maxSpawnDelayMs = lastGameResult.settings.maxSpawnDelayMs;
-                summary.endBySpawnCount = lastGameResult.settings.endBySpawnCount;
-                summary.maxSpawnCount = lastGameResult.settings.maxSpawnCount;
-                summary.hits = lastGameResult.hits;
-                summary.avgReactionTime = lastGameResult.avgReactionTime;
-                summary.score = finalScore;
-                summary.timestamp = std::time(nullptr);
-
-                if (!forceFinish) {
-                    g_allGameSummaries.push_back(summary);
-                    SaveGameSummaries();
-                }
-
-                showResults = true;
-                forceFinish = false;
-            }
+        // A replay keeps the settings and field it was recorded with
+        if (!g_replay.IsActive()) {
+            HandOverTrace(false);
+            g_session.Configure(settings, g_fieldCache);
+            g_session.SetTrace(settings.recordTraces ? g_sessionTrace : nullptr);
         }
 
-        // Mouse
-        if (g_leftButtonPressed && !io.WantCaptureMouse) {
-            g_leftButtonPressed = false;
-            ImVec2 mousePos(
-                static_cast<float>(g_cursorPosX),
-                static_cast<float>(g_cursorPosY)
-            );
-
-            if (gameState == GAME_NOT_STARTED) {
-                ImVec2 center = g_fieldCache.center;
-                float R = g_fieldCache.circleRadiusPx;
-                float Cr = g_fieldCache.cursorRadiusPx;
-                float dx = mousePos.x - center.x;
-                float dy = mousePos.y - center.y;
-                if (dx * dx + dy * dy <= (R + Cr) * (R + Cr)) {
-                    StartGame();
-                    isLastCircle = false;
-                }
-            }
-            else if (gameState == GAME_RUNNING) {
-                if (isCircleActive) {
-                    float R = g_fieldCache.circleRadiusPx;
-                    float Cr = g_fieldCache.cursorRadiusPx;
-                    float dx = mousePos.x - circlePos.x;
-                    float dy = mousePos.y - circlePos.y;
-                    float distSq = dx * dx + dy * dy;
-                    float hitRadiusSq = (R + Cr) * (R + Cr);
-
-                    if (distSq <= hitRadiusSq) {
-                        hits++;
-                        attempts++;
-                        g_lastReactionTime = static_cast<int>(currentTimeMs - circleSpawnTimeMs);
-                        g_reactionTimes.push_back(g_lastReactionTime);
-                        PlayHitSound();
-                        isCircleActive = false;
-
-                        if (!isLastCircle) {
-                            int delay = randomInt(gameStartSettings.minSpawnDelayMs, gameStartSettings.maxSpawnDelayMs);
-                            nextSpawnTimeMs = currentTimeMs + delay;
-                        }
-                    }
-                    else {
-                        attempts++;
-                    }
-                }
-                else {
-                    attempts++;
-                }
-            }
-        }
-
-        // RENDERING 
-        float clear_color[4] = {
-            settings.bgColor.x,
-            settings.bgColor.y,
-            settings.bgColor.z,
-            settings.bgColor.w
-        };
-
-        g_renderer.BeginFrame(clear_color);
-
-        g_renderer.DrawField(g_fieldCache, settings.fieldColor);
-
-        g_renderer.BeginCircleRendering();
-
-        if (gameState == GAME_NOT_STARTED) {
-            g_renderer.DrawCircle(
-                g_fieldCache.center,
-                g_fieldCache.circleRadiusPx,
-                settings.circleColor
-            );
-        }
-        else if (gameState == GAME_RUNNING && isCircleActive) {
-            g_renderer.DrawCircle(
-                circlePos,
-                g_fieldCache.circleRadiusPx,
-                settings.circleColor
-            );
+        if (restart) {
+            HandOverTrace(true);
+            g_session.Reset();
+            showResults = false;
         }
+        if (ImGui::IsKeyPressed(ImGuiKey_M)) showSettings = !showSettings;
+        if (ImGui::IsKeyPressed(ImGuiKey_F)) showFrameStats = !showFrameStats;
+        if (ImGui::IsKeyPressed(ImGuiKey_Escape)) PostQuitMessage(0);
+        if (ImGui::IsKeyPressed(ImGuiKey_E) && !g_replay.IsActive()) g_session.RequestFinish();
 
-        if (settings.useCustomCursor && !showSettings && !showResults && !io.WantCaptureMouse) {
-            ImVec2 mousePos(
-                static_cast<float>(g_cursorPosX),
-                static_cast<float>(g_cursorPosY)
-            );
-            float Cr = g_fieldCache.cursorRadiusPx;
-
-            g_renderer.DrawCircle(
-                mousePos,
-                Cr,
-                settings.cursorOutlineColor
-            );
-
-            float innerRadius = Cr - settings.cursorThickness;
-            if (innerRadius > 0.0f) {
-                g_renderer.DrawCircle(
-                    mousePos,
-                    innerRadius,
-                    settings.cursorColor,
-                    0.1f
-                );
-            }
-        }
+        // Mouse: replay the reports queued since the last frame in order, so each
+        // click is judged where the cursor was and when the button went down
+        const bool applyInput = g_active && !io.WantCaptureMouse && !g_replay.IsActive();
+        ApplyQueuedInput(applyInput, frame);
 
-        g_renderer.EndCircleRendering();
+        // Handle circle spawning
+        const bool replaying = g_replay.IsActive();
+        if (replaying) AdvanceReplay();
+        else TickSession(NowUs());
+        frame.simEndUs = NowUs();
 
+        // UI first: its draw data is only submitted after the scene
         if (showSettings) ShowSettingsWindow();
         if (showResults) ShowResultsWindow();
+        if (showFrameStats) ShowFrameStatsOverlay();
 
         bool currentShowAny = showSettings || showResults;
         if (prevShowAny != currentShowAny) {
@@ -1570,25 +1228,55 @@ int WINAPI wWinMain(
         if (prevShowSettings != showSettings) ForceCursorUpdate();
         if (prevShowResults != showResults) ForceCursorUpdate();
 
-        if (showSettings || showResults) {
-            ImGui::Render();
-            ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
-        }
-        else {
-            ImGui::EndFrame();
+        const bool drawUi = showSettings || showResults || showFrameStats;
+        if (drawUi) ImGui::Render();
+        else ImGui::EndFrame();
+        frame.uiEndUs = NowUs();
+
+        // Late latch: the reports that came in while the UI was built move the
+        // cursor and are judged before the scene is drawn
+        if (settings.lateInputLatch && applyInput) {
+            frame.latched = 1;
+            ApplyQueuedInput(true, frame);
+            TickSession(NowUs());
+            frame.latchEndUs = NowUs();
         }
 
+        // RENDERING 
+        const bool drawCursor = settings.useCustomCursor && !showSettings && !showResults && !io.WantCaptureMouse;
+        ImVec2 cursorPos(
+            static_cast<float>(g_cursorPosX),
+            static_cast<float>(g_cursorPosY)
+        );
+        if (replaying) {
+            // The recorded mouse path, on the field the game was recorded on
+            cursorPos = g_replay.GetCursorPos();
+            cursorPos.x = std::clamp(cursorPos.x, 0.0f, static_cast<float>(g_WindowWidth));
+            cursorPos.y = std::clamp(cursorPos.y, 0.0f, static_cast<float>(g_WindowHeight));
+        }
+        // Spawns and expiries run at their scheduled times; this frame is where they show
+        long long eventUs;
+        if (g_session.TakeFirstEventTime(eventUs) && !replaying) frame.eventUs = eventUs;
+        DrawScene(g_renderer, g_session, replaying ? g_replay.GetField() : g_fieldCache,
+            replaying ? g_replay.GetSettings() : settings, drawCursor ? &cursorPos : nullptr);
+        if (drawUi) ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+
+        frame.submitEndUs = NowUs();
         g_renderer.EndFrame();
+        frame.presentEndUs = NowUs();
+        frame.presentCount = g_renderer.GetLastPresentCount();
+        g_framePacer.EndFrame(frame.waitEndUs, frame.presentEndUs);
+        g_frameStats.EndFrame();
+
+        UINT displayedCount;
+        long long displayedUs;
+        if (g_renderer.GetLastDisplayed(displayedCount, displayedUs)) {
+            g_frameStats.MarkDisplayed(displayedCount, displayedUs);
+            g_framePacer.OnVblank(displayedUs);
+        }
     }
 
-    SaveColorSettings();
-    SaveGameSummaries();
-    CleanupXAudio2();
-    ImGui_ImplDX11_Shutdown();
-    ImGui_ImplWin32_Shutdown();
-    ImPlot::DestroyContext();
-    ImGui::DestroyContext();
-    g_renderer.Cleanup();
-    UnregisterClass(wc.lpszClassName, hInstance);
+    SaveColorSettings(settings);
+    teardown();
     return 0;
 }
\ No newline at end of file
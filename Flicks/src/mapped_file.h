@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+
+// Read-only view of a whole file. The mapping lives until Close() or the
+// destructor; on Windows the file cannot be replaced while it is mapped.
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { Close(); }
+
+    bool Open(const char* path);
+    void Close();
+
+    const void* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+
+private:
+    const void* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cmath>
+
+// Trig for anything a seed has to reproduce. The CRT versions of sin, cos,
+// acos and atan2 differ in the last bits between libraries; these only use
+// +, -, *, / and sqrt, which IEEE rounds the same on every platform (the
+// build turns off FMA contraction for that). Polynomials are the Cephes
+// single precision ones, good to a couple of ulp.
+namespace portable {
+    const float kPi = 3.14159265358979f;
+    const float kHalfPi = 1.57079632679490f;
+    const float kQuarterPi = 0.785398163397448f;
+
+    // Sine and cosine of t, reduced to [-pi/4, pi/4] by quadrant
+    inline void SinCos(float t, float& s, float& c) {
+        const float k = std::floor(t * (2.0f / kPi) + 0.5f);
+        // pi/2 split in three so k * part is exact for the angles games use
+        const float r = ((t - k * 1.5703125f) - k * 4.837512969970703125e-4f) - k * 7.54978995489188216e-8f;
+        const float z = r * r;
+        const float sr = r + r * z * ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f);
+        const float cr = 1.0f - 0.5f * z + z * z * ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f);
+        switch (static_cast<int>(k) & 3) {
+        case 0: s = sr; c = cr; break;
+        case 1: s = cr; c = -sr; break;
+        case 2: s = -sr; c = -cr; break;
+        default: s = -cr; c = sr; break;
+        }
+    }
+
+    // asin on [-0.5, 0.5]
+    inline float AsinSmall(float x) {
+        const float z = x * x;
+        return x + x * z * ((((4.2163199048e-2f * z + 2.4181311049e-2f) * z + 4.5470025998e-2f) * z + 7.4953002686e-2f) * z + 1.6666752422e-1f);
+    }
+
+    inline float Acos(float x) {
+        if (x >= 1.0f) return 0.0f;
+        if (x <= -1.0f) return kPi;
+        if (x > 0.5f) return 2.0f * AsinSmall(std::sqrt(0.5f * (1.0f - x)));
+        if (x < -0.5f) return kPi - 2.0f * AsinSmall(std::sqrt(0.5f * (1.0f + x)));
+        return kHalfPi - AsinSmall(x);
+    }
+
+    // atan for x >= 0
+    inline float AtanPositive(float x) {
+        float base = 0.0f;
+        if (x > 2.414213562373095f) {
+            base = kHalfPi;
+            x = -1.0f / x;
+        }
+        else if (x > 0.4142135623730950f) {
+            base = kQuarterPi;
+            x = (x - 1.0f) / (x + 1.0f);
+        }
+        const float z = x * x;
+        return base + (((8.05374449538e-2f * z - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z - 3.33329491539e-1f) * z * x + x;
+    }
+
+    // Angle of (x, y) in [-pi, pi]
+    inline float Atan2(float y, float x) {
+        const float ay = std::fabs(y), ax = std::fabs(x);
+        float a;
+        if (ax == 0.0f) a = ay == 0.0f ? 0.0f : kHalfPi;
+        else if (ay > ax) a = kHalfPi - AtanPositive(ax / ay);
+        else a = AtanPositive(ay / ax);
+        if (x < 0.0f) a = kPi - a;
+        return y < 0.0f ? -a : a;
+    }
+}
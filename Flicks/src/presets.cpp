@@ -0,0 +1,34 @@
+#include "presets.h"
+#include <cstring>
+
+const GamePreset g_presets[] = {
+    // name          radius  life   cursor  time  bySpawn  spawns  minDelay  maxDelay
+    { "BB250ms",     0.112f, 250,   0.015f, 60,   false,   10,     0,        0    },
+    { "randBB250ms", 0.112f, 250,   0.015f, 60,   true,    60,     0,        1200 },
+    { "RTDA225ms",   0.112f, 225,   0.015f, 60,   true,    80,     200,      500  },
+    { "BB230ms",     0.120f, 230,   0.015f, 30,   false,   10,     0,        0    },
+    { "TDA200ms",    0.120f, 200,   0.015f, 60,   false,   10,     500,      500  },
+    { "PRflick",     0.125f, 2000,  0.015f, 60,   true,    10,     500,      3000 },
+    { "SB270ms",     0.065f, 270,   0.015f, 60,   false,   10,     0,        0    },
+    { "1w1t500ms",   0.035f, 500,   0.015f, 60,   false,   10,     0,        0    },
+    { "randSB270ms", 0.065f, 270,   0.015f, 60,   true,    60,     0,        1200 },
+};
+const int g_presetCount = static_cast<int>(sizeof(g_presets) / sizeof(g_presets[0]));
+
+void ApplyPreset(GameSettings& settings, const GamePreset& preset) {
+    settings.circleRadiusNorm = preset.circleRadiusNorm;
+    settings.circleLifetimeMs = preset.circleLifetimeMs;
+    settings.cursorRadiusNorm = preset.cursorRadiusNorm;
+    settings.gameTimeSec = preset.gameTimeSec;
+    settings.endBySpawnCount = preset.endBySpawnCount;
+    settings.maxSpawnCount = preset.maxSpawnCount;
+    settings.minSpawnDelayMs = preset.minSpawnDelayMs;
+    settings.maxSpawnDelayMs = preset.maxSpawnDelayMs;
+}
+
+const GamePreset* FindPreset(const char* name) {
+    for (int i = 0; i < g_presetCount; ++i) {
+        if (strcmp(g_presets[i].name, name) == 0) return &g_presets[i];
+    }
+    return nullptr;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "settings.h"
+
+struct GamePreset {
+    const char* name;
+    float circleRadiusNorm;
+    int circleLifetimeMs;
+    float cursorRadiusNorm;
+    int gameTimeSec;
+    bool endBySpawnCount;
+    int maxSpawnCount;
+    int minSpawnDelayMs;
+    int maxSpawnDelayMs;
+};
+
+extern const GamePreset g_presets[];
+extern const int g_presetCount;
+
+void ApplyPreset(GameSettings& settings, const GamePreset& preset);
+const GamePreset* FindPreset(const char* name);
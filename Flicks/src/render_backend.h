@@ -0,0 +1,21 @@
+#pragma once
+
+#include <imgui.h>
+
+#include "field.h"
+
+// What the game needs from a renderer: a cleared frame, the field quad and
+// feathered circles. The D3D11 Renderer and the CPU SoftRenderer implement it.
+class RenderBackend {
+public:
+    virtual ~RenderBackend() = default;
+
+    virtual void BeginFrame(const float clearColor[4]) = 0;
+    virtual void EndFrame() = 0;
+
+    virtual void DrawField(const FieldCache& fieldCache, const ImVec4& fieldColor) = 0;
+    // Circles are queued between Begin and End and drawn in submission order
+    virtual void BeginCircleRendering() = 0;
+    virtual void DrawCircle(const ImVec2& center, float radius, const ImVec4& color, float feather = 1.0f) = 0;
+    virtual void EndCircleRendering() = 0;
+};
@@ -1,18 +1,31 @@
 ﻿#define NOMINMAX
 #include "renderer.h"
+#include "clock.h"
 #include <algorithm>
 
+// Bytecode fxc compiled from shaders/*.hlsl at build time
+#include "field_vs.h"
+#include "field_ps.h"
+#include "circle_vs.h"
+#include "circle_ps.h"
+
+#ifdef FLICKS_SHADER_CACHE
+#include <d3dcompiler.h>
+#include <string>
+#include "shader_cache.h"
+#pragma comment(lib, "d3dcompiler.lib")
+#endif
+
 Renderer::Renderer()
     : m_hWnd(nullptr), m_width(0), m_height(0),
     m_hasLastVSData(false),
-    m_hasLastPSFieldData(false),
-    m_hasLastPSCircleData(false)
+    m_hasLastPSFieldData(false)
 {
     SetThreadDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
     ZeroMemory(&m_lastVSData, sizeof(m_lastVSData));
     ZeroMemory(&m_lastPSFieldData, sizeof(m_lastPSFieldData));
-    ZeroMemory(&m_lastPSCircleData, sizeof(m_lastPSCircleData));
     m_frameLatencyWaitableObject = NULL;
+    m_circles.reserve(16);
 }
 
 Renderer::~Renderer() {
@@ -20,6 +33,10 @@ Renderer::~Renderer() {
 }
 
 bool Renderer::Initialize(HWND hWnd, int width, int height, int refreshRate) {
+    return CreateDevice(hWnd, width, height, refreshRate) && LoadShaders() && CreateGraphics();
+}
+
+bool Renderer::CreateDevice(HWND hWnd, int width, int height, int refreshRate) {
     m_hWnd = hWnd;
     m_width = width;
     m_height = height;
@@ -108,8 +125,7 @@ bool Renderer::Initialize(HWND hWnd, int width, int height, int refreshRate) {
     rsDesc.DepthClipEnable = false;
     m_pd3dDevice->CreateRasterizerState(&rsDesc, &m_pRasterizerState);
     m_pd3dDeviceContext->RSSetState(m_pRasterizerState.Get());
-
-    return InitGraphics();
+    return true;
 }
 
 void Renderer::SetMaxFrameLatency(UINT latency) {
@@ -126,14 +142,17 @@ void Renderer::Cleanup() {
     if (m_pSwapChain) m_pSwapChain->SetFullscreenState(FALSE, NULL);
     CleanupRenderTarget();
 
-    m_pConstantBufferPS_Circle.Reset();
+    m_pCircleInstanceBuffer.Reset();
+    m_circleInstanceCapacity = 0;
     m_pConstantBufferPS_Field.Reset();
     m_pConstantBufferVS.Reset();
     m_pIndexBuffer.Reset();
     m_pVertexBuffer.Reset();
+    m_pCircleLayout.Reset();
     m_pVertexLayout.Reset();
     m_pPS_Circle.Reset();
     m_pPS_Field.Reset();
+    m_pVS_Circle.Reset();
     m_pVS.Reset();
 
     m_pRasterizerState.Reset();
@@ -183,6 +202,10 @@ void Renderer::BeginFrame(const float clearColor[4]) {
 }
 
 void Renderer::EndFrame() {
+    if (m_vsync) {
+        m_pSwapChain->Present(1, 0);
+        return;
+    }
     UINT presentFlags = DXGI_PRESENT_DO_NOT_WAIT | DXGI_PRESENT_ALLOW_TEARING;
     m_pSwapChain->Present(0, presentFlags);
 }
@@ -233,169 +256,153 @@ void Renderer::DrawField(const FieldCache& fieldCache, const ImVec4& fieldColor)
 }
 
 void Renderer::BeginCircleRendering() {
-    m_pd3dDeviceContext->VSSetShader(m_pVS.Get(), nullptr, 0);
-    m_pd3dDeviceContext->PSSetShader(m_pPS_Circle.Get(), nullptr, 0);
-    m_pd3dDeviceContext->VSSetConstantBuffers(0, 1, m_pConstantBufferVS.GetAddressOf());
-    m_pd3dDeviceContext->PSSetConstantBuffers(0, 1, m_pConstantBufferPS_Circle.GetAddressOf());
+    m_circles.clear();
 }
 
 void Renderer::DrawCircle(const ImVec2& center, float radius, const ImVec4& color, float feather) {
-    // Prepare VS
-    VS_ConstantBuffer vsConst = {};
-    vsConst.scale[0] = radius * 2.0f;
-    vsConst.scale[1] = radius * 2.0f;
-    vsConst.translate[0] = center.x - radius;
-    vsConst.translate[1] = center.y - radius;
-    vsConst.windowSize[0] = (float)m_width;
-    vsConst.windowSize[1] = (float)m_height;
+    CircleInstance circle;
+    circle.center[0] = center.x;
+    circle.center[1] = center.y;
+    circle.radius = radius;
+    circle.featherWidth = feather;
+    memcpy(circle.color, &color, 4 * sizeof(float));
+    m_circles.push_back(circle);
+}
+
+void Renderer::EndCircleRendering() {
+    if (m_circles.empty()) return;
 
-    if (!m_hasLastVSData || memcmp(&vsConst, &m_lastVSData, sizeof(VS_ConstantBuffer)) != 0) {
+    const UINT count = static_cast<UINT>(m_circles.size());
+    if (!EnsureCircleInstanceCapacity(count)) {
+        m_circles.clear();
+        return;
+    }
+
+    // The circle VS only reads windowSize from the shared transform buffer
+    if (!m_hasLastVSData ||
+        m_lastVSData.windowSize[0] != (float)m_width ||
+        m_lastVSData.windowSize[1] != (float)m_height)
+    {
+        VS_ConstantBuffer vsConst = {};
+        vsConst.windowSize[0] = (float)m_width;
+        vsConst.windowSize[1] = (float)m_height;
         UpdateVSConstantBuffer(vsConst);
         m_lastVSData = vsConst;
         m_hasLastVSData = true;
     }
 
-    // Prepare PS
-    PS_Circle_ConstantBuffer psCircleConst = {};
-    memcpy(psCircleConst.color, &color, 4 * sizeof(float));
-    psCircleConst.center[0] = center.x;
-    psCircleConst.center[1] = center.y;
-    psCircleConst.radius = radius;
-    psCircleConst.featherWidth = feather;
-
-    if (!m_hasLastPSCircleData || memcmp(&psCircleConst, &m_lastPSCircleData, sizeof(PS_Circle_ConstantBuffer)) != 0) {
-        UpdatePSCircleConstantBuffer(psCircleConst);
-        m_lastPSCircleData = psCircleConst;
-        m_hasLastPSCircleData = true;
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    if (FAILED(m_pd3dDeviceContext->Map(m_pCircleInstanceBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) {
+        m_circles.clear();
+        return;
     }
+    memcpy(mapped.pData, m_circles.data(), count * sizeof(CircleInstance));
+    m_pd3dDeviceContext->Unmap(m_pCircleInstanceBuffer.Get(), 0);
 
-    m_pd3dDeviceContext->DrawIndexed(6, 0, 0);
-}
+    ID3D11Buffer* buffers[2] = { m_pVertexBuffer.Get(), m_pCircleInstanceBuffer.Get() };
+    UINT strides[2] = { sizeof(float) * 2, sizeof(CircleInstance) };
+    UINT offsets[2] = { 0, 0 };
+    m_pd3dDeviceContext->IASetVertexBuffers(0, 2, buffers, strides, offsets);
+    m_pd3dDeviceContext->IASetInputLayout(m_pCircleLayout.Get());
 
-void Renderer::EndCircleRendering() {
-    m_hasLastPSCircleData = false;
+    m_pd3dDeviceContext->VSSetShader(m_pVS_Circle.Get(), nullptr, 0);
+    m_pd3dDeviceContext->VSSetConstantBuffers(0, 1, m_pConstantBufferVS.GetAddressOf());
+    m_pd3dDeviceContext->PSSetShader(m_pPS_Circle.Get(), nullptr, 0);
+
+    // Instances are rasterized in order, so overlapping circles blend as if drawn one by one
+    m_pd3dDeviceContext->DrawIndexedInstanced(6, count, 0, 0, 0);
+
+    m_pd3dDeviceContext->IASetInputLayout(m_pVertexLayout.Get());
+    m_circles.clear();
 }
 
-void Renderer::UpdateFieldCache(FieldCache& cache, float scale, float circleRadiusNorm, float cursorRadiusNorm) {
-    float screenW = static_cast<float>(m_width);
-    float screenH = static_cast<float>(m_height);
+bool Renderer::EnsureCircleInstanceCapacity(UINT count) {
+    if (m_pCircleInstanceBuffer && count <= m_circleInstanceCapacity) return true;
 
-    if (screenW <= 0 || screenH <= 0) {
-        cache.valid = false;
-        return;
-    }
+    UINT capacity = std::max<UINT>(m_circleInstanceCapacity, 64);
+    while (capacity < count) capacity *= 2;
+
+    D3D11_BUFFER_DESC bd = {};
+    bd.Usage = D3D11_USAGE_DYNAMIC;
+    bd.ByteWidth = capacity * sizeof(CircleInstance);
+    bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 
-    float fieldSize = std::min(screenW, screenH) * scale;
-    float halfField = fieldSize * 0.5f;
-    ImVec2 fieldTL{ (screenW - fieldSize) * 0.5f, (screenH - fieldSize) * 0.5f };
-    ImVec2 fieldBR{ fieldTL.x + fieldSize, fieldTL.y + fieldSize };
-    ImVec2 center{ fieldTL.x + halfField, fieldTL.y + halfField };
-    float circleRadiusPx = circleRadiusNorm * halfField;
-    float spawnMaxRadius = std::max(0.0f, halfField - circleRadiusPx);
-
-    cache.fieldSize = fieldSize;
-    cache.halfField = halfField;
-    cache.fieldTL = fieldTL;
-    cache.fieldBR = fieldBR;
-    cache.center = center;
-    cache.circleRadiusPx = circleRadiusPx;
-    cache.spawnMaxRadius = spawnMaxRadius;
-    cache.cursorRadiusPx = cursorRadiusNorm * halfField;
-    cache.valid = true;
+    ComPtr<ID3D11Buffer> buffer;
+    if (FAILED(m_pd3dDevice->CreateBuffer(&bd, nullptr, &buffer))) return false;
+    m_pCircleInstanceBuffer = buffer;
+    m_circleInstanceCapacity = capacity;
+    return true;
 }
 
-bool Renderer::InitGraphics() {
-    HRESULT hr;
-    ComPtr<ID3DBlob> pVSBlob, pPSBlob, errorBlob;
+void Renderer::UpdateFieldCache(FieldCache& cache, float scale, float circleRadiusNorm, float cursorRadiusNorm) {
+    ::UpdateFieldCache(cache, m_width, m_height, scale, circleRadiusNorm, cursorRadiusNorm);
+}
 
-    // Vertex shader
-    const char* vsCode = R"(
-    cbuffer Transform : register(b0)
-    {
-        float4 scale;        
-        float4 translate;    
-        float4 windowSize;   
-    };
-    struct VS_INPUT
-    {
-        float2 pos : POSITION;
-    };
-    struct VS_OUTPUT
-    {
-        float4 pos : SV_POSITION;
-        float2 worldPos : TEXCOORD0;
-    };
-    VS_OUTPUT main(VS_INPUT input)
-    {
-        VS_OUTPUT output;
-        float2 worldPos = input.pos * scale.xy + translate.xy;
-        output.worldPos = worldPos;
-        output.pos = float4(
-            (worldPos.x / windowSize.x) * 2.0 - 1.0,
-            (worldPos.y / windowSize.y) * -2.0 + 1.0,
-            0.0, 1.0);
-        return output;
-    })";
-
-    hr = D3DCompile(vsCode, strlen(vsCode), nullptr, nullptr, nullptr, "main", "vs_5_0", D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &pVSBlob, &errorBlob);
-    if (FAILED(hr)) {
-        if (errorBlob) {
-            OutputDebugStringA((char*)errorBlob->GetBufferPointer());
-            errorBlob->Release();
+namespace {
+#ifdef FLICKS_SHADER_CACHE
+    const char* kShaderCacheDir = "res/shader_cache";
+
+    // shaders/<name>.hlsl through the cache; false when the source is missing
+    // or does not compile, and the embedded bytecode is used instead
+    bool CompileShader(const char* name, const char* target, std::vector<uint8_t>& bytecode) {
+        const std::string path = std::string("shaders/") + name + ".hlsl";
+        std::vector<uint8_t> source;
+        if (!ReadFileBytes(path.c_str(), source)) return false;
+        const uint64_t hash = HashShaderSource(source.data(), source.size(), target);
+        if (LoadCachedShader(kShaderCacheDir, name, hash, bytecode)) return true;
+
+        ComPtr<ID3DBlob> blob, errorBlob;
+        HRESULT hr = D3DCompile(source.data(), source.size(), path.c_str(), nullptr, nullptr, "main", target, D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &blob, &errorBlob);
+        if (FAILED(hr)) {
+            if (errorBlob) OutputDebugStringA((char*)errorBlob->GetBufferPointer());
+            return false;
         }
-        return false;
+        const uint8_t* code = static_cast<const uint8_t*>(blob->GetBufferPointer());
+        bytecode.assign(code, code + blob->GetBufferSize());
+        StoreCachedShader(kShaderCacheDir, name, hash, bytecode.data(), bytecode.size());
+        return true;
     }
-    hr = m_pd3dDevice->CreateVertexShader(pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), nullptr, &m_pVS);
-    if (FAILED(hr)) return false;
+#endif
+}
 
-    // Pixel shader for field
-    const char* psFieldCode = R"(
-    cbuffer PS_Field : register(b0)
-    {
-        float4 color;
+bool Renderer::LoadShaders() {
+    struct Shader {
+        const char* name;
+        const char* target;
+        const BYTE* embedded;
+        size_t embeddedSize;
+        ShaderCode& code;
     };
-    float4 main() : SV_Target
-    {
-        return color;
-    })";
-
-    hr = D3DCompile(psFieldCode, strlen(psFieldCode), nullptr, nullptr, nullptr, "main", "ps_5_0", D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &pPSBlob, &errorBlob);
-    if (FAILED(hr)) {
-        if (errorBlob) {
-            OutputDebugStringA((char*)errorBlob->GetBufferPointer());
-            errorBlob->Release();
-        }
-        return false;
-    }
-    hr = m_pd3dDevice->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, &m_pPS_Field);
-    if (FAILED(hr)) return false;
-    pPSBlob.Reset();
-
-    // Pixel shader for circle
-    const char* psCircleCode = R"(
-    cbuffer PS_Circle : register(b0) {
-        float4 color;
-        float2 center;
-        float radius;
-        float featherWidth;
+    Shader shaders[] = {
+        { "field_vs", "vs_5_0", g_field_vs, sizeof(g_field_vs), m_fieldVSCode },
+        { "field_ps", "ps_5_0", g_field_ps, sizeof(g_field_ps), m_fieldPSCode },
+        { "circle_vs", "vs_5_0", g_circle_vs, sizeof(g_circle_vs), m_circleVSCode },
+        { "circle_ps", "ps_5_0", g_circle_ps, sizeof(g_circle_ps), m_circlePSCode },
     };
-
-    float4 main(float4 pos : SV_POSITION, float2 worldPos : TEXCOORD0) : SV_Target {
-        float2 delta = worldPos - center;
-        float dist = length(delta);
-        float alpha = saturate( (radius - dist) / featherWidth );
-        return float4(color.rgb, color.a * alpha);
-    })";
-
-    hr = D3DCompile(psCircleCode, strlen(psCircleCode), nullptr, nullptr, nullptr, "main", "ps_5_0", D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &pPSBlob, &errorBlob);
-    if (FAILED(hr)) {
-        if (errorBlob) {
-            OutputDebugStringA((char*)errorBlob->GetBufferPointer());
-            errorBlob->Release();
+    for (Shader& shader : shaders) {
+        shader.code.data = shader.embedded;
+        shader.code.size = shader.embeddedSize;
+#ifdef FLICKS_SHADER_CACHE
+        if (CompileShader(shader.name, shader.target, shader.code.compiled)) {
+            shader.code.data = shader.code.compiled.data();
+            shader.code.size = shader.code.compiled.size();
         }
-        return false;
+#endif
     }
-    hr = m_pd3dDevice->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, &m_pPS_Circle);
+    return true;
+}
+
+bool Renderer::CreateGraphics() {
+    if (!m_fieldVSCode.data || !m_fieldPSCode.data || !m_circleVSCode.data || !m_circlePSCode.data) return false;
+
+    HRESULT hr = m_pd3dDevice->CreateVertexShader(m_fieldVSCode.data, m_fieldVSCode.size, nullptr, &m_pVS);
+    if (FAILED(hr)) return false;
+    hr = m_pd3dDevice->CreatePixelShader(m_fieldPSCode.data, m_fieldPSCode.size, nullptr, &m_pPS_Field);
+    if (FAILED(hr)) return false;
+    hr = m_pd3dDevice->CreatePixelShader(m_circlePSCode.data, m_circlePSCode.size, nullptr, &m_pPS_Circle);
+    if (FAILED(hr)) return false;
+    hr = m_pd3dDevice->CreateVertexShader(m_circleVSCode.data, m_circleVSCode.size, nullptr, &m_pVS_Circle);
     if (FAILED(hr)) return false;
 
     // Create input layout
@@ -404,7 +411,16 @@ bool Renderer::InitGraphics() {
         { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
     };
     UINT numElements = ARRAYSIZE(layout);
-    hr = m_pd3dDevice->CreateInputLayout(layout, numElements, pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), &m_pVertexLayout);
+    hr = m_pd3dDevice->CreateInputLayout(layout, numElements, m_fieldVSCode.data, m_fieldVSCode.size, &m_pVertexLayout);
+    if (FAILED(hr)) return false;
+
+    D3D11_INPUT_ELEMENT_DESC circleLayout[] =
+    {
+        { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "CIRCLE", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+    };
+    hr = m_pd3dDevice->CreateInputLayout(circleLayout, ARRAYSIZE(circleLayout), m_circleVSCode.data, m_circleVSCode.size, &m_pCircleLayout);
     if (FAILED(hr)) return false;
 
     // Vertex buffer 
@@ -446,10 +462,8 @@ bool Renderer::InitGraphics() {
     hr = m_pd3dDevice->CreateBuffer(&bd, nullptr, &m_pConstantBufferPS_Field);
     if (FAILED(hr)) return false;
 
-    // PS_Circle_ConstantBuffer
-    bd.ByteWidth = sizeof(PS_Circle_ConstantBuffer);
-    hr = m_pd3dDevice->CreateBuffer(&bd, nullptr, &m_pConstantBufferPS_Circle);
-    if (FAILED(hr)) return false;
+    // Circle instances
+    if (!EnsureCircleInstanceCapacity(64)) return false;
 
     return true;
 }
@@ -472,14 +486,6 @@ void Renderer::UpdateVSConstantBuffer(const VS_ConstantBuffer& data) {
     }
 }
 
-void Renderer::UpdatePSCircleConstantBuffer(const PS_Circle_ConstantBuffer& data) {
-    D3D11_MAPPED_SUBRESOURCE mapped;
-    if (SUCCEEDED(m_pd3dDeviceContext->Map(m_pConstantBufferPS_Circle.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) {
-        memcpy(mapped.pData, &data, sizeof(PS_Circle_ConstantBuffer));
-        m_pd3dDeviceContext->Unmap(m_pConstantBufferPS_Circle.Get(), 0);
-    }
-}
-
 void Renderer::UpdatePSFieldConstantBuffer(const PS_Field_ConstantBuffer& data) {
     D3D11_MAPPED_SUBRESOURCE mapped;
     if (SUCCEEDED(m_pd3dDeviceContext->Map(m_pConstantBufferPS_Field.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) {
@@ -492,4 +498,19 @@ void Renderer::WaitForFrameLatencyObject() {
     if (m_frameLatencyWaitableObject) {
         WaitForSingleObjectEx(m_frameLatencyWaitableObject, 1000, TRUE);
     }
+}
+
+UINT Renderer::GetLastPresentCount() {
+    UINT count = 0;
+    if (!m_pSwapChain || FAILED(m_pSwapChain->GetLastPresentCount(&count))) return 0;
+    return count;
+}
+
+bool Renderer::GetLastDisplayed(UINT& presentCount, long long& displayUs) {
+    DXGI_FRAME_STATISTICS stats;
+    // Fails until the first frame is shown, and while the window is occluded
+    if (!m_pSwapChain || FAILED(m_pSwapChain->GetFrameStatistics(&stats))) return false;
+    presentCount = stats.PresentCount;
+    displayUs = QpcToUs(stats.SyncQPCTime.QuadPart);
+    return true;
 }
\ No newline at end of file
@@ -4,13 +4,17 @@
 #include <d3d11.h>
 #include <dxgi.h>
 #include <dxgi1_3.h>
-#include <d3dcompiler.h>
 #include <wrl/client.h>
 #include <imgui.h>
+#include <cstdint>
+#include <vector>
+
+#include "field.h"
+#include "render_backend.h"
 
 using Microsoft::WRL::ComPtr;
 
-class Renderer {
+class Renderer : public RenderBackend {
 public:
     struct VS_ConstantBuffer {
         float scale[4];
@@ -22,42 +26,49 @@ public:
         float color[4];
     };
 
-    struct PS_Circle_ConstantBuffer {
-        float color[4];
+    // Per-instance vertex data of the circle batch
+    struct CircleInstance {
         float center[2];
         float radius;
         float featherWidth;
+        float color[4];
     };
 
-    struct FieldCache {
-        float fieldSize = 0.0f;
-        ImVec2 fieldTL = ImVec2(0, 0);
-        ImVec2 fieldBR = ImVec2(0, 0);
-        ImVec2 center = ImVec2(0, 0);
-        float halfField = 0.0f;
-        float circleRadiusPx = 0.0f;
-        float spawnMaxRadius = 0.0f;
-        float cursorRadiusPx = 0.0f;
-        bool valid = false;
-    };
+    using FieldCache = ::FieldCache;
 
     Renderer();
-    ~Renderer();
+    ~Renderer() override;
 
+    // CreateDevice, LoadShaders and CreateGraphics in order
     bool Initialize(HWND hWnd, int width, int height, int refreshRate);
+    // The same in steps for a parallel startup: LoadShaders needs no device
+    // and may run on another thread while CreateDevice runs; CreateGraphics
+    // needs both done.
+    bool CreateDevice(HWND hWnd, int width, int height, int refreshRate);
+    // The embedded bytecode; dev builds (FLICKS_SHADER_CACHE) compile
+    // shaders/*.hlsl through res/shader_cache and fall back to it
+    bool LoadShaders();
+    bool CreateGraphics();
     void SetMaxFrameLatency(UINT latency);
     void Cleanup();
     void Resize(int width, int height);
 
-    void BeginFrame(const float clearColor[4]);
-    void EndFrame();
+    void BeginFrame(const float clearColor[4]) override;
+    void EndFrame() override;
 
-    void DrawField(const FieldCache& fieldCache, const ImVec4& fieldColor);
-    void BeginCircleRendering();
-    void DrawCircle(const ImVec2& center, float radius, const ImVec4& color, float feather = 1.0f);
-    void EndCircleRendering();
+    void DrawField(const FieldCache& fieldCache, const ImVec4& fieldColor) override;
+    // Circles are queued between Begin and End and submitted as one instanced draw
+    void BeginCircleRendering() override;
+    void DrawCircle(const ImVec2& center, float radius, const ImVec4& color, float feather = 1.0f) override;
+    void EndCircleRendering() override;
     void UpdateFieldCache(FieldCache& cache, float scale, float circleRadiusNorm, float cursorRadiusNorm);
     void WaitForFrameLatencyObject();
+    // On: Present waits for vblank. Off: Present tears and never blocks.
+    void SetVsync(bool vsync) { m_vsync = vsync; }
+    // Id DXGI gave the last Present, 0 if it cannot tell
+    UINT GetLastPresentCount();
+    // The newest present DXGI has seen reach the screen and its vblank time on the NowUs clock
+    bool GetLastDisplayed(UINT& presentCount, long long& displayUs);
 
     ID3D11Device* GetDevice() { return m_pd3dDevice.Get(); }
     ID3D11DeviceContext* GetDeviceContext() { return m_pd3dDeviceContext.Get(); }
@@ -65,17 +76,14 @@ public:
 private:
     VS_ConstantBuffer m_lastVSData;
     PS_Field_ConstantBuffer m_lastPSFieldData;
-    PS_Circle_ConstantBuffer m_lastPSCircleData;
     bool m_hasLastVSData = false;
     bool m_hasLastPSFieldData = false;
-    bool m_hasLastPSCircleData = false;
 
-    bool InitGraphics();
     void CleanupRenderTarget();
     void CreateRenderTarget();
 
     void UpdateVSConstantBuffer(const VS_ConstantBuffer& data);
-    void UpdatePSCircleConstantBuffer(const PS_Circle_ConstantBuffer& data);
+    bool EnsureCircleInstanceCapacity(UINT count);
     void UpdatePSFieldConstantBuffer(const PS_Field_ConstantBuffer& data);
 
     HWND m_hWnd;
@@ -83,6 +91,7 @@ private:
     int m_height;
 
     UINT m_maxFrameLatency = 1;
+    bool m_vsync = false;
     HANDLE m_frameLatencyWaitableObject = NULL;
 
     ComPtr<ID3D11Device> m_pd3dDevice;
@@ -94,13 +103,28 @@ private:
     ComPtr<ID3D11DepthStencilState> m_pDepthStencilState;
     ComPtr<ID3D11RasterizerState> m_pRasterizerState;
 
+    // Bytecode of one shader: the embedded array, or what a dev build compiled
+    struct ShaderCode {
+        const void* data = nullptr;
+        size_t size = 0;
+        std::vector<uint8_t> compiled;
+    };
+    ShaderCode m_fieldVSCode;
+    ShaderCode m_fieldPSCode;
+    ShaderCode m_circleVSCode;
+    ShaderCode m_circlePSCode;
     ComPtr<ID3D11VertexShader> m_pVS;
+    ComPtr<ID3D11VertexShader> m_pVS_Circle;
     ComPtr<ID3D11PixelShader> m_pPS_Field;
     ComPtr<ID3D11PixelShader> m_pPS_Circle;
     ComPtr<ID3D11InputLayout> m_pVertexLayout;
+    ComPtr<ID3D11InputLayout> m_pCircleLayout;
     ComPtr<ID3D11Buffer> m_pVertexBuffer;
     ComPtr<ID3D11Buffer> m_pIndexBuffer;
     ComPtr<ID3D11Buffer> m_pConstantBufferVS;
     ComPtr<ID3D11Buffer> m_pConstantBufferPS_Field;
-    ComPtr<ID3D11Buffer> m_pConstantBufferPS_Circle;
+    ComPtr<ID3D11Buffer> m_pCircleInstanceBuffer;
+    UINT m_circleInstanceCapacity = 0;
+
+    std::vector<CircleInstance> m_circles;
 };
\ No newline at end of file
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// Stream ids for the independent generators a game draws from
+enum RngStream : uint64_t {
+    RNG_STREAM_POSITION = 1,
+    RNG_STREAM_DELAY = 2,
+    RNG_STREAM_PLAYER = 3,
+    RNG_STREAM_SEEDS = 4
+};
+
+inline uint64_t SplitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// xoshiro128** with a 16 byte state. Seeding goes through SplitMix64, so any
+// (seed, stream) pair gives a well-mixed, non-zero state, and the output only
+// depends on integer arithmetic: the same seed replays the same game everywhere.
+class Rng {
+public:
+    Rng() { Seed(0); }
+    explicit Rng(uint64_t seed, uint64_t stream = 0) { Seed(seed, stream); }
+
+    void Seed(uint64_t seed, uint64_t stream = 0) {
+        uint64_t sm = seed ^ (stream * 0xd1342543de82ef95ull);
+        uint64_t a = SplitMix64(sm);
+        uint64_t b = SplitMix64(sm);
+        m_s[0] = static_cast<uint32_t>(a);
+        m_s[1] = static_cast<uint32_t>(a >> 32);
+        m_s[2] = static_cast<uint32_t>(b);
+        m_s[3] = static_cast<uint32_t>(b >> 32);
+        m_hasSpare = false;
+    }
+
+    uint32_t Next() {
+        const uint32_t result = Rotl(m_s[1] * 5, 7) * 9;
+        const uint32_t t = m_s[1] << 9;
+        m_s[2] ^= m_s[0];
+        m_s[3] ^= m_s[1];
+        m_s[1] ^= m_s[2];
+        m_s[0] ^= m_s[3];
+        m_s[2] ^= t;
+        m_s[3] = Rotl(m_s[3], 11);
+        return result;
+    }
+
+    uint64_t Next64() {
+        uint64_t hi = Next();
+        return (hi << 32) | Next();
+    }
+
+    // Uniform in [min, max], both inclusive; unbiased (Lemire's multiply-shift)
+    int NextInt(int min, int max) {
+        if (min > max) { int t = min; min = max; max = t; }
+        const uint32_t range = static_cast<uint32_t>(max) - static_cast<uint32_t>(min) + 1u;
+        if (range == 0) return static_cast<int>(Next());
+        uint64_t m = static_cast<uint64_t>(Next()) * range;
+        uint32_t low = static_cast<uint32_t>(m);
+        if (low < range) {
+            const uint32_t threshold = (0u - range) % range;
+            while (low < threshold) {
+                m = static_cast<uint64_t>(Next()) * range;
+                low = static_cast<uint32_t>(m);
+            }
+        }
+        return static_cast<int>(static_cast<uint32_t>(min) + static_cast<uint32_t>(m >> 32));
+    }
+
+    // Uniform in [0, 1) with 24 bits of precision
+    float NextFloat() {
+        return static_cast<float>(Next() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    float NextFloat(float min, float max) {
+        return min + (max - min) * NextFloat();
+    }
+
+    // Marsaglia polar method
+    float NextNormal(float mean, float sd) {
+        if (m_hasSpare) {
+            m_hasSpare = false;
+            return mean + sd * m_spare;
+        }
+        float u, v, s;
+        do {
+            u = NextFloat() * 2.0f - 1.0f;
+            v = NextFloat() * 2.0f - 1.0f;
+            s = u * u + v * v;
+        } while (s >= 1.0f || s == 0.0f);
+        const float k = std::sqrt(-2.0f * std::log(s) / s);
+        m_spare = v * k;
+        m_hasSpare = true;
+        return mean + sd * u * k;
+    }
+
+private:
+    static uint32_t Rotl(uint32_t x, int k) {
+        return (x << k) | (x >> (32 - k));
+    }
+
+    uint32_t m_s[4];
+    float m_spare = 0.0f;
+    bool m_hasSpare = false;
+};
@@ -0,0 +1,54 @@
+#include "scene.h"
+
+void DrawScene(RenderBackend& renderer, const FlicksSession& session, const FieldCache& field,
+    const GameSettings& settings, const ImVec2* cursor) {
+    float clear_color[4] = {
+        settings.bgColor.x,
+        settings.bgColor.y,
+        settings.bgColor.z,
+        settings.bgColor.w
+    };
+
+    renderer.BeginFrame(clear_color);
+
+    renderer.DrawField(field, settings.fieldColor);
+
+    renderer.BeginCircleRendering();
+
+    if (session.GetState() == GAME_NOT_STARTED) {
+        renderer.DrawCircle(
+            field.center,
+            field.circleRadiusPx,
+            settings.circleColor
+        );
+    }
+    else if (session.GetState() == GAME_RUNNING && session.IsCircleActive()) {
+        renderer.DrawCircle(
+            session.GetCirclePos(),
+            field.circleRadiusPx,
+            settings.circleColor
+        );
+    }
+
+    if (cursor) {
+        float Cr = field.cursorRadiusPx;
+
+        renderer.DrawCircle(
+            *cursor,
+            Cr,
+            settings.cursorOutlineColor
+        );
+
+        float innerRadius = Cr - settings.cursorThickness;
+        if (innerRadius > 0.0f) {
+            renderer.DrawCircle(
+                *cursor,
+                innerRadius,
+                settings.cursorColor,
+                0.1f
+            );
+        }
+    }
+
+    renderer.EndCircleRendering();
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "render_backend.h"
+#include "session.h"
+#include "settings.h"
+
+// Draws one game frame: background, field, the current target and, when
+// cursor is given, the custom cursor. UI is drawn on top by the caller.
+void DrawScene(RenderBackend& renderer, const FlicksSession& session, const FieldCache& field,
+    const GameSettings& settings, const ImVec2* cursor);
@@ -0,0 +1,284 @@
+#include "session.h"
+#include "session_trace.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <random>
+
+GameSummary MakeGameSummary(const GameResult& result, std::time_t timestamp) {
+    GameSummary summary;
+    summary.circleRadiusNorm = result.settings.circleRadiusNorm;
+    summary.cursorRadiusNorm = result.settings.cursorRadiusNorm;
+    summary.circleLifetimeMs = result.settings.circleLifetimeMs;
+    summary.gameTimeSec = result.settings.gameTimeSec;
+    summary.minSpawnDelayMs = result.settings.minSpawnDelayMs;
+    summary.maxSpawnDelayMs = result.settings.maxSpawnDelayMs;
+    summary.endBySpawnCount = result.settings.endBySpawnCount;
+    summary.maxSpawnCount = result.settings.maxSpawnCount;
+    summary.hits = result.hits;
+    summary.avgReactionTime = result.avgReactionTime;
+    summary.score = result.score;
+    summary.timestamp = timestamp;
+    summary.seed = result.seed;
+    return summary;
+}
+
+FlicksSession::FlicksSession() {
+    std::random_device rd;
+    Seed((static_cast<uint64_t>(rd()) << 32) | rd());
+}
+
+void FlicksSession::Configure(const GameSettings& settings, const FieldCache& field) {
+    m_settings = settings;
+    m_field = field;
+}
+
+void FlicksSession::Seed(uint64_t seed) {
+    m_seedGen.Seed(seed, RNG_STREAM_SEEDS);
+}
+
+void FlicksSession::Reset() {
+    Reset(m_seedGen.Next64());
+}
+
+void FlicksSession::Reset(uint64_t gameSeed) {
+    m_seed = gameSeed;
+    m_hits = 0;
+    m_attempts = 0;
+    m_spawnCount = 0;
+    m_spawnFallbacks = 0;
+    m_state = GAME_NOT_STARTED;
+    m_circleActive = false;
+    m_lastCircle = false;
+    m_forceFinish = false;
+    m_events.Clear();
+    m_eventRun = false;
+
+    m_result.scoreHistory.clear();
+    m_result.reactionTimesUs.clear();
+    m_result.reactionStats = RunningStats();
+    m_result.reactionQuantiles = Quantiles();
+    m_lastReactionTimeUs = 0;
+
+    if (m_trace) m_trace->Clear();
+}
+
+void FlicksSession::Start(long long nowUs) {
+    m_state = GAME_RUNNING;
+    m_gameStartTimeUs = nowUs;
+
+    // Room for the whole game, so neither a hit nor the end allocates
+    m_result.scoreHistory.reserve(m_settings.gameTimeSec + 1);
+    const size_t maxReactions = m_settings.endBySpawnCount ?
+        static_cast<size_t>(std::max(0, m_settings.maxSpawnCount)) :
+        static_cast<size_t>(m_settings.gameTimeSec) * 10;
+    m_result.reactionTimesUs.reserve(maxReactions);
+    m_quantileScratch.reserve(maxReactions);
+
+    m_result.scoreHistory.clear();
+    m_result.scoreHistory.push_back(0);
+    m_nextSampleUs = nowUs + 1000000;
+    m_spawnCount = 0;
+    m_lastCircle = false;
+
+    // Capture settings at game start
+    m_startSettings = m_settings;
+    m_schedule.Begin(m_seed, m_startSettings);
+    if (m_trace) m_trace->Begin(m_seed, m_startSettings, m_field, nowUs);
+
+    m_circleActive = false;
+
+    // Delay before the first spawn, and the time limit
+    m_events.Clear();
+    m_events.Schedule(GAME_EVENT_SPAWN, m_gameStartTimeUs + m_schedule.Get(0).delayMs * 1000LL);
+    if (!m_startSettings.endBySpawnCount) {
+        m_events.Schedule(GAME_EVENT_END, m_gameStartTimeUs + GameTimeUs());
+    }
+    else if (m_startSettings.maxSpawnCount <= 0) {
+        m_events.Schedule(GAME_EVENT_END, m_gameStartTimeUs);
+    }
+}
+
+bool FlicksSession::Tick(long long nowUs) {
+    if (m_state != GAME_RUNNING) return false;
+    if (nowUs < m_events.GetNextTimeUs() && !m_forceFinish) {
+        SampleScoreHistory(nowUs);
+        return false;
+    }
+
+    GameEventType type;
+    long long eventUs;
+    while (m_events.PopDue(nowUs, type, eventUs)) {
+        SampleScoreHistory(eventUs);
+        RunEvent(type, eventUs);
+        if (m_state == GAME_FINISHED) return true;
+    }
+    SampleScoreHistory(nowUs);
+
+    // A requested finish has no deadline: it takes effect at the tick that sees it
+    if (m_forceFinish && !m_lastCircle) {
+        MarkLast(nowUs);
+        if (!m_circleActive) {
+            Finish(nowUs);
+            return true;
+        }
+    }
+    return false;
+}
+
+void FlicksSession::RunEvent(GameEventType type, long long timeUs) {
+    if (!m_eventRun) {
+        m_eventRun = true;
+        m_firstEventUs = timeUs;
+    }
+
+    switch (type) {
+    case GAME_EVENT_END:
+        if (!m_lastCircle) MarkLast(timeUs);
+        if (!m_circleActive) Finish(timeUs);
+        break;
+    case GAME_EVENT_EXPIRE:
+        m_circleActive = false;
+        if (m_trace) m_trace->RecordExpire(timeUs);
+        if (m_lastCircle) Finish(timeUs);
+        else ScheduleNextSpawn(timeUs);
+        break;
+    case GAME_EVENT_SPAWN:
+        SpawnCircle(timeUs);
+        break;
+    default:
+        break;
+    }
+}
+
+FlicksSession::ClickResult FlicksSession::Click(float x, float y, long long nowUs) {
+    const float R = m_field.circleRadiusPx;
+    const float Cr = m_field.cursorRadiusPx;
+    const float hitRadiusSq = (R + Cr) * (R + Cr);
+
+    if (m_state == GAME_NOT_STARTED) {
+        float dx = x - m_field.center.x;
+        float dy = y - m_field.center.y;
+        if (dx * dx + dy * dy <= hitRadiusSq) {
+            Start(nowUs);
+            if (m_trace) m_trace->RecordClick(x, y, CLICK_STARTED, nowUs);
+            return CLICK_STARTED;
+        }
+        return CLICK_NONE;
+    }
+
+    if (m_state != GAME_RUNNING) return CLICK_NONE;
+
+    m_attempts++;
+    float dx = x - m_circlePos.x;
+    float dy = y - m_circlePos.y;
+    if (!m_circleActive || dx * dx + dy * dy > hitRadiusSq) {
+        if (m_trace) m_trace->RecordClick(x, y, CLICK_MISS, nowUs);
+        return CLICK_MISS;
+    }
+    if (m_trace) m_trace->RecordClick(x, y, CLICK_HIT, nowUs);
+
+    m_hits++;
+    m_lastReactionTimeUs = static_cast<int>(nowUs - m_circleSpawnTimeUs);
+    m_result.reactionTimesUs.push_back(m_lastReactionTimeUs);
+    m_result.reactionStats.Add(m_lastReactionTimeUs / 1000.0);
+    m_circleActive = false;
+    m_events.Cancel(GAME_EVENT_EXPIRE);
+
+    // The last target hit ends the game right here
+    if (m_lastCircle) m_events.Schedule(GAME_EVENT_END, nowUs);
+    else ScheduleNextSpawn(nowUs);
+    return CLICK_HIT;
+}
+
+void FlicksSession::RequestFinish() {
+    if (m_state != GAME_RUNNING) return;
+    m_forceFinish = true;
+    m_events.Cancel(GAME_EVENT_SPAWN);
+}
+
+long long FlicksSession::GetNextEventTimeUs() const {
+    if (m_state != GAME_RUNNING) return LLONG_MAX;
+    // The next tick applies the request
+    if (m_forceFinish && !m_lastCircle) return m_gameStartTimeUs;
+    return m_events.GetNextTimeUs();
+}
+
+bool FlicksSession::TakeFirstEventTime(long long& timeUs) {
+    if (!m_eventRun) return false;
+    timeUs = m_firstEventUs;
+    m_eventRun = false;
+    return true;
+}
+
+void FlicksSession::SpawnCircle(long long nowUs) {
+    const SpawnPoint& p = m_schedule.Get(m_spawnCount);
+    const float a = m_field.spawnMaxRadius;
+
+    m_circleSpawnTimeUs = nowUs;
+    m_circlePos = ImVec2(m_field.center.x + a * p.x, m_field.center.y + a * p.y);
+    m_circleActive = true;
+    m_spawnCount++;
+    if (p.fallback) m_spawnFallbacks++;
+    if (m_trace) m_trace->RecordSpawn(m_circlePos.x, m_circlePos.y, nowUs);
+
+    m_events.Schedule(GAME_EVENT_EXPIRE, nowUs + LifetimeUs());
+    if (m_startSettings.endBySpawnCount && m_spawnCount >= m_startSettings.maxSpawnCount) {
+        m_events.Schedule(GAME_EVENT_END, nowUs);
+    }
+}
+
+void FlicksSession::ScheduleNextSpawn(long long nowUs) {
+    if (m_lastCircle || m_forceFinish) return;
+    m_events.Schedule(GAME_EVENT_SPAWN, nowUs + m_schedule.Get(m_spawnCount).delayMs * 1000LL);
+}
+
+void FlicksSession::MarkLast(long long nowUs) {
+    m_lastCircle = true;
+    m_events.Cancel(GAME_EVENT_SPAWN);
+    if (m_trace) m_trace->RecordLast(m_forceFinish, nowUs);
+}
+
+void FlicksSession::SampleScoreHistory(long long nowUs) {
+    // One sample per whole second of play
+    while (nowUs >= m_nextSampleUs) {
+        m_result.scoreHistory.push_back(m_hits);
+        m_nextSampleUs += 1000000;
+    }
+}
+
+void FlicksSession::Finish(long long nowUs) {
+    m_state = GAME_FINISHED;
+
+    m_result.avgReactionTime = 0.0f;
+    if (!m_result.reactionTimesUs.empty()) {
+        long long sum = 0;
+        for (int rt : m_result.reactionTimesUs) sum += rt;
+        m_result.avgReactionTime = static_cast<float>(static_cast<double>(sum) / m_result.reactionTimesUs.size() / 1000.0);
+
+        m_quantileScratch.assign(m_result.reactionTimesUs.begin(), m_result.reactionTimesUs.end());
+        Quantiles q = ExactQuantiles(m_quantileScratch);
+        m_result.reactionQuantiles = { q.p50 / 1000.0, q.p90 / 1000.0, q.p99 / 1000.0 };
+    }
+
+    float finalScore;
+    if (m_startSettings.endBySpawnCount) {
+        float sqrtValue = static_cast<float>(
+            std::sqrt(std::max(0, m_startSettings.maxSpawnCount - m_hits))
+            );
+        finalScore = sqrtValue * 100.0f + m_result.avgReactionTime;
+    }
+    else {
+        finalScore = static_cast<float>(m_hits);
+    }
+
+    m_result.settings = m_startSettings;
+    m_result.seed = m_seed;
+    m_result.hits = m_hits;
+    m_result.attempts = m_attempts;
+    m_result.accuracy = (m_attempts > 0) ? (100.0f * m_hits / m_attempts) : 0.0f;
+    m_result.score = finalScore;
+    m_result.spawnFallbacks = m_spawnFallbacks;
+
+    if (m_trace) m_trace->RecordEnd(m_result, m_forceFinish, nowUs);
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+#include "settings.h"
+#include "field.h"
+#include "game_events.h"
+#include "spawn_schedule.h"
+#include "stream_stats.h"
+
+class SessionTrace;
+
+enum GameState {
+    GAME_NOT_STARTED,
+    GAME_RUNNING,
+    GAME_FINISHED
+};
+
+struct GameResult {
+    GameSettings settings;
+    uint64_t seed = 0;
+    int hits = 0;
+    int attempts = 0;
+    float accuracy = 0.0f;
+    float avgReactionTime = 0.0f;       // ms
+    float score = 0.0f;
+    int spawnFallbacks = 0;     // targets with no position far enough from the previous one
+    std::vector<int> scoreHistory;
+    std::vector<int> reactionTimesUs;
+    RunningStats reactionStats;         // ms, fed on every hit
+    Quantiles reactionQuantiles;        // ms, exact, set when the game ends
+};
+
+struct GameSummary {
+    float circleRadiusNorm;
+    float cursorRadiusNorm;
+    int circleLifetimeMs;
+    int gameTimeSec;
+    bool endBySpawnCount;
+    int maxSpawnCount;
+    int minSpawnDelayMs;
+    int maxSpawnDelayMs;
+    int hits;
+    float avgReactionTime;
+    float score;
+    std::time_t timestamp;
+    uint64_t seed;
+};
+
+GameSummary MakeGameSummary(const GameResult& result, std::time_t timestamp);
+
+// Game rules without any window, device or clock: time and input are injected
+// by the caller, so the same code drives the app and headless simulation.
+// Times are in microseconds on any monotonic clock the caller picks.
+class FlicksSession {
+public:
+    enum ClickResult {
+        CLICK_NONE,
+        CLICK_STARTED,
+        CLICK_HIT,
+        CLICK_MISS
+    };
+
+    // Goes up with every change that makes the same clicks play out
+    // differently; traces record it, so replay can tell old games apart.
+    // 2: the analytic spawn sampler no longer biases distances within a bin.
+    static const uint32_t kRulesVersion = 2;
+
+    FlicksSession();
+
+    // Live settings and field geometry; a running game keeps the settings it started with
+    void Configure(const GameSettings& settings, const FieldCache& field);
+    // Seeds the sequence that every Reset() draws the next game seed from
+    void Seed(uint64_t seed);
+    // Records every spawn, expiry, click and the end of each game into trace; null stops recording
+    void SetTrace(SessionTrace* trace) { m_trace = trace; }
+
+    void Reset();
+    // Prepares a game with a fixed seed, e.g. to replay a recorded one
+    void Reset(uint64_t gameSeed);
+    void Start(long long nowUs);
+    // Runs every spawn, expiry and end due by nowUs at its own scheduled time,
+    // so a late tick never stretches a target's lifetime. Returns true on the
+    // tick the game finishes.
+    bool Tick(long long nowUs);
+    // Callers tick to the click time first, so the click sees the targets live at that moment
+    ClickResult Click(float x, float y, long long nowUs);
+    void RequestFinish();
+    // Earliest time at which Tick can change the state; lets callers step from event to event
+    long long GetNextEventTimeUs() const;
+    // Scheduled time of the earliest event run since the last call, for measuring
+    // how late events reach the screen. False if none ran.
+    bool TakeFirstEventTime(long long& timeUs);
+
+    GameState GetState() const { return m_state; }
+    bool IsCircleActive() const { return m_circleActive; }
+    ImVec2 GetCirclePos() const { return m_circlePos; }
+    long long GetCircleSpawnTimeUs() const { return m_circleSpawnTimeUs; }
+    const FieldCache& GetField() const { return m_field; }
+    const GameSettings& GetStartSettings() const { return m_startSettings; }
+    const GameResult& GetResult() const { return m_result; }
+    bool WasForceFinished() const { return m_forceFinish; }
+    int GetHits() const { return m_hits; }
+    int GetAttempts() const { return m_attempts; }
+    int GetSpawnCount() const { return m_spawnCount; }
+    int GetLastReactionTimeUs() const { return m_lastReactionTimeUs; }
+    uint64_t GetSeed() const { return m_seed; }
+    long long GetGameStartTimeUs() const { return m_gameStartTimeUs; }
+    const SpawnSchedule& GetSchedule() const { return m_schedule; }
+
+private:
+    void RunEvent(GameEventType type, long long timeUs);
+    void SpawnCircle(long long nowUs);
+    void ScheduleNextSpawn(long long nowUs);
+    // No targets after the live one
+    void MarkLast(long long nowUs);
+    void SampleScoreHistory(long long nowUs);
+    void Finish(long long nowUs);
+
+    long long LifetimeUs() const { return m_startSettings.circleLifetimeMs * 1000LL; }
+    long long GameTimeUs() const { return m_startSettings.gameTimeSec * 1000000LL; }
+
+    GameSettings m_settings;
+    GameSettings m_startSettings;
+    FieldCache m_field;
+    Rng m_seedGen;
+    uint64_t m_seed = 0;
+    SpawnSchedule m_schedule;
+    SessionTrace* m_trace = nullptr;
+
+    GameState m_state = GAME_NOT_STARTED;
+    long long m_gameStartTimeUs = 0;
+    long long m_circleSpawnTimeUs = 0;
+    GameEventQueue m_events;
+    long long m_firstEventUs = 0;
+    bool m_eventRun = false;
+    ImVec2 m_circlePos = ImVec2(0, 0);
+    bool m_circleActive = false;
+    bool m_lastCircle = false;
+    bool m_forceFinish = false;
+
+    int m_hits = 0;
+    int m_attempts = 0;
+    int m_spawnCount = 0;
+    int m_spawnFallbacks = 0;
+    long long m_nextSampleUs = 0;
+    int m_lastReactionTimeUs = 0;
+
+    GameResult m_result;
+    std::vector<int> m_quantileScratch;
+};
@@ -0,0 +1,167 @@
+#include "session_replay.h"
+
+#include <cstring>
+
+namespace {
+    bool SameBits(float a, float b) {
+        return memcmp(&a, &b, sizeof(float)) == 0;
+    }
+}
+
+bool SessionReplay::Load(const char* path) {
+    End();
+    m_events.clear();
+    if (!ReadSessionTrace(path, m_header, m_events)) return false;
+    return Decode(nullptr, 0);
+}
+
+bool SessionReplay::Load(const SessionTrace& trace) {
+    End();
+    m_events.clear();
+    m_header = trace.GetHeader();
+    return Decode(trace.GetData(), trace.GetSize());
+}
+
+bool SessionReplay::Decode(const uint8_t* data, size_t size) {
+    if (data && !DecodeSessionTrace(data, size, m_header.startTimeUs, m_events)) return false;
+    if (m_events.empty() || m_events.front().type != TRACE_CLICK ||
+        m_events.front().detail != FlicksSession::CLICK_STARTED) {
+        return false;
+    }
+    m_endTimeUs = m_events.back().timeUs;
+
+    // The session re-records everything but the mouse reports; each event is
+    // at most as large as it was in the recording plus a longer time step
+    size_t gameEvents = 0;
+    for (const TraceEvent& e : m_events) gameEvents += (e.type != TRACE_MOVE);
+    m_output = SessionTrace(gameEvents * SessionTrace::kMaxEventBytes + SessionTrace::kMaxEventBytes);
+
+    m_settings.scale = m_header.scale;
+    m_settings.circleRadiusNorm = m_header.circleRadiusNorm;
+    m_settings.cursorRadiusNorm = m_header.cursorRadiusNorm;
+    m_settings.distanceRatio = m_header.distanceRatio;
+    m_settings.circleLifetimeMs = m_header.circleLifetimeMs;
+    m_settings.gameTimeSec = m_header.gameTimeSec;
+    m_settings.minSpawnDelayMs = m_header.minSpawnDelayMs;
+    m_settings.maxSpawnDelayMs = m_header.maxSpawnDelayMs;
+    m_settings.endBySpawnCount = (m_header.endBySpawnCount != 0);
+    m_settings.maxSpawnCount = m_header.maxSpawnCount;
+
+    // Same arithmetic as UpdateFieldCache, from the values the game used
+    m_field = FieldCache();
+    m_field.fieldSize = m_header.fieldSize;
+    m_field.halfField = m_header.fieldSize * 0.5f;
+    m_field.fieldTL = ImVec2(m_header.fieldLeft, m_header.fieldTop);
+    m_field.fieldBR = ImVec2(m_header.fieldLeft + m_header.fieldSize, m_header.fieldTop + m_header.fieldSize);
+    m_field.center = ImVec2(m_header.centerX, m_header.centerY);
+    m_field.circleRadiusPx = m_header.circleRadiusPx;
+    m_field.cursorRadiusPx = m_header.cursorRadiusPx;
+    m_field.spawnMaxRadius = m_header.spawnMaxRadius;
+    m_field.valid = true;
+    return true;
+}
+
+bool SessionReplay::Begin(FlicksSession& session, const GameSettings& baseSettings) {
+    End();
+    if (m_events.empty()) return false;
+
+    GameSettings settings = baseSettings;
+    settings.scale = m_settings.scale;
+    settings.circleRadiusNorm = m_settings.circleRadiusNorm;
+    settings.cursorRadiusNorm = m_settings.cursorRadiusNorm;
+    settings.distanceRatio = m_settings.distanceRatio;
+    settings.circleLifetimeMs = m_settings.circleLifetimeMs;
+    settings.gameTimeSec = m_settings.gameTimeSec;
+    settings.minSpawnDelayMs = m_settings.minSpawnDelayMs;
+    settings.maxSpawnDelayMs = m_settings.maxSpawnDelayMs;
+    settings.endBySpawnCount = m_settings.endBySpawnCount;
+    settings.maxSpawnCount = m_settings.maxSpawnCount;
+    m_settings = settings;
+
+    m_session = &session;
+    m_next = 0;
+    m_finished = false;
+    m_cursor = ImVec2(m_events.front().x, m_events.front().y);
+    m_output.SetMouseScale(m_header.mouseScale);
+
+    session.Configure(m_settings, m_field);
+    session.SetTrace(&m_output);
+    session.Reset(m_header.seed);
+    AdvanceTo(m_header.startTimeUs);
+    return session.GetState() == GAME_RUNNING;
+}
+
+bool SessionReplay::AdvanceTo(long long timeUs) {
+    if (!m_session) return true;
+
+    // The game ticked at every recorded event, and before every click: ticking
+    // at the same times reproduces its state changes exactly
+    while (m_next < m_events.size() && m_events[m_next].timeUs <= timeUs) {
+        const TraceEvent& e = m_events[m_next++];
+        switch (e.type) {
+        case TRACE_MOVE:
+            m_cursor.x += e.dx * m_header.mouseScale;
+            m_cursor.y += e.dy * m_header.mouseScale;
+            break;
+        case TRACE_CLICK:
+            m_session->Tick(e.timeUs);
+            m_session->Click(e.x, e.y, e.timeUs);
+            m_cursor = ImVec2(e.x, e.y);
+            break;
+        case TRACE_LAST:
+            // Only an early end needs the request; time and spawn limits are recomputed
+            if (e.detail) m_session->RequestFinish();
+            m_session->Tick(e.timeUs);
+            break;
+        default:
+            m_session->Tick(e.timeUs);
+            break;
+        }
+    }
+
+    if (!m_finished && m_session->GetState() == GAME_FINISHED) {
+        m_finished = true;
+        m_result = m_session->GetResult();
+    }
+    return IsDone();
+}
+
+void SessionReplay::End() {
+    if (m_session) m_session->SetTrace(nullptr);
+    m_session = nullptr;
+}
+
+ReplayCheck SessionReplay::Check() const {
+    ReplayCheck check;
+    check.recorded.settings = m_settings;
+    check.recorded.seed = m_header.seed;
+    check.recorded.hits = m_header.hits;
+    check.recorded.attempts = m_header.attempts;
+    check.recorded.avgReactionTime = m_header.avgReactionTime;
+    check.recorded.score = m_header.score;
+    check.sameRules = m_header.rulesVersion == FlicksSession::kRulesVersion;
+
+    std::vector<TraceEvent> replayed;
+    DecodeSessionTrace(m_output.GetData(), m_output.GetSize(), m_header.startTimeUs, replayed);
+
+    // Both sides went through the same encoding, so positions compare exactly
+    size_t r = 0;
+    int index = 0;
+    for (const TraceEvent& e : m_events) {
+        if (e.type == TRACE_MOVE) continue;
+        const bool same = r < replayed.size() &&
+            replayed[r].type == e.type && replayed[r].detail == e.detail && replayed[r].timeUs == e.timeUs &&
+            SameBits(replayed[r].x, e.x) && SameBits(replayed[r].y, e.y);
+        if (!same) {
+            check.firstMismatch = index;
+            break;
+        }
+        r++;
+        index++;
+    }
+    check.eventsMatch = check.firstMismatch < 0 && r == replayed.size() && !m_header.truncated;
+    check.resultMatch = m_finished &&
+        m_result.hits == m_header.hits && m_result.attempts == m_header.attempts &&
+        SameBits(m_result.avgReactionTime, m_header.avgReactionTime) && SameBits(m_result.score, m_header.score);
+    return check;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+
+#include "session.h"
+#include "session_trace.h"
+
+struct ReplayCheck {
+    bool eventsMatch = false;       // spawns, expiries and the end fell exactly where they were recorded
+    bool resultMatch = false;       // hits, attempts, reaction time and score are bit-identical to the recorded ones
+    int firstMismatch = -1;         // index into the recorded game events (moves excluded), -1 if none
+    bool sameRules = false;         // recorded under the current rules; games of other rules are expected to differ
+    GameResult recorded;            // as stored in the trace header
+};
+
+// Plays a recorded game back through FlicksSession. The seed regenerates the
+// targets and the recorded clicks are applied at their recorded times and
+// positions; everything else - spawns, expiries, hits and the score - is
+// recomputed by the current game code and checked against the recording.
+// Only games recorded under the current FlicksSession::kRulesVersion can match.
+// Times are on the clock the game was recorded with; callers pace playback
+// by how far they advance it.
+class SessionReplay {
+public:
+    bool Load(const char* path);
+    // A game recorded in memory, e.g. the one just played
+    bool Load(const SessionTrace& trace);
+
+    // Configures session for the recorded game and applies the start click.
+    // baseSettings supplies what the trace does not record, like colors.
+    bool Begin(FlicksSession& session, const GameSettings& baseSettings = GameSettings());
+    // Applies every recorded event up to timeUs. Returns true once the game has ended.
+    bool AdvanceTo(long long timeUs);
+    // As fast as possible, no pacing
+    bool Run() { return AdvanceTo(m_endTimeUs); }
+    // Detaches from the session; the result and Check() stay available
+    void End();
+    ReplayCheck Check() const;
+
+    bool IsActive() const { return m_session != nullptr; }
+    // The replayed game reached its end; GetResult() holds what the current code scores it
+    bool IsFinished() const { return m_finished; }
+    const GameResult& GetResult() const { return m_result; }
+    bool IsDone() const { return m_next >= m_events.size(); }
+    const TraceHeader& GetHeader() const { return m_header; }
+    const GameSettings& GetSettings() const { return m_settings; }
+    const FieldCache& GetField() const { return m_field; }
+    long long GetStartTimeUs() const { return m_header.startTimeUs; }
+    long long GetEndTimeUs() const { return m_endTimeUs; }
+    // Recorded mouse path: raw reports scaled to pixels, re-anchored at every click
+    ImVec2 GetCursorPos() const { return m_cursor; }
+
+private:
+    bool Decode(const uint8_t* data, size_t size);
+
+    TraceHeader m_header = {};
+    std::vector<TraceEvent> m_events;
+    long long m_endTimeUs = 0;
+    GameSettings m_settings;
+    FieldCache m_field;
+
+    FlicksSession* m_session = nullptr;
+    SessionTrace m_output{ 0 };
+    size_t m_next = 0;
+    ImVec2 m_cursor = ImVec2(0, 0);
+    bool m_finished = false;
+    GameResult m_result;
+};
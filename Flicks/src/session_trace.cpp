@@ -0,0 +1,216 @@
+#include "session_trace.h"
+#include "compat.h"
+#include "crc32.h"
+
+#include <cstring>
+#include <filesystem>
+
+namespace {
+    const char g_traceMagic[4] = { 'F', 'L', 'K', 'T' };
+    const uint32_t g_traceVersion = 2;
+    // A type byte and at least one byte of time step
+    const uint32_t g_minEventBytes = 2;
+
+    bool GetVarint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 64 && p < end; shift += 7) {
+            const uint8_t b = *p++;
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) return true;
+        }
+        return false;
+    }
+
+    bool GetZigzag(const uint8_t*& p, const uint8_t* end, int64_t& v) {
+        uint64_t u;
+        if (!GetVarint(p, end, u)) return false;
+        v = static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1);
+        return true;
+    }
+
+    // Round to the nearest 1/8 px without a libm call
+    int64_t Quantize(float v) {
+        const float scaled = v * SessionTrace::kPosScale;
+        return static_cast<int64_t>(scaled < 0.0f ? scaled - 0.5f : scaled + 0.5f);
+    }
+
+    bool GetExactPos(const uint8_t*& p, const uint8_t* end, float& x, float& y) {
+        if (end - p < 8) return false;
+        memcpy(&x, p, sizeof(x));
+        memcpy(&y, p + 4, sizeof(y));
+        p += 8;
+        return true;
+    }
+
+    bool GetPos(const uint8_t*& p, const uint8_t* end, float& x, float& y) {
+        int64_t qx, qy;
+        if (!GetZigzag(p, end, qx) || !GetZigzag(p, end, qy)) return false;
+        x = static_cast<float>(qx) / SessionTrace::kPosScale;
+        y = static_cast<float>(qy) / SessionTrace::kPosScale;
+        return true;
+    }
+}
+
+SessionTrace::SessionTrace(size_t capacityBytes)
+    : m_buffer(capacityBytes) {
+}
+
+void SessionTrace::Begin(uint64_t seed, const GameSettings& settings, const FieldCache& field, long long startTimeUs) {
+    Clear();
+    m_recording = true;
+    m_lastTimeUs = startTimeUs;
+
+    m_header = {};
+    memcpy(m_header.magic, g_traceMagic, sizeof(m_header.magic));
+    m_header.version = g_traceVersion;
+    m_header.rulesVersion = FlicksSession::kRulesVersion;
+    m_header.seed = seed;
+    m_header.startTimeUs = startTimeUs;
+    m_header.scale = settings.scale;
+    m_header.circleRadiusNorm = settings.circleRadiusNorm;
+    m_header.cursorRadiusNorm = settings.cursorRadiusNorm;
+    m_header.distanceRatio = settings.distanceRatio;
+    m_header.circleLifetimeMs = settings.circleLifetimeMs;
+    m_header.gameTimeSec = settings.gameTimeSec;
+    m_header.minSpawnDelayMs = settings.minSpawnDelayMs;
+    m_header.maxSpawnDelayMs = settings.maxSpawnDelayMs;
+    m_header.endBySpawnCount = settings.endBySpawnCount ? 1 : 0;
+    m_header.maxSpawnCount = settings.maxSpawnCount;
+    m_header.fieldSize = field.fieldSize;
+    m_header.centerX = field.center.x;
+    m_header.centerY = field.center.y;
+    m_header.circleRadiusPx = field.circleRadiusPx;
+    m_header.cursorRadiusPx = field.cursorRadiusPx;
+    m_header.spawnMaxRadius = field.spawnMaxRadius;
+    m_header.fieldLeft = field.fieldTL.x;
+    m_header.fieldTop = field.fieldTL.y;
+    m_header.mouseScale = m_mouseScale;
+}
+
+void SessionTrace::Clear() {
+    m_size = 0;
+    m_eventCount = 0;
+    m_recording = false;
+    m_truncated = false;
+}
+
+void SessionTrace::Record(TraceEventType type, uint8_t detail, long long timeUs, float x, float y) {
+    uint8_t* p = Reserve(type, detail, timeUs);
+    if (!p) return;
+    p = PutVarint(p, Zigzag(Quantize(x)));
+    p = PutVarint(p, Zigzag(Quantize(y)));
+    Commit(p);
+}
+
+void SessionTrace::RecordClick(float x, float y, int result, long long timeUs) {
+    uint8_t* p = Reserve(TRACE_CLICK, static_cast<uint8_t>(result), timeUs);
+    if (!p) return;
+    memcpy(p, &x, sizeof(x));
+    memcpy(p + 4, &y, sizeof(y));
+    Commit(p + 8);
+}
+
+void SessionTrace::RecordEnd(const GameResult& result, bool forced, long long timeUs) {
+    RecordTime(TRACE_END, forced ? 1 : 0, timeUs);
+    m_recording = false;
+
+    m_header.hits = result.hits;
+    m_header.attempts = result.attempts;
+    m_header.avgReactionTime = result.avgReactionTime;
+    m_header.score = result.score;
+    m_header.eventCount = m_eventCount;
+    m_header.eventBytes = static_cast<uint32_t>(m_size);
+    m_header.truncated = m_truncated ? 1 : 0;
+}
+
+bool SessionTrace::Write(const char* path) const {
+    TraceHeader header = m_header;
+    header.eventCount = m_eventCount;
+    header.eventBytes = static_cast<uint32_t>(m_size);
+    header.truncated = m_truncated ? 1 : 0;
+    header.eventCrc = Crc32(m_buffer.data(), m_size);
+
+    FILE* f;
+    if (fopen_s(&f, path, "wb") != 0) return false;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    if (ok && m_size > 0) ok = fwrite(m_buffer.data(), 1, m_size, f) == m_size;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+    return ok;
+}
+
+bool DecodeSessionTrace(const uint8_t* data, size_t size, long long startTimeUs, std::vector<TraceEvent>& events) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+    long long timeUs = startTimeUs;
+
+    while (p < end) {
+        TraceEvent e = {};
+        const uint8_t tag = *p++;
+        e.type = static_cast<TraceEventType>(tag & 0x0F);
+        e.detail = static_cast<uint8_t>(tag >> 4);
+
+        int64_t step;
+        if (!GetZigzag(p, end, step)) return false;
+        timeUs += step;
+        e.timeUs = timeUs;
+
+        bool ok = true;
+        switch (e.type) {
+        case TRACE_SPAWN:
+            ok = GetPos(p, end, e.x, e.y);
+            break;
+        case TRACE_CLICK:
+            ok = GetExactPos(p, end, e.x, e.y);
+            break;
+        case TRACE_MOVE: {
+            int64_t dx, dy;
+            ok = GetZigzag(p, end, dx) && GetZigzag(p, end, dy);
+            e.dx = static_cast<int>(dx);
+            e.dy = static_cast<int>(dy);
+            break;
+        }
+        case TRACE_EXPIRE:
+        case TRACE_END:
+        case TRACE_LAST:
+            break;
+        default:
+            ok = false;
+        }
+        if (!ok) return false;
+        events.push_back(e);
+    }
+    return true;
+}
+
+bool ReadSessionTrace(const char* path, TraceHeader& header, std::vector<TraceEvent>& events) {
+    FILE* f;
+    if (fopen_s(&f, path, "rb") != 0) return false;
+
+    // The header is not trusted with allocation sizes: the events have to
+    // be in the file, and each takes at least g_minEventBytes
+    std::error_code ec;
+    const uintmax_t fileSize = std::filesystem::file_size(path, ec);
+    std::vector<uint8_t> data;
+    bool ok = !ec && fread(&header, sizeof(header), 1, f) == 1 &&
+        memcmp(header.magic, g_traceMagic, sizeof(header.magic)) == 0 &&
+        header.version == g_traceVersion &&
+        header.eventBytes <= fileSize - sizeof(header) &&
+        header.eventCount <= header.eventBytes / g_minEventBytes;
+    if (ok) {
+        data.resize(header.eventBytes);
+        ok = data.empty() || fread(data.data(), 1, data.size(), f) == data.size();
+    }
+    fclose(f);
+
+    ok = ok && Crc32(data.data(), data.size()) == header.eventCrc;
+    if (!ok) return false;
+
+    events.clear();
+    events.reserve(header.eventCount);
+    return DecodeSessionTrace(data.data(), data.size(), header.startTimeUs, events) &&
+        events.size() == header.eventCount;
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "settings.h"
+#include "field.h"
+#include "session.h"
+
+enum TraceEventType : uint8_t {
+    TRACE_SPAWN = 1,    // x, y: target center
+    TRACE_EXPIRE,       // the target timed out
+    TRACE_MOVE,         // dx, dy: raw mouse counts
+    TRACE_CLICK,        // x, y: cursor, exact; detail: FlicksSession::ClickResult
+    TRACE_END,          // detail: 1 when the game was ended early
+    TRACE_LAST          // no target spawns after this; detail: 1 when the game was ended early
+};
+
+struct TraceEvent {
+    TraceEventType type;
+    uint8_t detail;
+    int dx;
+    int dy;
+    float x;
+    float y;
+    long long timeUs;
+};
+
+// Everything needed to interpret the events: the game as it started and the
+// field it was played on. Written ahead of the events, little-endian.
+struct TraceHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t eventCount;
+    uint32_t eventBytes;
+    uint32_t truncated;         // the buffer filled up; events after that were dropped
+    uint32_t eventCrc;          // CRC-32 of the encoded events
+    uint64_t seed;
+    int64_t startTimeUs;
+    float scale;
+    float circleRadiusNorm;
+    float cursorRadiusNorm;
+    float distanceRatio;
+    int32_t circleLifetimeMs;
+    int32_t gameTimeSec;
+    int32_t minSpawnDelayMs;
+    int32_t maxSpawnDelayMs;
+    int32_t endBySpawnCount;
+    int32_t maxSpawnCount;
+    float fieldSize;
+    float centerX;
+    float centerY;
+    float circleRadiusPx;
+    float cursorRadiusPx;
+    float spawnMaxRadius;
+    float fieldLeft;
+    float fieldTop;
+    float mouseScale;           // cursor pixels per raw mouse count
+    // The result as the game computed it, set when it ends
+    int32_t hits;
+    int32_t attempts;
+    float avgReactionTime;
+    float score;
+    uint32_t rulesVersion;      // FlicksSession::kRulesVersion of the game; 0 before it was recorded
+};
+static_assert(sizeof(TraceHeader) == 136, "trace headers are 136 bytes on disk");
+
+// Records every spawn, expiry, raw mouse report and click of one game.
+// Events are packed as a type byte, the zigzag varint time step from the
+// previous event and zigzag varint payload, into a buffer allocated once up
+// front: recording never allocates, and a game that outgrows the buffer keeps
+// its first events and is marked truncated. Spawn positions are stored in
+// 1/8 px since the seed regenerates them; click positions are stored exactly
+// so a replay judges every click as the game did.
+class SessionTrace {
+public:
+    // 16 MB covers the longest timed game (300 s) with an 8 kHz mouse
+    explicit SessionTrace(size_t capacityBytes = 16u << 20);
+
+    // Called by FlicksSession when a game starts; drops the previous game's events
+    void Begin(uint64_t seed, const GameSettings& settings, const FieldCache& field, long long startTimeUs);
+    void Clear();
+    // Converts raw counts to cursor pixels in the header; set by whoever feeds RecordMove
+    void SetMouseScale(float scale) { m_mouseScale = scale; }
+
+    void RecordSpawn(float x, float y, long long timeUs) { Record(TRACE_SPAWN, 0, timeUs, x, y); }
+    void RecordExpire(long long timeUs) { RecordTime(TRACE_EXPIRE, 0, timeUs); }
+    void RecordMove(int dx, int dy, long long timeUs) {
+        uint8_t* p = Reserve(TRACE_MOVE, 0, timeUs);
+        if (!p) return;
+        p = PutVarint(p, Zigzag(dx));
+        p = PutVarint(p, Zigzag(dy));
+        Commit(p);
+    }
+    void RecordClick(float x, float y, int result, long long timeUs);
+    void RecordLast(bool forced, long long timeUs) { RecordTime(TRACE_LAST, forced ? 1 : 0, timeUs); }
+    void RecordEnd(const GameResult& result, bool forced, long long timeUs);
+
+    // Between Begin() and the end of the game
+    bool IsRecording() const { return m_recording; }
+    bool IsTruncated() const { return m_truncated; }
+    uint32_t GetEventCount() const { return m_eventCount; }
+    size_t GetSize() const { return m_size; }
+    size_t GetCapacity() const { return m_buffer.size(); }
+    const TraceHeader& GetHeader() const { return m_header; }
+    const uint8_t* GetData() const { return m_buffer.data(); }
+
+    // Header followed by the encoded events. Only reads the trace, so a
+    // finished one can be written on another thread while it is replayed.
+    bool Write(const char* path) const;
+
+    // Encoded size limit of one event: type byte, 64-bit time step, two 32-bit varints
+    static constexpr size_t kMaxEventBytes = 1 + 10 + 5 + 5;
+    static constexpr float kPosScale = 8.0f;
+
+    static uint64_t Zigzag(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+    static uint8_t* PutVarint(uint8_t* p, uint64_t v) {
+        while (v >= 0x80) {
+            *p++ = static_cast<uint8_t>(v | 0x80);
+            v >>= 7;
+        }
+        *p++ = static_cast<uint8_t>(v);
+        return p;
+    }
+
+private:
+    uint8_t* Reserve(TraceEventType type, uint8_t detail, long long timeUs) {
+        if (!m_recording) return nullptr;
+        if (m_buffer.size() - m_size < kMaxEventBytes) {
+            m_truncated = true;
+            return nullptr;
+        }
+        uint8_t* p = m_buffer.data() + m_size;
+        *p++ = static_cast<uint8_t>(type | (detail << 4));
+        p = PutVarint(p, Zigzag(timeUs - m_lastTimeUs));
+        m_lastTimeUs = timeUs;
+        return p;
+    }
+    void Commit(uint8_t* end) {
+        m_size = static_cast<size_t>(end - m_buffer.data());
+        m_eventCount++;
+    }
+    void RecordTime(TraceEventType type, uint8_t detail, long long timeUs) {
+        if (uint8_t* p = Reserve(type, detail, timeUs)) Commit(p);
+    }
+    void Record(TraceEventType type, uint8_t detail, long long timeUs, float x, float y);
+
+    std::vector<uint8_t> m_buffer;
+    size_t m_size = 0;
+    uint32_t m_eventCount = 0;
+    long long m_lastTimeUs = 0;
+    bool m_recording = false;
+    bool m_truncated = false;
+    float m_mouseScale = 1.0f;
+    TraceHeader m_header = {};
+};
+
+// Decodes events encoded by SessionTrace; false when the data is malformed
+bool DecodeSessionTrace(const uint8_t* data, size_t size, long long startTimeUs, std::vector<TraceEvent>& events);
+// Reads and checks a trace file written by SessionTrace::Write
+bool ReadSessionTrace(const char* path, TraceHeader& header, std::vector<TraceEvent>& events);
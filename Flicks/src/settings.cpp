@@ -0,0 +1,117 @@
+#include "settings.h"
+#include "compat.h"
+
+void SaveColorSettings(const GameSettings& settings, const char* path) {
+    FILE* f;
+    if (fopen_s(&f, path, "w") == 0) {
+        fprintf(f, "bgColor=%.3f,%.3f,%.3f,%.3f\n",
+            settings.bgColor.x, settings.bgColor.y, settings.bgColor.z, settings.bgColor.w);
+        fprintf(f, "fieldColor=%.3f,%.3f,%.3f,%.3f\n",
+            settings.fieldColor.x, settings.fieldColor.y, settings.fieldColor.z, settings.fieldColor.w);
+        fprintf(f, "circleColor=%.3f,%.3f,%.3f,%.3f\n",
+            settings.circleColor.x, settings.circleColor.y, settings.circleColor.z, settings.circleColor.w);
+        fprintf(f, "cursorColor=%.3f,%.3f,%.3f,%.3f\n",
+            settings.cursorColor.x, settings.cursorColor.y, settings.cursorColor.z, settings.cursorColor.w);
+        fprintf(f, "cursorThickness=%.3f\n", settings.cursorThickness);
+        fprintf(f, "cursorOutlineColor=%.3f,%.3f,%.3f,%.3f\n",
+            settings.cursorOutlineColor.x, settings.cursorOutlineColor.y,
+            settings.cursorOutlineColor.z, settings.cursorOutlineColor.w);
+        fprintf(f, "useCustomCursor=%d\n", settings.useCustomCursor ? 1 : 0);
+        fprintf(f, "scale=%.3f\n", settings.scale);
+        fprintf(f, "circleRadiusNorm=%.3f\n", settings.circleRadiusNorm);
+        fprintf(f, "cursorRadiusNorm=%.3f\n", settings.cursorRadiusNorm);
+        fprintf(f, "circleLifetimeMs=%d\n", settings.circleLifetimeMs);
+        fprintf(f, "gameTimeSec=%d\n", settings.gameTimeSec);
+        fprintf(f, "minSpawnDelayMs=%d\n", settings.minSpawnDelayMs);
+        fprintf(f, "maxSpawnDelayMs=%d\n", settings.maxSpawnDelayMs);
+        fprintf(f, "endBySpawnCount=%d\n", settings.endBySpawnCount ? 1 : 0);
+        fprintf(f, "maxSpawnCount=%d\n", settings.maxSpawnCount);
+
+        fprintf(f, "frameLatency=%d\n", settings.frameLatency);
+        fprintf(f, "framePacing=%d\n", settings.framePacing);
+        fprintf(f, "frameCapFps=%d\n", settings.frameCapFps);
+        fprintf(f, "lateInputLatch=%d\n", settings.lateInputLatch ? 1 : 0);
+        fprintf(f, "recordTraces=%d\n", settings.recordTraces ? 1 : 0);
+
+        fclose(f);
+    }
+}
+
+void LoadColorSettings(GameSettings& settings, const char* path) {
+    FILE* f;
+    if (fopen_s(&f, path, "r") == 0) {
+        char line[256];
+        while (fgets(line, sizeof(line), f)) {
+            float r, g, b, a;
+            float thickness;
+            float scaleValue;
+            int useCustom;
+            int intVal;
+            if (sscanf_s(line, "bgColor=%f,%f,%f,%f", &r, &g, &b, &a) == 4) {
+                settings.bgColor = ImVec4(r, g, b, a);
+            }
+            else if (sscanf_s(line, "fieldColor=%f,%f,%f,%f", &r, &g, &b, &a) == 4) {
+                settings.fieldColor = ImVec4(r, g, b, a);
+            }
+            else if (sscanf_s(line, "circleColor=%f,%f,%f,%f", &r, &g, &b, &a) == 4) {
+                settings.circleColor = ImVec4(r, g, b, a);
+            }
+            else if (sscanf_s(line, "cursorColor=%f,%f,%f,%f", &r, &g, &b, &a) == 4) {
+                settings.cursorColor = ImVec4(r, g, b, a);
+            }
+            if (sscanf_s(line, "cursorThickness=%f", &thickness) == 1) {
+                settings.cursorThickness = thickness;
+            }
+            else if (sscanf_s(line, "cursorOutlineColor=%f,%f,%f,%f", &r, &g, &b, &a) == 4) {
+                settings.cursorOutlineColor = ImVec4(r, g, b, a);
+            }
+            else if (sscanf_s(line, "useCustomCursor=%d", &useCustom) == 1) {
+                settings.useCustomCursor = (useCustom != 0);
+            }
+            else if (sscanf_s(line, "scale=%f", &scaleValue) == 1) {
+                settings.scale = scaleValue;
+            }
+            else if (sscanf_s(line, "circleRadiusNorm=%f", &scaleValue) == 1) {
+                settings.circleRadiusNorm = scaleValue;
+            }
+            else if (sscanf_s(line, "cursorRadiusNorm=%f", &scaleValue) == 1) {
+                settings.cursorRadiusNorm = scaleValue;
+            }
+            else if (sscanf_s(line, "circleLifetimeMs=%d", &intVal) == 1) {
+                settings.circleLifetimeMs = intVal;
+            }
+            else if (sscanf_s(line, "gameTimeSec=%d", &intVal) == 1) {
+                settings.gameTimeSec = intVal;
+            }
+            else if (sscanf_s(line, "minSpawnDelayMs=%d", &intVal) == 1) {
+                settings.minSpawnDelayMs = intVal;
+            }
+            else if (sscanf_s(line, "maxSpawnDelayMs=%d", &intVal) == 1) {
+                settings.maxSpawnDelayMs = intVal;
+            }
+            else if (sscanf_s(line, "endBySpawnCount=%d", &intVal) == 1) {
+                settings.endBySpawnCount = (intVal != 0);
+            }
+            else if (sscanf_s(line, "maxSpawnCount=%d", &intVal) == 1) {
+                settings.maxSpawnCount = intVal;
+            }
+
+            else if (sscanf_s(line, "frameLatency=%d", &intVal) == 1) {
+                settings.frameLatency = intVal;
+            }
+            else if (sscanf_s(line, "framePacing=%d", &intVal) == 1) {
+                settings.framePacing = intVal;
+            }
+            else if (sscanf_s(line, "frameCapFps=%d", &intVal) == 1) {
+                settings.frameCapFps = intVal;
+            }
+            else if (sscanf_s(line, "lateInputLatch=%d", &intVal) == 1) {
+                settings.lateInputLatch = (intVal != 0);
+            }
+            else if (sscanf_s(line, "recordTraces=%d", &intVal) == 1) {
+                settings.recordTraces = (intVal != 0);
+            }
+        }
+        fclose(f);
+    }
+}
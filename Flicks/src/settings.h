@@ -0,0 +1,37 @@
+#pragma once
+
+#include <imgui.h>
+
+struct GameSettings {
+    ImVec4 bgColor = ImVec4(0.2f, 0.2f, 0.2f, 1.0f);
+    ImVec4 fieldColor = ImVec4(0.1f, 0.1f, 0.1f, 1.0f);
+    ImVec4 circleColor = ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
+    ImVec4 cursorColor = ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
+    float cursorThickness = 0.0f;
+    ImVec4 cursorOutlineColor = ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
+    bool useCustomCursor = true;
+
+    float scale = 0.9f;
+    float circleRadiusNorm = 0.112f;
+    float cursorRadiusNorm = 0.015f;
+
+    int circleLifetimeMs = 250;
+    int gameTimeSec = 60;
+    float distanceRatio = 0.2f;
+
+    int minSpawnDelayMs = 0;
+    int maxSpawnDelayMs = 0;
+
+    bool endBySpawnCount = false;
+    int maxSpawnCount = 0;
+
+    unsigned int frameLatency = 1;
+    int framePacing = 1;        // FramePacing, PACING_WAITABLE
+    int frameCapFps = 240;
+    bool lateInputLatch = true;
+
+    bool recordTraces = true;
+};
+
+void SaveColorSettings(const GameSettings& settings, const char* path = "res/cfg.ini");
+void LoadColorSettings(GameSettings& settings, const char* path = "res/cfg.ini");
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include "rng.h"
+#include "session.h"
+#include "settings.h"
+
+// Games are only compared with games played under the same rules. The key
+// folds those rules into 64 bits; radii count to a thousandth, the precision
+// the old CSV kept.
+inline uint64_t MakeSettingsKey(float circleRadiusNorm, float cursorRadiusNorm, int circleLifetimeMs, int gameTimeSec,
+    int minSpawnDelayMs, int maxSpawnDelayMs, bool endBySpawnCount, int maxSpawnCount) {
+    const int64_t fields[] = {
+        std::llround(circleRadiusNorm * 1000.0f),
+        std::llround(cursorRadiusNorm * 1000.0f),
+        circleLifetimeMs,
+        gameTimeSec,
+        minSpawnDelayMs,
+        maxSpawnDelayMs,
+        endBySpawnCount ? 1 : 0,
+        endBySpawnCount ? maxSpawnCount : 0,
+    };
+
+    uint64_t key = 0;
+    for (int64_t field : fields) {
+        uint64_t state = key ^ static_cast<uint64_t>(field);
+        key = SplitMix64(state);
+    }
+    return key;
+}
+
+inline uint64_t MakeSettingsKey(const GameSettings& s) {
+    return MakeSettingsKey(s.circleRadiusNorm, s.cursorRadiusNorm, s.circleLifetimeMs, s.gameTimeSec,
+        s.minSpawnDelayMs, s.maxSpawnDelayMs, s.endBySpawnCount, s.maxSpawnCount);
+}
+
+inline uint64_t MakeSettingsKey(const GameSummary& s) {
+    return MakeSettingsKey(s.circleRadiusNorm, s.cursorRadiusNorm, s.circleLifetimeMs, s.gameTimeSec,
+        s.minSpawnDelayMs, s.maxSpawnDelayMs, s.endBySpawnCount, s.maxSpawnCount);
+}
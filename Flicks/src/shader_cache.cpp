@@ -0,0 +1,58 @@
+#include "shader_cache.h"
+#include "compat.h"
+
+#include <filesystem>
+#include <string>
+
+namespace {
+    std::string CachePath(const char* dir, const char* name, uint64_t hash) {
+        char file[96];
+        snprintf(file, sizeof(file), "/%s_%016llx.cso", name, static_cast<unsigned long long>(hash));
+        return std::string(dir) + file;
+    }
+}
+
+uint64_t HashShaderSource(const void* source, size_t size, const char* target) {
+    // FNV-1a over the source, then the target it is compiled for
+    uint64_t hash = 0xcbf29ce484222325ull;
+    const unsigned char* p = static_cast<const unsigned char*>(source);
+    for (size_t i = 0; i < size; ++i) hash = (hash ^ p[i]) * 0x100000001b3ull;
+    for (const char* t = target; *t; ++t) hash = (hash ^ static_cast<unsigned char>(*t)) * 0x100000001b3ull;
+    return hash;
+}
+
+bool ReadFileBytes(const char* path, std::vector<uint8_t>& bytes) {
+    std::error_code ec;
+    const uintmax_t size = std::filesystem::file_size(path, ec);
+    if (ec) return false;
+
+    FILE* f;
+    if (fopen_s(&f, path, "rb") != 0) return false;
+    bytes.resize(static_cast<size_t>(size));
+    const bool ok = size == 0 || fread(bytes.data(), bytes.size(), 1, f) == 1;
+    fclose(f);
+    if (!ok) bytes.clear();
+    return ok;
+}
+
+bool LoadCachedShader(const char* dir, const char* name, uint64_t hash, std::vector<uint8_t>& bytecode) {
+    return ReadFileBytes(CachePath(dir, name, hash).c_str(), bytecode) && !bytecode.empty();
+}
+
+bool StoreCachedShader(const char* dir, const char* name, uint64_t hash, const void* bytecode, size_t size) {
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    const std::string path = CachePath(dir, name, hash);
+    const std::string tempPath = path + ".tmp";
+
+    FILE* f;
+    if (fopen_s(&f, tempPath.c_str(), "wb") != 0) return false;
+    bool ok = fwrite(bytecode, size, 1, f) == 1;
+    ok = (fclose(f) == 0) && ok;
+    if (ok) std::filesystem::rename(tempPath, path, ec);
+    if (!ok || ec) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Release builds draw with the bytecode fxc embedded at build time. Dev
+// builds compile shaders/*.hlsl at startup, so a shader edit shows on the
+// next run, and keep the bytecode on disk under a hash of the source and
+// target: only shaders that changed are compiled again.
+
+uint64_t HashShaderSource(const void* source, size_t size, const char* target);
+bool ReadFileBytes(const char* path, std::vector<uint8_t>& bytes);
+// <dir>/<name>_<hash>.cso; false if there is none
+bool LoadCachedShader(const char* dir, const char* name, uint64_t hash, std::vector<uint8_t>& bytecode);
+// Creates dir if needed and writes through a temporary file, so a reader never sees half a shader
+bool StoreCachedShader(const char* dir, const char* name, uint64_t hash, const void* bytecode, size_t size);
@@ -0,0 +1,7 @@
+#pragma once
+
+// SSE2 is part of x86-64 and of 32-bit MSVC builds with /arch:SSE2 or higher;
+// everything else takes the scalar paths
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLICKS_SSE2 1
+#endif
@@ -0,0 +1,65 @@
+#include "simulate.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    long long SampleReactionUs(const SimPlayer& player, Rng& rng) {
+        float reaction = player.reactionMs;
+        if (player.reactionSdMs > 0.0f) {
+            reaction = rng.NextNormal(player.reactionMs, player.reactionSdMs);
+        }
+        return std::llround(std::max(reaction, player.minReactionMs) * 1000.0f);
+    }
+
+    ImVec2 SampleAimPoint(ImVec2 target, float hitRadius, const SimPlayer& player, Rng& rng) {
+        if (player.missRate > 0.0f && rng.NextFloat() < player.missRate) {
+            // Overshoot: land just outside the hit radius
+            float t = rng.NextFloat() * 2.0f * 3.1415926535f;
+            float r = hitRadius * (1.05f + rng.NextFloat());
+            return ImVec2(target.x + r * std::cos(t), target.y + r * std::sin(t));
+        }
+        if (player.aimSpread <= 0.0f) return target;
+
+        const float sd = player.aimSpread * hitRadius;
+        float dx = rng.NextNormal(0.0f, sd);
+        float dy = rng.NextNormal(0.0f, sd);
+        return ImVec2(target.x + dx, target.y + dy);
+    }
+}
+
+const GameResult& SimulateSession(FlicksSession& session, const SimPlayer& player, Rng& rng) {
+    const FieldCache& field = session.GetField();
+    const float hitRadius = field.circleRadiusPx + field.cursorRadiusPx;
+    const long long correctionUs = std::max(1LL, std::llround(player.correctionMs * 1000.0f));
+
+    long long nowUs = 0;
+    long long clickUs = 0;
+    int plannedSpawn = -1;
+
+    session.Reset();
+    session.Click(field.center.x, field.center.y, nowUs);
+
+    while (session.GetState() == GAME_RUNNING) {
+        long long nextUs = session.GetNextEventTimeUs();
+
+        if (session.IsCircleActive()) {
+            if (session.GetSpawnCount() != plannedSpawn) {
+                plannedSpawn = session.GetSpawnCount();
+                clickUs = session.GetCircleSpawnTimeUs() + SampleReactionUs(player, rng);
+            }
+            if (clickUs < nextUs) {
+                nowUs = std::max(nowUs, clickUs);
+                session.Tick(nowUs);
+                ImVec2 aim = SampleAimPoint(session.GetCirclePos(), hitRadius, player, rng);
+                if (session.Click(aim.x, aim.y, nowUs) == FlicksSession::CLICK_MISS) {
+                    clickUs = nowUs + correctionUs;
+                }
+                continue;
+            }
+        }
+
+        nowUs = std::max(nowUs, nextUs);
+        session.Tick(nowUs);
+    }
+    return session.GetResult();
+}
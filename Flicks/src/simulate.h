@@ -0,0 +1,18 @@
+#pragma once
+
+#include "session.h"
+
+// Synthetic player for headless runs. Each target gets one reaction-timed flick;
+// flicks that land off the target are followed by corrections until it expires.
+struct SimPlayer {
+    float reactionMs = 200.0f;      // mean time from spawn to the first click
+    float reactionSdMs = 0.0f;      // normal spread of the reaction time
+    float minReactionMs = 80.0f;    // reaction times are clamped to this floor
+    float aimSpread = 0.0f;         // normal spread of the landing point, in hit radii
+    float missRate = 0.0f;          // chance a flick lands off the target regardless of aim
+    float correctionMs = 80.0f;     // time from a missed click to the next one
+};
+
+// Plays one full game from the start click to the end condition, jumping straight
+// between events instead of stepping at frame rate. rng drives the player only.
+const GameResult& SimulateSession(FlicksSession& session, const SimPlayer& player, Rng& rng);
@@ -0,0 +1,234 @@
+#include "soft_renderer.h"
+#include "compat.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#ifdef FLICKS_SSE2
+#include <emmintrin.h>
+#endif
+
+// Both paths evaluate the same float expressions in the same order (no FMA,
+// truncation after +0.5), so SSE2 and scalar frames are bit-identical.
+namespace {
+    struct SourceColor {
+        float rgb[3];   // 0..255
+        float a;        // 0..1
+    };
+
+    SourceColor MakeSource(const ImVec4& color) {
+        SourceColor s;
+        s.rgb[0] = std::clamp(color.x, 0.0f, 1.0f) * 255.0f;
+        s.rgb[1] = std::clamp(color.y, 0.0f, 1.0f) * 255.0f;
+        s.rgb[2] = std::clamp(color.z, 0.0f, 1.0f) * 255.0f;
+        s.a = std::clamp(color.w, 0.0f, 1.0f);
+        return s;
+    }
+
+    uint32_t ToUnorm(float v255) {
+        return static_cast<uint32_t>(static_cast<int>(v255 + 0.5f));
+    }
+
+    // SRC_ALPHA / INV_SRC_ALPHA on color, ONE / ZERO on alpha
+    uint32_t BlendPixel(uint32_t dst, const SourceColor& src, float a) {
+        const float ia = 1.0f - a;
+        const float r = src.rgb[0] * a + static_cast<float>(dst & 0xff) * ia;
+        const float g = src.rgb[1] * a + static_cast<float>((dst >> 8) & 0xff) * ia;
+        const float b = src.rgb[2] * a + static_cast<float>((dst >> 16) & 0xff) * ia;
+        return ToUnorm(r) | (ToUnorm(g) << 8) | (ToUnorm(b) << 16) | (ToUnorm(255.0f * a) << 24);
+    }
+
+    float CircleAlpha(float dx, float dy2, float radius, float feather, float colorAlpha) {
+        const float dist = std::sqrt(dx * dx + dy2);
+        float t = (radius - dist) / feather;
+        t = t > 0.0f ? t : 0.0f;
+        t = t < 1.0f ? t : 1.0f;
+        return t * colorAlpha;
+    }
+
+#ifdef FLICKS_SSE2
+    // Per-pixel blend factors: sa = (r, g, b, 255) * a and ia = 1 - a, one
+    // register per pixel so a constant-alpha fill can build them once
+    struct BlendFactors4 {
+        __m128 sa[4];
+        __m128 ia[4];
+    };
+
+    BlendFactors4 MakeFactors4(const SourceColor& src, __m128 a) {
+        const __m128 source = _mm_set_ps(255.0f, src.rgb[2], src.rgb[1], src.rgb[0]);
+        const __m128 one = _mm_set1_ps(1.0f);
+        BlendFactors4 f;
+        f.sa[0] = _mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0));
+        f.sa[1] = _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1));
+        f.sa[2] = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2));
+        f.sa[3] = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3));
+        for (int i = 0; i < 4; ++i) {
+            f.ia[i] = _mm_sub_ps(one, f.sa[i]);
+            f.sa[i] = _mm_mul_ps(source, f.sa[i]);
+        }
+        return f;
+    }
+
+    void BlendPixels4(uint32_t* px, const BlendFactors4& f) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128 half = _mm_set1_ps(0.5f);
+
+        // Zeroing the destination alpha leaves 255 * a in the alpha lane
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(px));
+        d = _mm_and_si128(d, _mm_set1_epi32(0x00ffffff));
+        const __m128i lo = _mm_unpacklo_epi8(d, zero);
+        const __m128i hi = _mm_unpackhi_epi8(d, zero);
+        const __m128i dst[4] = {
+            _mm_unpacklo_epi16(lo, zero),
+            _mm_unpackhi_epi16(lo, zero),
+            _mm_unpacklo_epi16(hi, zero),
+            _mm_unpackhi_epi16(hi, zero),
+        };
+
+        __m128i out[4];
+        for (int i = 0; i < 4; ++i) {
+            __m128 v = _mm_add_ps(f.sa[i], _mm_mul_ps(_mm_cvtepi32_ps(dst[i]), f.ia[i]));
+            out[i] = _mm_cvttps_epi32(_mm_add_ps(v, half));
+        }
+        const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(out[0], out[1]), _mm_packs_epi32(out[2], out[3]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(px), packed);
+    }
+#endif
+}
+
+SoftRenderer::SoftRenderer(int width, int height) {
+    Resize(width, height);
+}
+
+void SoftRenderer::Resize(int width, int height) {
+    m_width = std::max(0, width);
+    m_height = std::max(0, height);
+    m_pixels.assign(static_cast<size_t>(m_width) * m_height, 0);
+}
+
+void SoftRenderer::BeginFrame(const float clearColor[4]) {
+    uint32_t packed = 0;
+    for (int c = 0; c < 4; ++c) {
+        packed |= ToUnorm(std::clamp(clearColor[c], 0.0f, 1.0f) * 255.0f) << (8 * c);
+    }
+    std::fill(m_pixels.begin(), m_pixels.end(), packed);
+}
+
+void SoftRenderer::CoveredRange(float from, float to, int size, int& begin, int& end) const {
+    // Pixel i is covered when its center i + 0.5 lies in [from, to)
+    begin = static_cast<int>(std::max(0.0f, std::ceil(from - 0.5f)));
+    end = static_cast<int>(std::min(static_cast<float>(size), std::max(0.0f, std::ceil(to - 0.5f))));
+    if (end < begin) end = begin;
+}
+
+void SoftRenderer::FillRect(float x0, float y0, float x1, float y1, const ImVec4& color) {
+    int xb, xe, yb, ye;
+    CoveredRange(x0, x1, m_width, xb, xe);
+    CoveredRange(y0, y1, m_height, yb, ye);
+    const SourceColor src = MakeSource(color);
+
+    for (int y = yb; y < ye; ++y) {
+        uint32_t* row = m_pixels.data() + static_cast<size_t>(y) * m_width;
+        int x = xb;
+#ifdef FLICKS_SSE2
+        if (m_vectorized) {
+            const BlendFactors4 factors = MakeFactors4(src, _mm_set1_ps(src.a));
+            for (; x + 4 <= xe; x += 4) BlendPixels4(row + x, factors);
+        }
+#endif
+        for (; x < xe; ++x) row[x] = BlendPixel(row[x], src, src.a);
+    }
+}
+
+void SoftRenderer::DrawField(const FieldCache& fieldCache, const ImVec4& fieldColor) {
+    FillRect(fieldCache.fieldTL.x, fieldCache.fieldTL.y,
+        fieldCache.fieldTL.x + fieldCache.fieldSize, fieldCache.fieldTL.y + fieldCache.fieldSize, fieldColor);
+}
+
+void SoftRenderer::DrawCircle(const ImVec2& center, float radius, const ImVec4& color, float feather) {
+    int qxb, qxe, qyb, qye;
+    CoveredRange(center.x - radius, center.x + radius, m_width, qxb, qxe);
+    CoveredRange(center.y - radius, center.y + radius, m_height, qyb, qye);
+    const SourceColor src = MakeSource(color);
+    const float r2 = radius * radius;
+
+    for (int y = qyb; y < qye; ++y) {
+        uint32_t* row = m_pixels.data() + static_cast<size_t>(y) * m_width;
+        const float dy = static_cast<float>(y) + 0.5f - center.y;
+        const float dy2 = dy * dy;
+
+        // Outside the circle the shader outputs alpha 0: color stays, alpha is
+        // overwritten with 0. Only the span that can be inside needs shading.
+        int sxb = qxb, sxe = qxe;
+        if (feather > 0.0f) {
+            const float h2 = r2 - dy2;
+            if (h2 <= 0.0f) {
+                sxb = sxe = qxb;
+            }
+            else {
+                const float h = std::sqrt(h2);
+                CoveredRange(center.x - h - 1.0f, center.x + h + 1.0f, m_width, sxb, sxe);
+                sxb = std::clamp(sxb, qxb, qxe);
+                sxe = std::clamp(sxe, sxb, qxe);
+            }
+        }
+        for (int x = qxb; x < sxb; ++x) row[x] &= 0x00ffffffu;
+        for (int x = sxe; x < qxe; ++x) row[x] &= 0x00ffffffu;
+
+        int x = sxb;
+#ifdef FLICKS_SSE2
+        if (m_vectorized) {
+            const __m128 cx = _mm_set1_ps(center.x);
+            const __m128 half = _mm_set1_ps(0.5f);
+            const __m128 dy2v = _mm_set1_ps(dy2);
+            const __m128 rv = _mm_set1_ps(radius);
+            const __m128 fv = _mm_set1_ps(feather);
+            const __m128 cav = _mm_set1_ps(src.a);
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one = _mm_set1_ps(1.0f);
+            for (; x + 4 <= sxe; x += 4) {
+                __m128 px = _mm_add_ps(_mm_cvtepi32_ps(_mm_set_epi32(x + 3, x + 2, x + 1, x)), half);
+                __m128 dx = _mm_sub_ps(px, cx);
+                __m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), dy2v));
+                __m128 t = _mm_div_ps(_mm_sub_ps(rv, dist), fv);
+                t = _mm_min_ps(_mm_max_ps(t, zero), one);
+                BlendPixels4(row + x, MakeFactors4(src, _mm_mul_ps(t, cav)));
+            }
+        }
+#endif
+        for (; x < sxe; ++x) {
+            const float dx = (static_cast<float>(x) + 0.5f) - center.x;
+            row[x] = BlendPixel(row[x], src, CircleAlpha(dx, dy2, radius, feather, src.a));
+        }
+    }
+}
+
+uint64_t SoftRenderer::Hash() const {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (uint32_t px : m_pixels) {
+        for (int c = 0; c < 4; ++c) {
+            hash ^= (px >> (8 * c)) & 0xff;
+            hash *= 0x100000001b3ull;
+        }
+    }
+    return hash;
+}
+
+bool SoftRenderer::WritePpm(const char* path) const {
+    FILE* f;
+    if (fopen_s(&f, path, "wb") != 0) return false;
+
+    fprintf(f, "P6\n%d %d\n255\n", m_width, m_height);
+    std::vector<unsigned char> row(static_cast<size_t>(m_width) * 3);
+    for (int y = 0; y < m_height; ++y) {
+        const uint32_t* src = m_pixels.data() + static_cast<size_t>(y) * m_width;
+        for (int x = 0; x < m_width; ++x) {
+            row[x * 3 + 0] = static_cast<unsigned char>(src[x] & 0xff);
+            row[x * 3 + 1] = static_cast<unsigned char>((src[x] >> 8) & 0xff);
+            row[x * 3 + 2] = static_cast<unsigned char>((src[x] >> 16) & 0xff);
+        }
+        fwrite(row.data(), 1, row.size(), f);
+    }
+    fclose(f);
+    return true;
+}
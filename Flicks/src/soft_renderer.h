@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "render_backend.h"
+#include "simd.h"
+
+// CPU rasterizer that reproduces the D3D11 renderer into an RGBA8 buffer
+// (byte order R, G, B, A like DXGI_FORMAT_R8G8B8A8_UNORM): the same pixel
+// center coverage, the feathered circle shader and SRC_ALPHA blending with
+// the destination alpha replaced by the source alpha. Used headlessly to dump
+// and hash frames and to benchmark fill rate.
+class SoftRenderer : public RenderBackend {
+public:
+    SoftRenderer(int width, int height);
+
+    void Resize(int width, int height);
+    // Benchmarks switch the SSE2 path off to measure the scalar one; both give identical pixels
+    void SetVectorized(bool vectorized) { m_vectorized = vectorized; }
+
+    void BeginFrame(const float clearColor[4]) override;
+    void EndFrame() override {}
+
+    void DrawField(const FieldCache& fieldCache, const ImVec4& fieldColor) override;
+    void BeginCircleRendering() override {}
+    void DrawCircle(const ImVec2& center, float radius, const ImVec4& color, float feather = 1.0f) override;
+    void EndCircleRendering() override {}
+
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    const uint32_t* GetPixels() const { return m_pixels.data(); }
+
+    // FNV-1a over the pixel bytes, for golden-image comparisons
+    uint64_t Hash() const;
+    // Binary PPM (RGB, alpha dropped)
+    bool WritePpm(const char* path) const;
+
+private:
+    // Pixel columns/rows whose centers fall in [from, to), clipped to the target
+    void CoveredRange(float from, float to, int size, int& begin, int& end) const;
+    void FillRect(float x0, float y0, float x1, float y1, const ImVec4& color);
+
+    int m_width = 0;
+    int m_height = 0;
+    bool m_vectorized = true;
+    std::vector<uint32_t> m_pixels;
+};
@@ -0,0 +1,283 @@
+#include "spawn_sampler.h"
+#include <algorithm>
+#include <cmath>
+
+#include "portable_math.h"
+
+#ifdef FLICKS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+    const float kTwoPi = 2.0f * portable::kPi;
+    const int kPolarAttempts = 50;
+    const int kMaxBatches = 16;     // 64 candidates, enough for ratios up to ~0.6 nearly always
+    const int kAnalyticBins = 32;
+    const int kAnalyticTries = 16;  // each accepts with probability well over 1/2
+
+    uint32_t Rotl(uint32_t x, int k) {
+        return (x << k) | (x >> (32 - k));
+    }
+
+    // Maps the top 24 bits to [-1, 1)
+    float ToSigned(uint32_t u) {
+        return static_cast<float>(static_cast<int32_t>(u >> 8)) * (1.0f / 8388608.0f) - 1.0f;
+    }
+
+    // Angular width of the circle of radius rho around a point at distance l from
+    // the origin that lies inside the unit disk
+    float ArcWidth(float l, float rho) {
+        if (l < 1e-6f) return rho <= 1.0f ? kTwoPi : 0.0f;
+        float c = (1.0f - l * l - rho * rho) / (2.0f * l * rho);
+        if (c >= 1.0f) return kTwoPi;
+        if (c <= -1.0f) return 0.0f;
+        return kTwoPi - 2.0f * portable::Acos(c);
+    }
+
+    int FirstLane(int mask) {
+        int lane = 0;
+        while (!(mask & 1)) {
+            mask >>= 1;
+            lane++;
+        }
+        return lane;
+    }
+}
+
+void RngX4::Seed(uint64_t seed, uint64_t stream) {
+    uint64_t sm = seed ^ (stream * 0xd1342543de82ef95ull);
+    for (int lane = 0; lane < 4; ++lane) {
+        uint64_t a = SplitMix64(sm);
+        uint64_t b = SplitMix64(sm);
+        s[0][lane] = static_cast<uint32_t>(a);
+        s[1][lane] = static_cast<uint32_t>(a >> 32);
+        s[2][lane] = static_cast<uint32_t>(b);
+        s[3][lane] = static_cast<uint32_t>(b >> 32);
+    }
+}
+
+void RngX4::Next(uint32_t out[4]) {
+    for (int lane = 0; lane < 4; ++lane) {
+        out[lane] = Rotl(s[1][lane] * 5, 7) * 9;
+        const uint32_t t = s[1][lane] << 9;
+        s[2][lane] ^= s[0][lane];
+        s[3][lane] ^= s[1][lane];
+        s[1][lane] ^= s[2][lane];
+        s[0][lane] ^= s[3][lane];
+        s[2][lane] ^= t;
+        s[3][lane] = Rotl(s[3][lane], 11);
+    }
+}
+
+void SpawnSampler::Seed(uint64_t seed, uint64_t stream) {
+    m_lanes.Seed(seed, stream);
+    m_rng.Seed(seed, stream + 0x100);
+}
+
+bool SpawnSampler::Sample(float lastX, float lastY, float minDistance, bool first, float& x, float& y) {
+    if (first) minDistance = 0.0f;
+
+    switch (m_kind) {
+    case SPAWN_SAMPLER_POLAR:
+        return SamplePolar(lastX, lastY, minDistance, first, x, y);
+    case SPAWN_SAMPLER_ANALYTIC:
+        return SampleAnalytic(lastX, lastY, minDistance, x, y);
+    case SPAWN_SAMPLER_BATCH:
+    default:
+        if (SampleBatch(lastX, lastY, minDistance * minDistance, x, y)) return true;
+        return SampleAnalytic(lastX, lastY, minDistance, x, y);
+    }
+}
+
+bool SpawnSampler::SamplePolar(float lastX, float lastY, float minDistance, bool first, float& x, float& y) {
+    const float minDistanceSq = minDistance * minDistance;
+    int attempts = 0;
+    float dx, dy;
+    do {
+        float t = m_rng.NextFloat(0.0f, kTwoPi);
+        float r = std::sqrt(m_rng.NextFloat());
+        float s, c;
+        portable::SinCos(t, s, c);
+        x = r * c;
+        y = r * s;
+        dx = x - lastX;
+        dy = y - lastY;
+        attempts++;
+    } while (!first &&
+        attempts < kPolarAttempts &&
+        dx * dx + dy * dy < minDistanceSq);
+
+    if (!first && dx * dx + dy * dy < minDistanceSq) {
+        x = 0.0f;
+        y = 0.0f;
+        return false;
+    }
+    return true;
+}
+
+bool SpawnSampler::SampleBatch(float lastX, float lastY, float minDistanceSq, float& x, float& y) {
+#ifdef FLICKS_SSE2
+    if (m_vectorized) return SampleBatchSse2(lastX, lastY, minDistanceSq, x, y);
+#endif
+    return SampleBatchScalar(lastX, lastY, minDistanceSq, x, y);
+}
+
+// Square rejection: uniform points in [-1, 1)^2 that land in the unit disk and
+// outside the exclusion circle are uniform over the valid region. No trig.
+bool SpawnSampler::SampleBatchScalar(float lastX, float lastY, float minDistanceSq, float& x, float& y) {
+    uint32_t ux[4], uy[4];
+    for (int batch = 0; batch < kMaxBatches; ++batch) {
+        m_lanes.Next(ux);
+        m_lanes.Next(uy);
+        for (int lane = 0; lane < 4; ++lane) {
+            float cx = ToSigned(ux[lane]);
+            float cy = ToSigned(uy[lane]);
+            float dx = cx - lastX;
+            float dy = cy - lastY;
+            if (cx * cx + cy * cy <= 1.0f && dx * dx + dy * dy >= minDistanceSq) {
+                x = cx;
+                y = cy;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+#ifdef FLICKS_SSE2
+bool SpawnSampler::SampleBatchSse2(float lastX, float lastY, float minDistanceSq, float& x, float& y) {
+    __m128i s0 = _mm_load_si128(reinterpret_cast<const __m128i*>(m_lanes.s[0]));
+    __m128i s1 = _mm_load_si128(reinterpret_cast<const __m128i*>(m_lanes.s[1]));
+    __m128i s2 = _mm_load_si128(reinterpret_cast<const __m128i*>(m_lanes.s[2]));
+    __m128i s3 = _mm_load_si128(reinterpret_cast<const __m128i*>(m_lanes.s[3]));
+
+    // SSE2 has no 32-bit multiply, but x*5 and x*9 are a shift and an add
+    auto next = [&]() {
+        __m128i m5 = _mm_add_epi32(_mm_slli_epi32(s1, 2), s1);
+        __m128i r7 = _mm_or_si128(_mm_slli_epi32(m5, 7), _mm_srli_epi32(m5, 25));
+        __m128i result = _mm_add_epi32(_mm_slli_epi32(r7, 3), r7);
+        __m128i t = _mm_slli_epi32(s1, 9);
+        s2 = _mm_xor_si128(s2, s0);
+        s3 = _mm_xor_si128(s3, s1);
+        s1 = _mm_xor_si128(s1, s2);
+        s0 = _mm_xor_si128(s0, s3);
+        s2 = _mm_xor_si128(s2, t);
+        s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+        return result;
+    };
+    auto toSigned = [](__m128i u) {
+        __m128 f = _mm_cvtepi32_ps(_mm_srli_epi32(u, 8));
+        return _mm_sub_ps(_mm_mul_ps(f, _mm_set1_ps(1.0f / 8388608.0f)), _mm_set1_ps(1.0f));
+    };
+
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 lx = _mm_set1_ps(lastX);
+    const __m128 ly = _mm_set1_ps(lastY);
+    const __m128 minSq = _mm_set1_ps(minDistanceSq);
+
+    bool found = false;
+    for (int batch = 0; batch < kMaxBatches && !found; ++batch) {
+        __m128 cx = toSigned(next());
+        __m128 cy = toSigned(next());
+        __m128 dx = _mm_sub_ps(cx, lx);
+        __m128 dy = _mm_sub_ps(cy, ly);
+        __m128 inside = _mm_cmple_ps(_mm_add_ps(_mm_mul_ps(cx, cx), _mm_mul_ps(cy, cy)), one);
+        __m128 far = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), minSq);
+        int mask = _mm_movemask_ps(_mm_and_ps(inside, far));
+        if (mask) {
+            alignas(16) float xs[4], ys[4];
+            _mm_store_ps(xs, cx);
+            _mm_store_ps(ys, cy);
+            int lane = FirstLane(mask);
+            x = xs[lane];
+            y = ys[lane];
+            found = true;
+        }
+    }
+
+    _mm_store_si128(reinterpret_cast<__m128i*>(m_lanes.s[0]), s0);
+    _mm_store_si128(reinterpret_cast<__m128i*>(m_lanes.s[1]), s1);
+    _mm_store_si128(reinterpret_cast<__m128i*>(m_lanes.s[2]), s2);
+    _mm_store_si128(reinterpret_cast<__m128i*>(m_lanes.s[3]), s3);
+    return found;
+}
+#endif
+
+// Uniform over the unit disk minus the circle of radius minDistance around the
+// previous target. In polar coordinates around that target the area density
+// at distance rho is rho * ArcWidth(rho). ArcWidth only shrinks with rho, so
+// rho * ArcWidth(bin start) bounds it within each of kAnalyticBins bins: rho
+// is drawn from that envelope exactly and kept with probability
+// ArcWidth(rho) / ArcWidth(bin start), then the angle uniformly from the arc
+// that stays inside the disk. The trig is portable:: so the spawns are the
+// same bits on every CRT.
+bool SpawnSampler::SampleAnalytic(float lastX, float lastY, float minDistance, float& x, float& y) {
+    if (minDistance <= 0.0f) {
+        float t = m_rng.NextFloat(0.0f, kTwoPi);
+        float r = std::sqrt(m_rng.NextFloat());
+        float s, c;
+        portable::SinCos(t, s, c);
+        x = r * c;
+        y = r * s;
+        return true;
+    }
+
+    const float l = std::sqrt(lastX * lastX + lastY * lastY);
+    const float rhoMax = 1.0f + l;
+    const float base = l > 1e-6f ? portable::Atan2(lastY, lastX) : m_rng.NextFloat(0.0f, kTwoPi);
+
+    // Envelope mass of each bin: the integral of rho * ArcWidth(start) over it
+    float startWidth[kAnalyticBins];
+    float cdf[kAnalyticBins];
+    float total = 0.0f;
+    const float step = (rhoMax - minDistance) / kAnalyticBins;
+    if (step > 0.0f) {
+        for (int i = 0; i < kAnalyticBins; ++i) {
+            const float a = minDistance + i * step;
+            const float b = a + step;
+            startWidth[i] = ArcWidth(l, a);
+            total += startWidth[i] * 0.5f * (b * b - a * a);
+            cdf[i] = total;
+        }
+    }
+
+    if (total <= 0.0f) {
+        // Nothing is far enough: take the point opposite the previous target
+        float s, c;
+        portable::SinCos(base, s, c);
+        x = -c;
+        y = -s;
+        return false;
+    }
+
+    // After kAnalyticTries rejections the last candidate stands
+    float rho = minDistance;
+    float width = 0.0f;
+    for (int attempt = 0; attempt < kAnalyticTries; ++attempt) {
+        const float u = m_rng.NextFloat() * total;
+        int bin = static_cast<int>(std::upper_bound(cdf, cdf + kAnalyticBins, u) - cdf);
+        bin = std::min(bin, kAnalyticBins - 1);
+
+        // Density proportional to rho within the bin
+        const float a = minDistance + bin * step;
+        const float b = a + step;
+        rho = std::sqrt(a * a + m_rng.NextFloat() * (b * b - a * a));
+        width = ArcWidth(l, rho);
+        if (m_rng.NextFloat() * startWidth[bin] < width) break;
+    }
+
+    // The arc inside the disk is centered on the direction pointing back past the origin
+    const float phi = base + 0.5f * (kTwoPi - width) + m_rng.NextFloat() * width;
+    float s, c;
+    portable::SinCos(phi, s, c);
+    x = lastX + rho * c;
+    y = lastY + rho * s;
+
+    const float r2 = x * x + y * y;
+    if (r2 > 1.0f) {
+        const float inv = 1.0f / std::sqrt(r2);
+        x *= inv;
+        y *= inv;
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+#include "rng.h"
+#include "simd.h"
+
+enum SpawnSamplerKind {
+    SPAWN_SAMPLER_POLAR,        // original scalar polar rejection, 50 tries then the center
+    SPAWN_SAMPLER_BATCH,        // 4-wide rejection batches, analytic once the batch budget runs out
+    SPAWN_SAMPLER_ANALYTIC      // draws from the disk minus the exclusion circle by distance, rarely rejects
+};
+
+// Four interleaved xoshiro128** lanes. The SSE2 and scalar paths produce the
+// same numbers, so a schedule does not depend on the instruction set.
+struct RngX4 {
+    alignas(16) uint32_t s[4][4];   // s[word][lane]
+
+    void Seed(uint64_t seed, uint64_t stream);
+    void Next(uint32_t out[4]);
+};
+
+// Picks target positions in the unit disk that keep at least minDistance from
+// the previous one. Sample() returns false only when no such position exists;
+// the point is then the farthest one reachable (the center for POLAR).
+class SpawnSampler {
+public:
+    void Seed(uint64_t seed, uint64_t stream);
+    void SetKind(SpawnSamplerKind kind) { m_kind = kind; }
+    // Benchmarks switch the SSE2 path off to measure the scalar one
+    void SetVectorized(bool vectorized) { m_vectorized = vectorized; }
+
+    bool Sample(float lastX, float lastY, float minDistance, bool first, float& x, float& y);
+
+private:
+    bool SamplePolar(float lastX, float lastY, float minDistance, bool first, float& x, float& y);
+    bool SampleBatch(float lastX, float lastY, float minDistanceSq, float& x, float& y);
+    bool SampleBatchScalar(float lastX, float lastY, float minDistanceSq, float& x, float& y);
+#ifdef FLICKS_SSE2
+    bool SampleBatchSse2(float lastX, float lastY, float minDistanceSq, float& x, float& y);
+#endif
+    bool SampleAnalytic(float lastX, float lastY, float minDistance, float& x, float& y);
+
+    SpawnSamplerKind m_kind = SPAWN_SAMPLER_BATCH;
+    bool m_vectorized = true;
+    RngX4 m_lanes;
+    Rng m_rng;
+};
@@ -0,0 +1,44 @@
+#include "spawn_schedule.h"
+#include <algorithm>
+
+namespace {
+    const int kBatchSize = 64;
+}
+
+void SpawnSchedule::Begin(uint64_t seed, const GameSettings& settings) {
+    m_sampler.Seed(seed, RNG_STREAM_POSITION);
+    m_delayRng.Seed(seed, RNG_STREAM_DELAY);
+    // The spawn disk spans 2 units, so the minimum distance is twice the ratio
+    m_minDistance = std::max(0.0f, 2.0f * settings.distanceRatio);
+    m_minDelayMs = settings.minSpawnDelayMs;
+    m_maxDelayMs = settings.maxSpawnDelayMs;
+
+    m_points.clear();
+    m_fallbacks = 0;
+    Extend(settings.endBySpawnCount ? std::max(1, settings.maxSpawnCount) : kBatchSize);
+}
+
+void SpawnSchedule::Extend(int count) {
+    count = std::max(count, static_cast<int>(m_points.size()) + kBatchSize);
+    m_points.reserve(count);
+
+    while (static_cast<int>(m_points.size()) < count) {
+        SpawnPoint p;
+        p.delayMs = m_delayRng.NextInt(m_minDelayMs, m_maxDelayMs);
+        p.fallback = false;
+
+        const bool first = m_points.empty();
+        const float lastX = first ? 0.0f : m_points.back().x;
+        const float lastY = first ? 0.0f : m_points.back().y;
+
+        float x, y;
+        if (!m_sampler.Sample(lastX, lastY, m_minDistance, first, x, y)) {
+            p.fallback = true;
+            m_fallbacks++;
+        }
+
+        p.x = x;
+        p.y = y;
+        m_points.push_back(p);
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "settings.h"
+#include "rng.h"
+#include "spawn_sampler.h"
+
+struct SpawnPoint {
+    float x;            // position in the unit disk, scaled by FieldCache::spawnMaxRadius
+    float y;
+    int delayMs;        // wait before this spawn: from game start, or from the previous target leaving
+    bool fallback;      // no position is far enough from the previous one; placed opposite it
+};
+
+// Every target of a game, generated from the game seed before it is needed.
+// Positions are in field-independent units, so one schedule plays the same on
+// any resolution and can be shared by several players.
+class SpawnSchedule {
+public:
+    // Spawn-count games are generated in full; timed games in batches as they are consumed
+    void Begin(uint64_t seed, const GameSettings& settings);
+    const SpawnPoint& Get(int index) {
+        if (index >= static_cast<int>(m_points.size())) Extend(index + 1);
+        return m_points[index];
+    }
+
+    int GetGeneratedCount() const { return static_cast<int>(m_points.size()); }
+    int GetFallbackCount() const { return m_fallbacks; }
+
+private:
+    void Extend(int count);
+
+    SpawnSampler m_sampler;
+    Rng m_delayRng;
+    float m_minDistance = 0.0f;
+    int m_minDelayMs = 0;
+    int m_maxDelayMs = 0;
+
+    std::vector<SpawnPoint> m_points;
+    int m_fallbacks = 0;
+};
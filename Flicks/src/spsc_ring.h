@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Capacity must be a power of two. Each side keeps a cached copy of
+// the other side's index and only reloads it when the ring looks full/empty,
+// so the shared cache lines are touched once per batch, not once per item.
+template<class T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer side. Returns false when the ring is full; the item is dropped.
+    bool TryPush(const T& item) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail == Capacity) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cachedTail == Capacity) return false;
+        }
+        m_items[head & kMask] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool TryPop(T& item) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_cachedHead) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail == m_cachedHead) return false;
+        }
+        item = m_items[tail & kMask];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: calls fn for everything queued when the call starts, in
+    // order, and publishes the freed slots once. Returns the number consumed.
+    template<class Fn>
+    size_t Drain(Fn&& fn) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        m_cachedHead = m_head.load(std::memory_order_acquire);
+        for (size_t i = tail; i != m_cachedHead; ++i) fn(m_items[i & kMask]);
+        m_tail.store(m_cachedHead, std::memory_order_release);
+        return m_cachedHead - tail;
+    }
+
+    // Approximate when called concurrently with either side
+    size_t Size() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t GetCapacity() { return Capacity; }
+
+private:
+    static constexpr size_t kMask = Capacity - 1;
+    static constexpr size_t kCacheLine = 64;
+
+    // Producer-owned
+    alignas(kCacheLine) std::atomic<size_t> m_head{ 0 };
+    size_t m_cachedTail = 0;
+    // Consumer-owned
+    alignas(kCacheLine) std::atomic<size_t> m_tail{ 0 };
+    size_t m_cachedHead = 0;
+
+    alignas(kCacheLine) T m_items[Capacity];
+};
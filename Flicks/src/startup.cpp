@@ -0,0 +1,134 @@
+#include "startup.h"
+#include "clock.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+int StartupGraph::Add(const char* name, Stage stage, std::initializer_list<int> after, bool mainThread) {
+    const int id = static_cast<int>(m_stages.size());
+    Node node;
+    node.name = name;
+    node.stage = std::move(stage);
+    node.mainThread = mainThread;
+    for (int dep : after) {
+        m_stages[dep].dependents.push_back(id);
+        node.waitingOn++;
+    }
+    m_stages.push_back(std::move(node));
+    return id;
+}
+
+bool StartupGraph::Run(int workerCount) {
+    const int count = static_cast<int>(m_stages.size());
+    m_timings.assign(count, StageTiming{});
+    for (int i = 0; i < count; ++i) m_timings[i].name = m_stages[i].name;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<int> mainReady, workerReady;
+    int remaining = count;
+    int workerStages = 0;
+
+    auto enqueue = [&](int id) {
+        (m_stages[id].mainThread ? mainReady : workerReady).push_back(id);
+    };
+    // With the lock held. Failure skips everything that depends on the stage.
+    std::function<void(int, StageState)> finish = [&](int id, StageState state) {
+        m_stages[id].state = state;
+        m_timings[id].state = state;
+        remaining--;
+        for (int next : m_stages[id].dependents) {
+            Node& dependent = m_stages[next];
+            if (dependent.state != STAGE_PENDING) continue;
+            if (state != STAGE_DONE) finish(next, STAGE_SKIPPED);
+            else if (--dependent.waitingOn == 0) enqueue(next);
+        }
+    };
+
+    for (int i = 0; i < count; ++i) {
+        if (m_stages[i].waitingOn == 0) enqueue(i);
+        if (!m_stages[i].mainThread) workerStages++;
+    }
+
+    const long long startUs = NowUs();
+    auto runStages = [&](int thread) {
+        std::deque<int>& own = (thread == 0) ? mainReady : workerReady;
+        // Without workers the calling thread runs every stage
+        const bool takeAll = (thread == 0 && workerCount <= 0);
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            changed.wait(lock, [&] { return remaining == 0 || !own.empty() || (takeAll && !workerReady.empty()); });
+            int id;
+            if (takeAll) {
+                // The order they were added in, like a plain serial startup:
+                // dependencies come first, so the lowest ready id is next
+                auto lowest = [](std::deque<int>& queue) { return std::min_element(queue.begin(), queue.end()); };
+                std::deque<int>& queue = (workerReady.empty() || (!mainReady.empty() && *lowest(mainReady) < *lowest(workerReady))) ?
+                    mainReady : workerReady;
+                if (queue.empty()) break;
+                auto pick = lowest(queue);
+                id = *pick;
+                queue.erase(pick);
+            }
+            else {
+                std::deque<int>& queue = !own.empty() ? own : workerReady;
+                if (queue.empty()) break;
+                // Stages others wait on go first; a leaf like the history load can run last
+                auto pick = std::find_if(queue.begin(), queue.end(), [this](int i) { return !m_stages[i].dependents.empty(); });
+                if (pick == queue.end()) pick = queue.begin();
+                id = *pick;
+                queue.erase(pick);
+            }
+
+            lock.unlock();
+            const long long stageStartUs = NowUs();
+            const bool ok = m_stages[id].stage();
+            const long long stageEndUs = NowUs();
+            lock.lock();
+
+            m_timings[id].startUs = stageStartUs - startUs;
+            m_timings[id].endUs = stageEndUs - startUs;
+            m_timings[id].thread = thread;
+            finish(id, ok ? STAGE_DONE : STAGE_FAILED);
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    const int threads = std::min(workerCount, workerStages);
+    for (int t = 1; t <= threads; ++t) workers.emplace_back(runStages, t);
+    runStages(0);
+    for (std::thread& worker : workers) worker.join();
+    m_totalUs = NowUs() - startUs;
+
+    return std::all_of(m_stages.begin(), m_stages.end(), [](const Node& n) { return n.state == STAGE_DONE; });
+}
+
+std::string StartupGraph::FormatReport() const {
+    static const char* const stateNames[] = { "pending", "ok", "FAILED", "skipped" };
+
+    long long sumUs = 0;
+    for (const StageTiming& t : m_timings) sumUs += t.endUs - t.startUs;
+
+    std::vector<const StageTiming*> order;
+    for (const StageTiming& t : m_timings) order.push_back(&t);
+    std::stable_sort(order.begin(), order.end(), [](const StageTiming* a, const StageTiming* b) {
+        return a->startUs < b->startUs;
+    });
+
+    char line[160];
+    snprintf(line, sizeof(line), "startup %.1f ms, stages add up to %.1f ms\n", m_totalUs / 1000.0, sumUs / 1000.0);
+    std::string report = line;
+    snprintf(line, sizeof(line), "%-16s %6s %9s %9s %9s  %s\n", "stage", "thread", "start ms", "end ms", "took ms", "result");
+    report += line;
+    for (const StageTiming* t : order) {
+        snprintf(line, sizeof(line), "%-16s %6d %9.2f %9.2f %9.2f  %s\n", t->name, t->thread,
+            t->startUs / 1000.0, t->endUs / 1000.0, (t->endUs - t->startUs) / 1000.0, stateNames[t->state]);
+        report += line;
+    }
+    return report;
+}
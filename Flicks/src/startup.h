@@ -0,0 +1,58 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+// Startup as a graph of stages: each runs as soon as the stages it depends
+// on have succeeded, on a worker thread or, for stages pinned to it, on the
+// thread that calls Run (window, device and ImGui setup). Of the ready
+// stages, those that others depend on start first. A stage whose dependency
+// failed is skipped. Every stage is timed for the report.
+class StartupGraph {
+public:
+    using Stage = std::function<bool()>;
+
+    enum StageState {
+        STAGE_PENDING,
+        STAGE_DONE,
+        STAGE_FAILED,
+        STAGE_SKIPPED
+    };
+
+    struct StageTiming {
+        const char* name;
+        long long startUs;      // from the start of Run
+        long long endUs;
+        int thread;             // 0 is the calling thread, workers from 1
+        StageState state;
+    };
+
+    // Dependencies are ids returned by earlier Add calls
+    int Add(const char* name, Stage stage, std::initializer_list<int> after = {}, bool mainThread = false);
+
+    // Runs the graph with up to workerCount worker threads; true if every
+    // stage succeeded. With none, every stage runs here in the order added.
+    bool Run(int workerCount);
+
+    bool Succeeded(int id) const { return m_stages[id].state == STAGE_DONE; }
+    const std::vector<StageTiming>& GetTimings() const { return m_timings; }
+    long long GetTotalUs() const { return m_totalUs; }
+    // The wall time against the sum of the stages, then one line per stage in start order
+    std::string FormatReport() const;
+
+private:
+    struct Node {
+        const char* name;
+        Stage stage;
+        std::vector<int> dependents;
+        int waitingOn = 0;
+        bool mainThread = false;
+        StageState state = STAGE_PENDING;
+    };
+
+    std::vector<Node> m_stages;
+    std::vector<StageTiming> m_timings;
+    long long m_totalUs = 0;
+};
@@ -0,0 +1,95 @@
+#include "stream_stats.h"
+
+void RunningStats::Merge(const RunningStats& other) {
+    if (other.m_count == 0) return;
+    if (m_count == 0) {
+        *this = other;
+        return;
+    }
+
+    // Chan et al. pairwise update
+    const double total = static_cast<double>(m_count + other.m_count);
+    const double delta = other.m_mean - m_mean;
+    m_mean += delta * static_cast<double>(other.m_count) / total;
+    m_m2 += other.m_m2 + delta * delta * static_cast<double>(m_count) * static_cast<double>(other.m_count) / total;
+    m_count += other.m_count;
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+}
+
+P2Quantile::P2Quantile(double p) : m_p(p) {
+    const double increment[5] = { 0.0, p / 2.0, p, (1.0 + p) / 2.0, 1.0 };
+    for (int i = 0; i < 5; ++i) m_increment[i] = increment[i];
+}
+
+void P2Quantile::Add(double x) {
+    if (m_count < 5) {
+        m_height[m_count++] = x;
+        if (m_count == 5) {
+            std::sort(m_height, m_height + 5);
+            const double desired[5] = { 0.0, 2.0 * m_p, 4.0 * m_p, 2.0 + 2.0 * m_p, 4.0 };
+            for (int i = 0; i < 5; ++i) {
+                m_pos[i] = i;
+                m_desired[i] = desired[i];
+            }
+        }
+        return;
+    }
+
+    // Cell the new value falls into, stretching the extremes if needed
+    int k;
+    if (x < m_height[0]) {
+        m_height[0] = x;
+        k = 0;
+    }
+    else if (x >= m_height[4]) {
+        m_height[4] = x;
+        k = 3;
+    }
+    else {
+        k = 0;
+        while (k < 3 && x >= m_height[k + 1]) k++;
+    }
+    m_count++;
+
+    for (int i = k + 1; i < 5; ++i) m_pos[i] += 1.0;
+    for (int i = 0; i < 5; ++i) m_desired[i] += m_increment[i];
+
+    // Move the three middle markers toward their desired positions
+    for (int i = 1; i <= 3; ++i) {
+        const double d = m_desired[i] - m_pos[i];
+        if ((d >= 1.0 && m_pos[i + 1] - m_pos[i] > 1.0) || (d <= -1.0 && m_pos[i - 1] - m_pos[i] < -1.0)) {
+            const int step = d > 0.0 ? 1 : -1;
+            const double h = Parabolic(i, step);
+            m_height[i] = (m_height[i - 1] < h && h < m_height[i + 1]) ? h : Linear(i, step);
+            m_pos[i] += step;
+        }
+    }
+}
+
+double P2Quantile::Parabolic(int i, double d) const {
+    const double* n = m_pos;
+    const double* q = m_height;
+    return q[i] + d / (n[i + 1] - n[i - 1]) *
+        ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+         (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+}
+
+double P2Quantile::Linear(int i, int d) const {
+    return m_height[i] + d * (m_height[i + d] - m_height[i]) / (m_pos[i + d] - m_pos[i]);
+}
+
+double P2Quantile::Get() const {
+    if (m_count >= 5) return m_height[2];
+
+    // Too few values for the markers: answer from the samples themselves
+    if (m_count == 0) return 0.0;
+    const int count = static_cast<int>(m_count);
+    double values[5];
+    for (int i = 0; i < count; ++i) {
+        int j = i;
+        for (; j > 0 && values[j - 1] > m_height[i]; --j) values[j] = values[j - 1];
+        values[j] = m_height[i];
+    }
+    return values[static_cast<int>(m_p * (count - 1) + 0.5)];
+}
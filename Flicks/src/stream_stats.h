@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+// Count, mean, variance (Welford), min and max in O(1) memory. Merge()
+// combines two streams, e.g. per-thread partials.
+class RunningStats {
+public:
+    void Add(double x) {
+        m_count++;
+        const double delta = x - m_mean;
+        m_mean += delta / static_cast<double>(m_count);
+        m_m2 += delta * (x - m_mean);
+        m_min = std::min(m_min, x);
+        m_max = std::max(m_max, x);
+    }
+    void Merge(const RunningStats& other);
+
+    long long GetCount() const { return m_count; }
+    double GetMean() const { return m_mean; }
+    double GetSum() const { return m_mean * static_cast<double>(m_count); }
+    // Population variance; 0 for fewer than two values
+    double GetVariance() const { return m_count > 1 ? m_m2 / static_cast<double>(m_count) : 0.0; }
+    double GetStddev() const { return std::sqrt(GetVariance()); }
+    double GetMin() const { return m_count > 0 ? m_min : 0.0; }
+    double GetMax() const { return m_count > 0 ? m_max : 0.0; }
+
+private:
+    long long m_count = 0;
+    double m_mean = 0.0;
+    double m_m2 = 0.0;
+    double m_min = DBL_MAX;
+    double m_max = -DBL_MAX;
+};
+
+// One quantile estimated with the P-square algorithm (Jain & Chlamtac):
+// five markers, no stored samples. Exact for the first five values.
+class P2Quantile {
+public:
+    explicit P2Quantile(double p = 0.5);
+
+    void Add(double x);
+    double Get() const;
+    long long GetCount() const { return m_count; }
+
+private:
+    double Parabolic(int i, double d) const;
+    double Linear(int i, int d) const;
+
+    double m_p;
+    long long m_count = 0;
+    double m_height[5] = {};
+    double m_pos[5] = {};
+    double m_desired[5] = {};
+    double m_increment[5] = {};
+};
+
+// Exponentially weighted moving average: the most recent values weigh most
+class Ewma {
+public:
+    explicit Ewma(double alpha = 0.1) : m_alpha(alpha) {}
+
+    void Add(double x) {
+        m_value = m_hasValue ? m_value + m_alpha * (x - m_value) : x;
+        m_hasValue = true;
+    }
+    double Get() const { return m_value; }
+    bool HasValue() const { return m_hasValue; }
+
+private:
+    double m_alpha;
+    double m_value = 0.0;
+    bool m_hasValue = false;
+};
+
+struct Quantiles {
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+};
+
+// Everything the results and statistics views show about one stream, fed
+// one value at a time and read in constant time. The quantile estimators
+// cost several times the rest, so a caller bulk-loading values it may never
+// look at can feed them separately and later.
+struct StreamStats {
+    RunningStats moments;
+    P2Quantile p50{ 0.50 };
+    P2Quantile p90{ 0.90 };
+    P2Quantile p99{ 0.99 };
+    Ewma trend{ 0.1 };
+
+    void Add(double x) {
+        AddMoments(x);
+        AddQuantiles(x);
+    }
+    void AddMoments(double x) {
+        moments.Add(x);
+        trend.Add(x);
+    }
+    void AddQuantiles(double x) {
+        p50.Add(x);
+        p90.Add(x);
+        p99.Add(x);
+    }
+    Quantiles GetQuantiles() const { return { p50.Get(), p90.Get(), p99.Get() }; }
+};
+
+// Nearest-rank quantile of a sample; reorders values
+template <typename T>
+double ExactQuantile(std::vector<T>& values, double p) {
+    if (values.empty()) return 0.0;
+    const size_t k = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return static_cast<double>(values[k]);
+}
+
+template <typename T>
+Quantiles ExactQuantiles(std::vector<T>& values) {
+    Quantiles q;
+    q.p50 = ExactQuantile(values, 0.50);
+    q.p90 = ExactQuantile(values, 0.90);
+    q.p99 = ExactQuantile(values, 0.99);
+    return q;
+}
@@ -0,0 +1,86 @@
+#include "summaries.h"
+#include "compat.h"
+
+void SaveGameSummaries(const std::vector<GameSummary>& summaries, const char* path) {
+    FILE* f;
+    if (fopen_s(&f, path, "w") == 0) {
+        fprintf(f,
+            "circleRadiusNorm,"
+            "cursorRadiusNorm,"
+            "circleLifetimeMs,"
+            "gameTimeSec,"
+            "minSpawnDelayMs,"
+            "maxSpawnDelayMs,"
+            "endBySpawnCount,"
+            "maxSpawnCount,"
+            "hits,"
+            "avgReactionTime,"
+            "score,"
+            "timestamp,"
+            "seed\n"
+        );
+
+        for (const auto& s : summaries) {
+            fprintf(f,
+                "%.3f,%.3f,%d,%d,%d,%d,%d,%d,%d,%.3f,%.3f,%lld,%llu\n",
+                s.circleRadiusNorm,
+                s.cursorRadiusNorm,
+                s.circleLifetimeMs,
+                s.gameTimeSec,
+                s.minSpawnDelayMs,
+                s.maxSpawnDelayMs,
+                s.endBySpawnCount ? 1 : 0,
+                s.maxSpawnCount,
+                s.hits,
+                s.avgReactionTime,
+                s.score,
+                static_cast<long long>(s.timestamp),
+                static_cast<unsigned long long>(s.seed)
+            );
+        }
+        fclose(f);
+    }
+}
+
+void LoadGameSummaries(std::vector<GameSummary>& summaries, const char* path) {
+    FILE* f;
+    if (fopen_s(&f, path, "r") == 0) {
+        char line[512];
+        fgets(line, sizeof(line), f);
+        while (fgets(line, sizeof(line), f)) {
+            GameSummary s;
+            long long ts = 0;
+            unsigned long long seed = 0;
+            int tempEnd = 0;
+            int tempMax = 0;
+            float avgRT = 0.0f;
+            int count = sscanf_s(
+                line,
+                "%f,%f,%d,%d,%d,%d,%d,%d,%d,%f,%f,%lld,%llu",
+                &s.circleRadiusNorm,
+                &s.cursorRadiusNorm,
+                &s.circleLifetimeMs,
+                &s.gameTimeSec,
+                &s.minSpawnDelayMs,
+                &s.maxSpawnDelayMs,
+                &tempEnd,
+                &tempMax,
+                &s.hits,
+                &avgRT,
+                &s.score,
+                &ts,
+                &seed
+            );
+            // Files written before the seed column have 12 fields
+            if (count >= 12) {
+                s.endBySpawnCount = (tempEnd != 0);
+                s.maxSpawnCount = tempMax;
+                s.avgReactionTime = avgRT;
+                s.timestamp = static_cast<std::time_t>(ts);
+                s.seed = (count == 13) ? seed : 0;
+                summaries.push_back(s);
+            }
+        }
+        fclose(f);
+    }
+}
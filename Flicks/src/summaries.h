@@ -0,0 +1,8 @@
+#pragma once
+
+#include <vector>
+
+#include "session.h"
+
+void SaveGameSummaries(const std::vector<GameSummary>& summaries, const char* path = "res/game_summaries.csv");
+void LoadGameSummaries(std::vector<GameSummary>& summaries, const char* path = "res/game_summaries.csv");
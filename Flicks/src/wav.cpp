@@ -0,0 +1,75 @@
+#include "wav.h"
+#include "compat.h"
+
+#include <cstring>
+
+namespace {
+    uint16_t ReadU16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | p[1] << 8); }
+    uint32_t ReadU32(const uint8_t* p) { return static_cast<uint32_t>(p[0] | p[1] << 8 | p[2] << 16) | static_cast<uint32_t>(p[3]) << 24; }
+    void WriteU16(uint8_t* p, uint16_t v) { p[0] = static_cast<uint8_t>(v); p[1] = static_cast<uint8_t>(v >> 8); }
+    void WriteU32(uint8_t* p, uint32_t v) { WriteU16(p, static_cast<uint16_t>(v)); WriteU16(p + 2, static_cast<uint16_t>(v >> 16)); }
+}
+
+bool LoadWav(const char* path, PcmSound& sound) {
+    sound = PcmSound();
+    FILE* f;
+    if (fopen_s(&f, path, "rb") != 0) return false;
+
+    uint8_t riff[12];
+    bool ok = fread(riff, sizeof(riff), 1, f) == 1 &&
+        memcmp(riff, "RIFF", 4) == 0 && memcmp(riff + 8, "WAVE", 4) == 0;
+
+    bool fmtFound = false, dataFound = false;
+    uint8_t chunk[8];
+    while (ok && fread(chunk, sizeof(chunk), 1, f) == 1) {
+        const uint32_t size = ReadU32(chunk + 4);
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t fmt[16];
+            ok = size >= sizeof(fmt) && fread(fmt, sizeof(fmt), 1, f) == 1 &&
+                ReadU16(fmt) == 1 &&        // WAVE_FORMAT_PCM
+                fseek(f, static_cast<long>(size - sizeof(fmt) + (size & 1)), SEEK_CUR) == 0;
+            if (!ok) break;
+            sound.channels = ReadU16(fmt + 2);
+            sound.sampleRate = ReadU32(fmt + 4);
+            sound.byteRate = ReadU32(fmt + 8);
+            sound.blockAlign = ReadU16(fmt + 12);
+            sound.bitsPerSample = ReadU16(fmt + 14);
+            fmtFound = true;
+        }
+        else if (memcmp(chunk, "data", 4) == 0) {
+            sound.samples.resize(size);
+            ok = size == 0 || fread(sound.samples.data(), size, 1, f) == 1;
+            dataFound = ok;
+            if (ok && (size & 1)) fseek(f, 1, SEEK_CUR);
+        }
+        else {
+            // Chunks are padded to an even size
+            ok = fseek(f, static_cast<long>(size + (size & 1)), SEEK_CUR) == 0;
+        }
+    }
+    fclose(f);
+
+    if (!ok || !fmtFound || !dataFound) {
+        sound = PcmSound();
+        return false;
+    }
+    return true;
+}
+
+bool WriteWavHeader(FILE* f, uint16_t channels, uint32_t sampleRate, uint16_t bitsPerSample, uint32_t dataBytes) {
+    const uint16_t blockAlign = static_cast<uint16_t>(channels * (bitsPerSample / 8));
+    uint8_t header[44];
+    memcpy(header, "RIFF", 4);
+    WriteU32(header + 4, 36 + dataBytes);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    WriteU32(header + 16, 16);
+    WriteU16(header + 20, 1);       // WAVE_FORMAT_PCM
+    WriteU16(header + 22, channels);
+    WriteU32(header + 24, sampleRate);
+    WriteU32(header + 28, sampleRate * blockAlign);
+    WriteU16(header + 32, blockAlign);
+    WriteU16(header + 34, bitsPerSample);
+    memcpy(header + 36, "data", 4);
+    WriteU32(header + 40, dataBytes);
+    return fwrite(header, sizeof(header), 1, f) == 1;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// A PCM sound as read from a RIFF/WAVE file
+struct PcmSound {
+    uint16_t channels = 0;
+    uint32_t sampleRate = 0;
+    uint32_t byteRate = 0;
+    uint16_t blockAlign = 0;
+    uint16_t bitsPerSample = 0;
+    std::vector<uint8_t> samples;       // the data chunk, interleaved little-endian
+};
+
+// Reads a WAVE file with a PCM fmt chunk and a data chunk; other chunks are skipped
+bool LoadWav(const char* path, PcmSound& sound);
+
+// Writes a 44-byte PCM header at the current position; dataBytes may be patched
+// later by seeking back and writing the header again
+bool WriteWavHeader(FILE* f, uint16_t channels, uint32_t sampleRate, uint16_t bitsPerSample, uint32_t dataBytes);
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+
+// Prints the failed expression with its location; flicks_tests exits non-zero
+// if any check failed. Returns ok so a test can stop early on a failure that
+// would make the rest meaningless.
+bool TestCheck(bool ok, const char* expr, const char* file, int line);
+#define CHECK(expr) TestCheck(static_cast<bool>(expr), #expr, __FILE__, __LINE__)
+
+// An empty scratch directory under the system temp directory
+std::string MakeTestDir(const char* name);
+void RemoveTestDir(const std::string& dir);
+
+void TestSessionRules();
+void TestGameEventQueue();
+void TestRng();
+void TestSpawn();
+void TestDeterminism();
+void TestSessionTrace();
+void TestSessionReplay();
+void TestSpscRing();
+void TestGameHistory();
+void TestHistoryWriter();
+void TestHistoryColumns();
+void TestHistoryIndex();
+void TestAudioMixer();
+void TestSoftRenderer();
+void TestStreamStats();
+void TestStartupGraph();
+void TestFrameStats();
+void TestLoadGen();
+void TestFramePacer();
+void TestClock();
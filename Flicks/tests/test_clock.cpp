@@ -0,0 +1,24 @@
+#include <chrono>
+#include <thread>
+
+#include "clock.h"
+#include "test.h"
+
+void TestClock() {
+    // Never runs backwards, and microseconds and nanoseconds are one clock
+    long long last = NowUs();
+    for (int i = 0; i < 100000; ++i) {
+        const long long now = NowUs();
+        if (!CHECK(now >= last)) break;
+        last = now;
+    }
+    const long long us = NowUs();
+    const long long ns = NowNs();
+    CHECK(ns / 1000 >= us && ns / 1000 - us < 100000);
+
+    // A 20 ms sleep reads as at least 20 ms, and not wildly more
+    const long long before = NowUs();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const long long slept = NowUs() - before;
+    CHECK(slept >= 20000 && slept < 2000000);
+}
@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "field.h"
+#include "portable_math.h"
+#include "presets.h"
+#include "rng.h"
+#include "session.h"
+#include "simulate.h"
+#include "spawn_sampler.h"
+#include "spawn_schedule.h"
+#include "test.h"
+
+namespace {
+    uint32_t Bits(float v) {
+        uint32_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        return bits;
+    }
+
+    bool SameResult(const GameResult& a, const GameResult& b) {
+        return a.seed == b.seed && a.hits == b.hits && a.attempts == b.attempts &&
+            Bits(a.avgReactionTime) == Bits(b.avgReactionTime) && Bits(a.score) == Bits(b.score) &&
+            a.reactionTimesUs == b.reactionTimesUs;
+    }
+}
+
+void TestRng() {
+    // Known answers: a seed has to replay the same game on every platform and
+    // compiler, so these values may only change together with the rules version
+    {
+        Rng rng(1, RNG_STREAM_POSITION);
+        const uint32_t expected[] = { 0x466a4f46u, 0xf2926218u, 0xa5788602u, 0x877464d8u };
+        for (uint32_t value : expected) CHECK(rng.Next() == value);
+
+        Rng dice(42);
+        CHECK(dice.NextInt(1, 6) == 3);
+        CHECK(dice.NextInt(1, 6) == 6);
+        CHECK(dice.NextInt(-100, 100) == -100);
+    }
+
+    // Streams of one seed are independent; the same (seed, stream) repeats
+    {
+        Rng a(5, RNG_STREAM_DELAY), b(5, RNG_STREAM_DELAY), c(5, RNG_STREAM_POSITION);
+        int sameAsOther = 0;
+        for (int i = 0; i < 1000; ++i) {
+            const uint32_t va = a.Next();
+            CHECK(va == b.Next());
+            sameAsOther += (va == c.Next());
+        }
+        CHECK(sameAsOther < 2);
+
+        Rng range(9);
+        for (int i = 0; i < 10000; ++i) {
+            const int v = range.NextInt(-3, 3);
+            if (!CHECK(v >= -3 && v <= 3)) break;
+        }
+    }
+}
+
+void TestSpawn() {
+    // Known answers, for the same reason as the generator's
+    {
+        GameSettings settings;
+        settings.minSpawnDelayMs = 100;
+        settings.maxSpawnDelayMs = 400;
+        SpawnSchedule schedule;
+        schedule.Begin(7, settings);
+        const struct { uint32_t x, y; int delayMs; } expected[] = {
+            { 0xbeabf11cu, 0xbe295878u, 184 },
+            { 0xbf3bb276u, 0xbeaf1328u, 267 },
+            { 0xbf0853e2u, 0x3f1e09fcu, 248 },
+        };
+        for (int i = 0; i < 3; ++i) {
+            const SpawnPoint& p = schedule.Get(i);
+            CHECK(Bits(p.x) == expected[i].x && Bits(p.y) == expected[i].y && p.delayMs == expected[i].delayMs);
+        }
+    }
+
+    {
+        SpawnSampler sampler;
+        sampler.Seed(7, RNG_STREAM_POSITION);
+        sampler.SetKind(SPAWN_SAMPLER_ANALYTIC);
+        const uint32_t expected[][2] = {
+            { 0xbf0eb3b1u, 0xbe313a68u },
+            { 0xbbc65c00u, 0x3f7c4900u },
+            { 0xbdadd491u, 0xbeb1fa0cu },
+        };
+        float x = 0.0f, y = 0.0f;
+        for (int i = 0; i < 3; ++i) {
+            CHECK(sampler.Sample(x, y, 1.2f, i == 0, x, y));
+            CHECK(Bits(x) == expected[i][0] && Bits(y) == expected[i][1]);
+        }
+    }
+
+    // Schedules keep their distance unless a spawn is marked as a fallback
+    for (float ratio : { 0.2f, 0.6f, 0.95f }) {
+        GameSettings settings;
+        settings.distanceRatio = ratio;
+        settings.endBySpawnCount = true;
+        settings.maxSpawnCount = 2000;
+        SpawnSchedule a, b;
+        a.Begin(11, settings);
+        b.Begin(11, settings);
+        const float minDistance = 2.0f * ratio;
+        for (int i = 0; i < settings.maxSpawnCount; ++i) {
+            const SpawnPoint& p = a.Get(i);
+            const SpawnPoint& q = b.Get(i);
+            if (!CHECK(Bits(p.x) == Bits(q.x) && Bits(p.y) == Bits(q.y) && p.delayMs == q.delayMs)) break;
+            if (!CHECK(p.x * p.x + p.y * p.y <= 1.0f + 1e-5f)) break;
+            if (i > 0 && !p.fallback) {
+                const SpawnPoint& last = a.Get(i - 1);
+                const float dx = p.x - last.x, dy = p.y - last.y;
+                if (!CHECK(dx * dx + dy * dy >= minDistance * minDistance * (1.0f - 1e-5f))) break;
+            }
+        }
+    }
+
+    // The SSE2 sampler draws exactly what the scalar one does
+    for (float ratio : { 0.0f, 0.5f, 0.8f, 1.0f }) {
+        SpawnSampler vectorized, scalar;
+        vectorized.Seed(3, RNG_STREAM_POSITION);
+        scalar.Seed(3, RNG_STREAM_POSITION);
+        scalar.SetVectorized(false);
+        float vx = 0.0f, vy = 0.0f, sx = 0.0f, sy = 0.0f;
+        for (int i = 0; i < 20000; ++i) {
+            vectorized.Sample(vx, vy, 2.0f * ratio, i == 0, vx, vy);
+            scalar.Sample(sx, sy, 2.0f * ratio, i == 0, sx, sy);
+            if (!CHECK(Bits(vx) == Bits(sx) && Bits(vy) == Bits(sy))) break;
+        }
+    }
+
+    // The analytic sampler draws from the same distribution as plain
+    // rejection: distances to the previous target, binned finely, agree
+    // within noise (two-sample chi-square, 63 degrees of freedom)
+    for (float minDistance : { 0.3f, 1.0f, 1.5f }) {
+        const float lastX = 0.6f, lastY = 0.0f;
+        const float rhoMax = 1.0f + lastX;
+        const int bins = 64, samples = 200000;
+        std::vector<int> analytic(bins, 0), rejection(bins, 0);
+        auto bin = [&](float x, float y) {
+            const float rho = std::sqrt((x - lastX) * (x - lastX) + (y - lastY) * (y - lastY));
+            const int i = static_cast<int>((rho - minDistance) / (rhoMax - minDistance) * bins);
+            return std::clamp(i, 0, bins - 1);
+        };
+
+        SpawnSampler sampler;
+        sampler.Seed(13, RNG_STREAM_POSITION);
+        sampler.SetKind(SPAWN_SAMPLER_ANALYTIC);
+        Rng rng(13);
+        for (int i = 0; i < samples; ++i) {
+            float x, y;
+            sampler.Sample(lastX, lastY, minDistance, false, x, y);
+            analytic[bin(x, y)]++;
+            do {
+                x = rng.NextFloat(-1.0f, 1.0f);
+                y = rng.NextFloat(-1.0f, 1.0f);
+            } while (x * x + y * y > 1.0f || (x - lastX) * (x - lastX) + (y - lastY) * (y - lastY) < minDistance * minDistance);
+            rejection[bin(x, y)]++;
+        }
+        double chiSquare = 0.0;
+        for (int i = 0; i < bins; ++i) {
+            const double sum = analytic[i] + rejection[i];
+            if (sum > 0.0) chiSquare += (analytic[i] - rejection[i]) * static_cast<double>(analytic[i] - rejection[i]) / sum;
+        }
+        CHECK(chiSquare < 130.0);
+    }
+}
+
+void TestDeterminism() {
+    // The portable trig stays within a few ulp of the CRT's
+    {
+        double worst = 0.0;
+        for (int i = -20000; i <= 20000; ++i) {
+            const float t = i * 0.0005f;
+            float s, c;
+            portable::SinCos(t, s, c);
+            worst = std::max(worst, std::fabs(s - std::sin(static_cast<double>(t))));
+            worst = std::max(worst, std::fabs(c - std::cos(static_cast<double>(t))));
+            const float u = i / 20000.0f;
+            worst = std::max(worst, std::fabs(portable::Acos(u) - std::acos(static_cast<double>(u))));
+            const float ay = std::sin(0.3f * t), ax = 1.7f * std::cos(0.3f * t);
+            worst = std::max(worst, std::fabs(portable::Atan2(ay, ax) - std::atan2(static_cast<double>(ay), static_cast<double>(ax))));
+        }
+        CHECK(worst < 1e-6);
+        CHECK(portable::Atan2(0.0f, -1.0f) == portable::kPi && portable::Acos(-1.0f) == portable::kPi);
+    }
+
+    // The same seeds play the same games, preset by preset
+    for (int p = 0; p < g_presetCount; ++p) {
+        GameSettings settings;
+        ApplyPreset(settings, g_presets[p]);
+        FieldCache field;
+        UpdateFieldCache(field, 1920, 1080, settings.scale, settings.circleRadiusNorm, settings.cursorRadiusNorm);
+
+        SimPlayer player;
+        player.reactionSdMs = 30.0f;
+        player.aimSpread = 0.5f;
+        FlicksSession a, b;
+        a.Configure(settings, field);
+        b.Configure(settings, field);
+        a.Seed(21);
+        b.Seed(21);
+        Rng rngA(21, RNG_STREAM_PLAYER), rngB(21, RNG_STREAM_PLAYER);
+        for (int g = 0; g < 5; ++g) {
+            const GameResult ra = SimulateSession(a, player, rngA);
+            const GameResult& rb = SimulateSession(b, player, rngB);
+            CHECK(SameResult(ra, rb));
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "frame_stats.h"
+#include "test.h"
+
+namespace {
+    // A frame starting at startUs: 1 ms wait, 2 ms sim, Present after 6 ms,
+    // the oldest report 3 ms before the start; pump, UI and latch skipped
+    void RunFrame(FrameStats& stats, long long startUs, uint32_t presentCount, int pacing) {
+        FrameTiming& f = stats.BeginFrame(startUs);
+        f.waitEndUs = startUs + 1000;
+        f.simEndUs = startUs + 3000;
+        f.submitEndUs = startUs + 5000;
+        f.presentEndUs = startUs + 6000;
+        f.inputUs = startUs - 3000;
+        f.newestInputUs = startUs;
+        f.presentCount = presentCount;
+        f.pacing = static_cast<uint16_t>(pacing);
+        stats.EndFrame();
+    }
+}
+
+void TestFrameStats() {
+    // Frames wait for their display time; frames DXGI skipped go out without one
+    {
+        auto stats = std::make_unique<FrameStats>();
+        for (uint32_t i = 1; i <= 3; ++i) RunFrame(*stats, i * 10000, i, 0);
+        std::vector<FrameTiming> frames;
+        CHECK(stats->Snapshot(frames) == 0);
+
+        stats->MarkDisplayed(2, 40000);
+        CHECK(stats->Snapshot(frames) == 2);
+        CHECK(frames[0].presentCount == 1 && frames[0].displayUs == 0);
+        CHECK(frames[1].presentCount == 2 && frames[1].displayUs == 40000);
+        // Skipped stages take the previous stamp
+        CHECK(frames[1].pumpEndUs == frames[1].waitEndUs && frames[1].latchEndUs == frames[1].simEndUs);
+
+        // Without display times a frame is published once enough newer ones wait
+        for (uint32_t i = 4; i <= 20; ++i) RunFrame(*stats, i * 10000, i, 0);
+        CHECK(stats->GetPublishedCount() == 12);
+    }
+
+    // The ring keeps the newest frames, oldest first
+    {
+        auto stats = std::make_unique<FrameStats>();
+        const uint32_t count = static_cast<uint32_t>(FrameStats::kCapacity) + 100;
+        for (uint32_t i = 1; i <= count; ++i) {
+            RunFrame(*stats, i * 10000LL, i, 0);
+            stats->MarkDisplayed(i, i * 10000LL + 9000);
+        }
+        std::vector<FrameTiming> frames;
+        // All but the slot the writer fills next, which a snapshot cannot trust
+        CHECK(stats->Snapshot(frames) == FrameStats::kCapacity - 1);
+        CHECK(frames.front().presentCount == 102 && frames.back().presentCount == count);
+        frames.clear();
+        CHECK(stats->Snapshot(frames, 10) == 10 && frames.front().presentCount == count - 9);
+    }
+
+    // Stage times and latencies in ms, optionally for one pacing mode only
+    {
+        std::vector<FrameTiming> frames;
+        {
+            auto stats = std::make_unique<FrameStats>();
+            for (uint32_t i = 1; i <= 100; ++i) {
+                RunFrame(*stats, i * 10000LL, i, i <= 50 ? 0 : 1);
+                stats->MarkDisplayed(i, i * 10000LL + 9000);
+            }
+            stats->Snapshot(frames);
+        }
+        const FrameStatsSummary all = SummarizeFrames(frames);
+        CHECK(all.frame.count == 99 && all.frame.p50 == 10.0 && all.frame.max == 10.0);
+        CHECK(all.histogram[40] == 99);
+        CHECK(all.sim.mean == 2.0 && all.pump.max == 0.0 && all.present.p99 == 1.0);
+        CHECK(all.inputToPresent.p50 == 9.0 && all.inputToDisplay.p50 == 12.0 && all.newestToDisplay.p50 == 9.0);
+        CHECK(all.eventToPresent.count == 0);
+
+        const FrameStatsSummary capped = SummarizeFrames(frames, 1);
+        CHECK(capped.frame.count == 49 && capped.sim.count == 50);
+
+        const std::string dir = MakeTestDir("frames");
+        const std::string path = dir + "/frames.bin";
+        CHECK(WriteFrameTimesBinary(frames, path.c_str()));
+        CHECK(std::filesystem::file_size(path) == 16 + frames.size() * sizeof(FrameTiming));
+        RemoveTestDir(dir);
+    }
+}
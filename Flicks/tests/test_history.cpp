@@ -0,0 +1,328 @@
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "compat.h"
+#include "history.h"
+#include "history_columns.h"
+#include "history_index.h"
+#include "history_writer.h"
+#include "rng.h"
+#include "session_trace.h"
+#include "settings_key.h"
+#include "test.h"
+
+namespace {
+    // Games over three drills
+    GameSummary MakeGame(Rng& rng, long long index) {
+        GameSummary s = {};
+        const int drill = static_cast<int>(index % 3);
+        s.circleRadiusNorm = 0.05f + 0.01f * drill;
+        s.cursorRadiusNorm = 0.015f;
+        s.circleLifetimeMs = 300;
+        s.gameTimeSec = 60;
+        s.hits = static_cast<int>(rng.NextInt(100, 400));
+        s.avgReactionTime = (index % 7 == 0) ? 0.0f : rng.NextFloat(150.0f, 350.0f);
+        s.score = static_cast<float>(s.hits);
+        s.timestamp = 1700000000 + index * 70;
+        s.seed = rng.Next64();
+        return s;
+    }
+
+    std::vector<GameSummary> MakeGames(long long count, uint64_t seed) {
+        std::vector<GameSummary> games;
+        Rng rng(seed);
+        for (long long i = 0; i < count; ++i) games.push_back(MakeGame(rng, i));
+        return games;
+    }
+
+    bool SameGame(const GameSummary& a, const GameSummary& b) {
+        return a.circleRadiusNorm == b.circleRadiusNorm && a.circleLifetimeMs == b.circleLifetimeMs &&
+            a.hits == b.hits && a.avgReactionTime == b.avgReactionTime && a.score == b.score &&
+            a.timestamp == b.timestamp && a.seed == b.seed;
+    }
+
+    bool SameGames(const std::vector<GameSummary>& a, const std::vector<GameSummary>& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (!SameGame(a[i], b[i])) return false;
+        }
+        return true;
+    }
+
+    void AppendBytes(const std::string& path, const void* bytes, size_t count) {
+        FILE* f;
+        if (fopen_s(&f, path.c_str(), "ab") != 0) return;
+        fwrite(bytes, 1, count, f);
+        fclose(f);
+    }
+}
+
+void TestGameHistory() {
+    const std::string dir = MakeTestDir("history");
+    const std::string path = dir + "/history.bin";
+    const std::vector<GameSummary> games = MakeGames(300, 1);
+
+    // Appends survive a reopen, one at a time and in batches
+    {
+        GameHistory log;
+        CHECK(log.Open(path.c_str(), nullptr));
+        CHECK(log.GetRecordCount() == 0);
+        for (size_t i = 0; i < 100; ++i) CHECK(log.Append(games[i]));
+        CHECK(log.Append(games.data() + 100, games.size() - 100));
+        CHECK(log.Sync());
+        CHECK(log.GetRecordCount() == 300);
+    }
+    std::vector<GameSummary> read;
+    int dropped = -1;
+    CHECK(ReadGameHistory(read, path.c_str(), &dropped));
+    CHECK(dropped == 0);
+    CHECK(SameGames(read, games));
+    CHECK(CountGameHistoryRecords(path.c_str()) == 300);
+
+    // Reading from a record on
+    read.clear();
+    CHECK(ReadGameHistory(read, path.c_str(), nullptr, 250));
+    CHECK(read.size() == 50 && SameGame(read.front(), games[250]));
+
+    // A torn last record is reported, then cut off by the next Open
+    const HistoryRecord torn = MakeHistoryRecord(games[0]);
+    AppendBytes(path, &torn, 40);
+    read.clear();
+    CHECK(ReadGameHistory(read, path.c_str(), &dropped));
+    CHECK(read.size() == 300 && dropped == 1);
+    {
+        GameHistory log;
+        CHECK(log.Open(path.c_str(), nullptr));
+        CHECK(log.GetRecordCount() == 300);
+        CHECK(log.Append(games[5]));
+    }
+    read.clear();
+    CHECK(ReadGameHistory(read, path.c_str(), &dropped));
+    CHECK(read.size() == 301 && dropped == 0 && SameGame(read.back(), games[5]));
+
+    // A damaged record is skipped, its neighbours are kept
+    {
+        FILE* f;
+        if (CHECK(fopen_s(&f, path.c_str(), "r+b") == 0)) {
+            const long offset = 16 + 10 * static_cast<long>(sizeof(HistoryRecord)) + 20;
+            fseek(f, offset, SEEK_SET);
+            fputc(0x5a, f);
+            fclose(f);
+        }
+    }
+    read.clear();
+    CHECK(ReadGameHistory(read, path.c_str(), &dropped));
+    CHECK(read.size() == 300 && dropped == 1 && SameGame(read[10], games[11]));
+
+    // Something that is not a log is never appended to
+    const std::string other = dir + "/other.bin";
+    AppendBytes(other, "not a history log", 17);
+    {
+        GameHistory log;
+        CHECK(!log.Open(other.c_str(), nullptr));
+    }
+    CHECK(CountGameHistoryRecords(other.c_str()) == -1);
+
+    RemoveTestDir(dir);
+}
+
+void TestHistoryWriter() {
+    const std::string dir = MakeTestDir("writer");
+    const std::string path = dir + "/history.bin";
+    const std::vector<GameSummary> games = MakeGames(HistoryWriter::kQueueCapacity, 6);
+
+    // The writer thread gets every pushed game into the log; a batch that
+    // fits in its ring is never dropped
+    {
+        HistoryWriter writer;
+        CHECK(writer.Start(path.c_str(), nullptr));
+        for (const GameSummary& s : games) CHECK(writer.Push(s));
+        writer.Stop();
+        CHECK(writer.GetWrittenCount() == static_cast<long long>(games.size()));
+        CHECK(writer.GetDroppedCount() == 0 && writer.GetFailedCount() == 0);
+        CHECK(!writer.Push(games[0]));
+    }
+    std::vector<GameSummary> read;
+    CHECK(ReadGameHistory(read, path.c_str()));
+    CHECK(SameGames(read, games));
+
+    // It also saves a trace handed over by pointer, one at a time; the frame
+    // can wait for the last one to be written
+    {
+        const std::string tracePath = dir + "/game.flkt";
+        GameSettings settings;
+        FieldCache field;
+        SessionTrace trace(1u << 12);
+        trace.Begin(3, settings, field, 0);
+        trace.RecordSpawn(1.0f, 2.0f, 100);
+        GameResult result;
+        result.hits = 4;
+        trace.RecordEnd(result, false, 200);
+
+        HistoryWriter writer;
+        CHECK(writer.Start(path.c_str(), nullptr));
+        CHECK(writer.PushTrace(trace, tracePath.c_str()));
+        writer.WaitForTrace();
+        CHECK(!writer.IsWritingTrace() && writer.GetTraceCount() == 1);
+        CHECK(writer.PushTrace(trace, tracePath.c_str()));
+        writer.Stop();
+        CHECK(!writer.IsWritingTrace());
+        CHECK(writer.GetTraceCount() == 2 && writer.GetDroppedTraceCount() == 0);
+        CHECK(!writer.PushTrace(trace, tracePath.c_str()));
+
+        TraceHeader header;
+        std::vector<TraceEvent> events;
+        CHECK(ReadSessionTrace(tracePath.c_str(), header, events));
+        CHECK(header.hits == 4 && events.size() == 2);
+    }
+
+    RemoveTestDir(dir);
+}
+
+void TestHistoryColumns() {
+    const std::string dir = MakeTestDir("columns");
+    const std::string logPath = dir + "/history.bin";
+    const std::string snapshotPath = dir + "/history.cols";
+    const long long count = static_cast<long long>(HistoryColumns::kCompactThreshold) + 500;
+    const std::vector<GameSummary> games = MakeGames(count, 2);
+    CHECK(WriteGameHistory(games, logPath.c_str()));
+
+    auto checkColumns = [&](const HistoryColumns& columns, const std::vector<GameSummary>& expected) {
+        if (!CHECK(columns.GetCount() == expected.size())) return;
+        for (size_t i = 0; i < expected.size(); ++i) {
+            if (!CHECK(columns.GetScore(i) == expected[i].score &&
+                columns.GetAvgReactionTime(i) == expected[i].avgReactionTime &&
+                columns.GetSettingsKey(i) == MakeSettingsKey(expected[i]))) break;
+        }
+    };
+
+    // The first open writes the snapshot, the next one maps it
+    {
+        HistoryColumns columns;
+        CHECK(columns.Open(logPath.c_str(), snapshotPath.c_str()));
+        checkColumns(columns, games);
+    }
+    CHECK(std::filesystem::exists(snapshotPath));
+    std::vector<GameSummary> all = games;
+    {
+        HistoryColumns columns;
+        CHECK(columns.Open(logPath.c_str(), snapshotPath.c_str()));
+        CHECK(columns.GetMapped().count == games.size());
+        CHECK(columns.GetTail().count == 0);
+        checkColumns(columns, games);
+
+        // Games played since the snapshot come from the log
+        GameHistory log;
+        CHECK(log.Open(logPath.c_str(), nullptr));
+        const std::vector<GameSummary> more = MakeGames(20, 3);
+        CHECK(log.Append(more.data(), more.size()));
+        all.insert(all.end(), more.begin(), more.end());
+    }
+    {
+        HistoryColumns columns;
+        CHECK(columns.Open(logPath.c_str(), snapshotPath.c_str()));
+        CHECK(columns.GetMapped().count == games.size());
+        CHECK(columns.GetTail().count == 20);
+        checkColumns(columns, all);
+    }
+
+    // A damaged snapshot is rebuilt from the log
+    {
+        FILE* f;
+        if (CHECK(fopen_s(&f, snapshotPath.c_str(), "r+b") == 0)) {
+            fputc('X', f);
+            fclose(f);
+        }
+        HistoryColumns columns;
+        CHECK(columns.Open(logPath.c_str(), snapshotPath.c_str()));
+        checkColumns(columns, all);
+    }
+
+    // A shorter log than the snapshot covers: the snapshot is not used
+    {
+        const std::vector<GameSummary> fewer(games.begin(), games.begin() + 100);
+        CHECK(WriteGameHistory(fewer, logPath.c_str()));
+        HistoryColumns columns;
+        CHECK(columns.Open(logPath.c_str(), snapshotPath.c_str()));
+        checkColumns(columns, fewer);
+    }
+
+    // Another log as long as the snapshot's, or longer: the snapshot is not used
+    for (long long extra : { 0, 10 }) {
+        CHECK(WriteGameHistory(games, logPath.c_str()));
+        {
+            HistoryColumns columns;
+            CHECK(columns.Open(logPath.c_str(), snapshotPath.c_str()));
+        }
+        const std::vector<GameSummary> other = MakeGames(count + extra, 5);
+        CHECK(WriteGameHistory(other, logPath.c_str()));
+        HistoryColumns columns;
+        CHECK(columns.Open(logPath.c_str(), snapshotPath.c_str()));
+        checkColumns(columns, other);
+    }
+
+    RemoveTestDir(dir);
+}
+
+void TestHistoryIndex() {
+    const std::string dir = MakeTestDir("index");
+    const std::string logPath = dir + "/history.bin";
+    const std::string snapshotPath = dir + "/history.cols";
+    const std::vector<GameSummary> all = MakeGames(600, 7);
+
+    // Most games come from the snapshot, the last ones from the log
+    CHECK(WriteGameHistory(std::vector<GameSummary>(all.begin(), all.begin() + 500), logPath.c_str()));
+    {
+        HistoryColumns columns;
+        CHECK(columns.Open(logPath.c_str(), snapshotPath.c_str()));
+        GameHistory log;
+        CHECK(log.Open(logPath.c_str(), nullptr));
+        CHECK(log.Append(all.data() + 500, 100));
+    }
+    HistoryColumns columns;
+    CHECK(columns.Open(logPath.c_str(), snapshotPath.c_str()));
+    CHECK(columns.GetMapped().count == 500 && columns.GetTail().count == 100);
+
+    // The index agrees with a scan of the columns, before and after an append
+    HistoryIndex index;
+    index.Build(columns);
+    CHECK(index.GetGroupCount() == 3);
+    for (int drill = 0; drill < 3; ++drill) {
+        const uint64_t key = MakeSettingsKey(all[drill]);
+        std::vector<uint32_t> rows;
+        columns.Select(key, rows);
+        const SettingsStats* stats = index.Find(columns, key);
+        if (!CHECK(stats != nullptr)) continue;
+        CHECK(stats->rows == rows);
+        double sum = 0.0;
+        int reactions = 0;
+        for (uint32_t row : rows) {
+            sum += columns.GetScore(row);
+            reactions += columns.GetAvgReactionTime(row) > 0.0f;
+        }
+        CHECK(std::abs(stats->score.moments.GetMean() - sum / rows.size()) < 1e-6 * sum);
+        CHECK(stats->reactionTime.moments.GetCount() == reactions);
+    }
+    CHECK(index.Find(columns, 12345) == nullptr);
+
+    // After Reserve() the append moves nothing
+    const GameSummary extra = MakeGames(1, 4).front();
+    columns.Reserve(1);
+    index.Reserve(MakeSettingsKey(extra));
+    const float* tailScore = columns.GetTail().score;
+    const uint32_t* rows = index.Find(columns, MakeSettingsKey(extra))->rows.data();
+    CHECK(index.Find(columns, 777) == nullptr);
+    index.Reserve(777);
+    CHECK(index.Find(columns, 777) == nullptr);
+    columns.Append(extra);
+    index.Add(columns, columns.GetCount() - 1);
+    CHECK(columns.GetTail().score == tailScore);
+    CHECK(index.Find(columns, MakeSettingsKey(extra))->rows.data() == rows);
+    const SettingsStats* stats = index.Find(columns, MakeSettingsKey(extra));
+    CHECK(stats != nullptr && stats->rows.back() == columns.GetCount() - 1);
+
+    RemoveTestDir(dir);
+}
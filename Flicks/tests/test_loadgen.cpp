@@ -0,0 +1,32 @@
+#include "loadgen.h"
+#include "test.h"
+
+void TestLoadGen() {
+    LoadGenConfig config;
+    config.settings.gameTimeSec = 5;
+    UpdateFieldCache(config.field, 1920, 1080, config.settings.scale, config.settings.circleRadiusNorm, config.settings.cursorRadiusNorm);
+    config.sessions = 203;
+    config.threads = 3;
+    config.seed = 8;
+    config.keepSummaries = true;
+
+    // Every session runs once, and the same config plays the same games
+    const LoadGenReport a = RunLoadGen(config);
+    const LoadGenReport b = RunLoadGen(config);
+    CHECK(a.sessions == 203 && a.threads == 3 && a.summaries.size() == 203);
+    if (CHECK(b.summaries.size() == a.summaries.size())) {
+        for (size_t i = 0; i < a.summaries.size(); ++i) {
+            if (!CHECK(a.summaries[i].seed == b.summaries[i].seed && a.summaries[i].score == b.summaries[i].score)) break;
+        }
+    }
+    CHECK(a.score.mean == b.score.mean && a.hits.p50 == b.hits.p50);
+    CHECK(a.score.min <= a.score.p10 && a.score.p10 <= a.score.p50 && a.score.p50 <= a.score.p90 && a.score.p90 <= a.score.max);
+    CHECK(a.accuracy > 0.0 && a.accuracy <= 100.0);
+
+    // A shared schedule gives every player the same game
+    config.sharedSchedule = true;
+    const LoadGenReport shared = RunLoadGen(config);
+    bool sameSeed = true;
+    for (const GameSummary& s : shared.summaries) sameSeed = sameSeed && s.seed == shared.summaries.front().seed;
+    CHECK(sameSeed);
+}
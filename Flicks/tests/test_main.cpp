@@ -0,0 +1,87 @@
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#include "test.h"
+
+namespace {
+    int g_failedChecks = 0;
+
+    struct TestEntry {
+        const char* name;
+        void (*run)();
+    };
+
+    const TestEntry g_tests[] = {
+        { "session", TestSessionRules },
+        { "events", TestGameEventQueue },
+        { "rng", TestRng },
+        { "spawn", TestSpawn },
+        { "determinism", TestDeterminism },
+        { "trace", TestSessionTrace },
+        { "replay", TestSessionReplay },
+        { "ring", TestSpscRing },
+        { "history", TestGameHistory },
+        { "writer", TestHistoryWriter },
+        { "columns", TestHistoryColumns },
+        { "index", TestHistoryIndex },
+        { "mixer", TestAudioMixer },
+        { "render", TestSoftRenderer },
+        { "stats", TestStreamStats },
+        { "startup", TestStartupGraph },
+        { "frames", TestFrameStats },
+        { "loadgen", TestLoadGen },
+        { "pacing", TestFramePacer },
+        { "clock", TestClock },
+    };
+}
+
+bool TestCheck(bool ok, const char* expr, const char* file, int line) {
+    if (!ok) {
+        printf("%s:%d: CHECK(%s) failed\n", file, line, expr);
+        g_failedChecks++;
+    }
+    return ok;
+}
+
+std::string MakeTestDir(const char* name) {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / (std::string("flicks_tests_") + name);
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    std::filesystem::create_directories(dir);
+    return dir.string();
+}
+
+void RemoveTestDir(const std::string& dir) {
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
+
+// flicks_tests [name...] - runs the named tests, or all of them; exits 1 if a check failed
+int main(int argc, char** argv) {
+    int ran = 0;
+    for (const TestEntry& test : g_tests) {
+        bool selected = (argc < 2);
+        for (int i = 1; i < argc && !selected; ++i) {
+            selected = (strcmp(argv[i], test.name) == 0);
+        }
+        if (!selected) continue;
+
+        const int failedBefore = g_failedChecks;
+        test.run();
+        printf("%-12s %s\n", test.name, g_failedChecks == failedBefore ? "ok" : "FAILED");
+        ran++;
+    }
+
+    if (ran == 0) {
+        printf("Available tests:");
+        for (const TestEntry& test : g_tests) printf(" %s", test.name);
+        printf("\n");
+        return 1;
+    }
+    if (g_failedChecks > 0) {
+        printf("%d check(s) failed\n", g_failedChecks);
+        return 1;
+    }
+    return 0;
+}
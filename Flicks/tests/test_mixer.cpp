@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "audio_mixer.h"
+#include "audio_sink.h"
+#include "test.h"
+#include "wav.h"
+
+namespace {
+    // A 16-bit sound whose every sample is value
+    PcmSound MakeConstant(uint32_t rate, uint16_t channels, int frames, int16_t value) {
+        PcmSound pcm;
+        pcm.channels = channels;
+        pcm.sampleRate = rate;
+        pcm.bitsPerSample = 16;
+        pcm.blockAlign = static_cast<uint16_t>(channels * 2);
+        pcm.byteRate = rate * pcm.blockAlign;
+        pcm.samples.resize(static_cast<size_t>(frames) * pcm.blockAlign);
+        for (size_t i = 0; i < pcm.samples.size(); i += 2) memcpy(&pcm.samples[i], &value, 2);
+        return pcm;
+    }
+}
+
+void TestAudioMixer() {
+    const int block = 240;
+    std::vector<float> out(static_cast<size_t>(block) * AudioMixer::kChannels);
+
+    // Conversion at load: mono to both sides, other rates resampled, odd formats refused
+    {
+        AudioMixer mixer;
+        const int sound = mixer.AddSound(MakeConstant(AudioMixer::kSampleRate, 1, 1000, 16384));
+        CHECK(sound == 0 && mixer.GetSoundFrames(sound) == 1000);
+        const int resampled = mixer.AddSound(MakeConstant(24000, 2, 1000, 16384));
+        CHECK(resampled == 1 && mixer.GetSoundFrames(resampled) == 2000);
+        PcmSound odd = MakeConstant(AudioMixer::kSampleRate, 1, 10, 0);
+        odd.bitsPerSample = 12;
+        CHECK(mixer.AddSound(odd) == -1);
+        CHECK(!mixer.Play(5));
+
+        CHECK(mixer.Play(sound, 0.5f));
+        mixer.Mix(out.data(), block);
+        CHECK(out[0] == 0.25f && out[1] == 0.25f && out[out.size() - 1] == 0.25f);
+    }
+
+    // Overlapping hits add up and each plays to its end
+    {
+        AudioMixer mixer;
+        const int frames = 10 * block;
+        const int sound = mixer.AddSound(MakeConstant(AudioMixer::kSampleRate, 2, frames, 8192));
+        long long heard = 0;
+        for (int i = 0; i < 100 && (i < 8 || mixer.GetActiveVoices() > 0); ++i) {
+            if (i < 8) mixer.Play(sound);
+            mixer.Mix(out.data(), block);
+            const int voices = std::min(i + 1, 8) - std::max(0, i - 9);
+            CHECK(out[0] == 0.25f * voices);
+            if (out[0] != 0.0f) heard += block;
+        }
+        CHECK(heard == 7 * block + frames);
+        CHECK(mixer.GetPlayedCount() == 8 && mixer.GetStolenCount() == 0);
+        CHECK(mixer.GetActiveVoices() == 0);
+        mixer.Mix(out.data(), block);
+        CHECK(out[0] == 0.0f && out[out.size() - 1] == 0.0f);
+    }
+
+    // Past kMaxVoices new hits take over the ones that have played longest
+    {
+        AudioMixer mixer;
+        const int sound = mixer.AddSound(MakeConstant(AudioMixer::kSampleRate, 2, 100 * block, 1024));
+        for (int i = 0; i < AudioMixer::kMaxVoices; ++i) mixer.Play(sound);
+        mixer.Mix(out.data(), block);
+        for (int i = 0; i < 10; ++i) mixer.Play(sound);
+        mixer.Mix(out.data(), block);
+        CHECK(mixer.GetActiveVoices() == AudioMixer::kMaxVoices);
+        CHECK(mixer.GetStolenCount() == 10);
+    }
+
+    // A full command ring drops plays instead of blocking the game thread
+    {
+        auto mixer = std::make_unique<AudioMixer>();
+        const int sound = mixer->AddSound(MakeConstant(AudioMixer::kSampleRate, 2, 10, 1));
+        int accepted = 0;
+        for (size_t i = 0; i < AudioMixer::kQueueCapacity + 10; ++i) accepted += mixer->Play(sound);
+        CHECK(accepted == static_cast<int>(AudioMixer::kQueueCapacity));
+        CHECK(mixer->GetDroppedCount() == 10);
+    }
+
+    // SSE2 and scalar mixes are bit-identical; odd gains and staggered voices
+    {
+        auto a = std::make_unique<AudioMixer>();
+        auto b = std::make_unique<AudioMixer>();
+        b->SetVectorized(false);
+        PcmSound tone = MakeConstant(AudioMixer::kSampleRate, 2, 3001, 0);
+        for (size_t i = 0; i < tone.samples.size() / 2; ++i) {
+            const int16_t v = static_cast<int16_t>(12000.0 * std::sin(0.01 * static_cast<double>(i)));
+            memcpy(&tone.samples[i * 2], &v, 2);
+        }
+        const int sa = a->AddSound(tone), sb = b->AddSound(tone);
+        std::vector<float> outB(out.size());
+        bool same = true;
+        for (int i = 0; i < 200 && same; ++i) {
+            if (i % 3 == 0) {
+                a->Play(sa, 0.1f + 0.013f * i);
+                b->Play(sb, 0.1f + 0.013f * i);
+            }
+            a->Mix(out.data(), block - i % 7);
+            b->Mix(outB.data(), block - i % 7);
+            same = memcmp(out.data(), outB.data(), out.size() * sizeof(float)) == 0;
+        }
+        CHECK(same);
+    }
+
+    // Saturating conversion, rounding to nearest
+    {
+        const float in[11] = { 0.0f, 1.0f, -1.0f, 2.0f, -2.0f, 0.5f, -0.5f, 1.0f / 65536.0f, 3.0f / 65536.0f, 1e9f, -1e9f };
+        const int16_t expected[11] = { 0, 32767, -32768, 32767, -32768, 16384, -16384, 0, 2, 32767, -32768 };
+        int16_t pcm[11];
+        MixToPcm16(in, pcm, 11);
+        CHECK(memcmp(pcm, expected, sizeof(pcm)) == 0);
+    }
+
+    // The file sink writes a WAV that reads back with every mixed frame
+    {
+        const std::string dir = MakeTestDir("mixer");
+        const std::string path = dir + "/mix.wav";
+        AudioMixer mixer;
+        const int sound = mixer.AddSound(MakeConstant(AudioMixer::kSampleRate, 2, 4800, 16384));
+        AudioFileSink sink;
+        CHECK(sink.Start(mixer, path.c_str()));
+        mixer.Play(sound);
+        std::this_thread::sleep_for(std::chrono::milliseconds(60));
+        sink.Stop();
+
+        PcmSound written;
+        CHECK(LoadWav(path.c_str(), written));
+        CHECK(written.channels == 2 && written.sampleRate == static_cast<uint32_t>(AudioMixer::kSampleRate) && written.bitsPerSample == 16);
+        CHECK(sink.GetMixedFrames() > 0);
+        CHECK(static_cast<long long>(written.samples.size() / written.blockAlign) == sink.GetMixedFrames());
+        RemoveTestDir(dir);
+    }
+}
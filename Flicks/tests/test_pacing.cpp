@@ -0,0 +1,49 @@
+#include "frame_pacer.h"
+#include "test.h"
+
+namespace {
+    // Moves on 1 us per read, so a spin ends exactly at its deadline
+    long long g_fakeUs = 0;
+    long long FakeClock() {
+        return ++g_fakeUs;
+    }
+}
+
+void TestFramePacer() {
+    CHECK(PacingUsesSwapChain(PACING_WAITABLE) && PacingUsesSwapChain(PACING_LATE_INPUT));
+    CHECK(!PacingUsesSwapChain(PACING_UNCAPPED) && !PacingUsesSwapChain(PACING_CAPPED));
+
+    g_fakeUs = 1000000;
+    FramePacer pacer(FakeClock);
+    pacer.SetMode(PACING_COUNT);
+    CHECK(pacer.GetMode() == PACING_WAITABLE);
+    const long long now = g_fakeUs;
+    CHECK(pacer.Wait() == now + 1);
+
+    // Capped: starts on a fixed grid, and starts it over after falling a period behind
+    pacer.SetMode(PACING_CAPPED);
+    pacer.SetCapFps(250);
+    const long long first = pacer.Wait();
+    CHECK(pacer.Wait() == first + 4000);
+    CHECK(pacer.Wait() == first + 8000);
+    g_fakeUs += 20000;
+    const long long late = g_fakeUs + 1;
+    CHECK(pacer.Wait() == late);
+    CHECK(pacer.Wait() == late + 4000);
+
+    // Late input: starts the slowest recent frame's work plus the margin
+    // before the next vblank
+    pacer.SetMode(PACING_LATE_INPUT);
+    pacer.SetRefreshPeriodUs(10000);
+    pacer.SetLateMarginUs(1000);
+    pacer.EndFrame(0, 2000);
+    pacer.EndFrame(0, 3000);
+    CHECK(pacer.GetPredictedWorkUs() == 3000);
+    const long long vblank = g_fakeUs;
+    pacer.OnVblank(vblank);
+    CHECK(pacer.Wait() == vblank + 10000 - 3000 - 1000);
+    // Past that point it starts at once
+    pacer.OnVblank(g_fakeUs - 9500);
+    const long long immediate = g_fakeUs + 1;
+    CHECK(pacer.Wait() == immediate);
+}
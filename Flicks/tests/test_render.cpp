@@ -0,0 +1,38 @@
+#include "field.h"
+#include "scene.h"
+#include "session.h"
+#include "settings.h"
+#include "soft_renderer.h"
+#include "test.h"
+
+namespace {
+    // The game with seed 7 at its first spawn, cursor off the pixel grid so
+    // every circle edge is partly covered
+    uint64_t RenderFrameHash(bool vectorized) {
+        const int width = 320, height = 180;
+        const GameSettings settings;
+        FieldCache field;
+        UpdateFieldCache(field, width, height, settings.scale, settings.circleRadiusNorm, settings.cursorRadiusNorm);
+
+        FlicksSession session;
+        session.Configure(settings, field);
+        session.Reset(7);
+        session.Start(0);
+        session.Tick(session.GetNextEventTimeUs());
+        CHECK(session.IsCircleActive());
+
+        SoftRenderer renderer(width, height);
+        renderer.SetVectorized(vectorized);
+        const ImVec2 cursor(field.center.x + 10.3f, field.center.y - 7.6f);
+        DrawScene(renderer, session, field, settings, &cursor);
+        return renderer.Hash();
+    }
+}
+
+void TestSoftRenderer() {
+    // Known answer for both paths, so a change that breaks them the same way
+    // still shows; update it together with rasterization, blending or default colors
+    const uint64_t expected = 0x3642fecce7a6ef5dull;
+    CHECK(RenderFrameHash(true) == expected);
+    CHECK(RenderFrameHash(false) == expected);
+}
@@ -0,0 +1,50 @@
+#include <thread>
+#include <vector>
+
+#include "spsc_ring.h"
+#include "test.h"
+
+void TestSpscRing() {
+    // Exactly Capacity items fit; they come out in order
+    {
+        static SpscRing<int, 8> ring;
+        int pushed = 0;
+        for (int i = 0; i < 20; ++i) pushed += ring.TryPush(i);
+        CHECK(pushed == 8);
+        CHECK(ring.Size() == 8);
+
+        int value = -1;
+        CHECK(ring.TryPop(value) && value == 0);
+        CHECK(ring.TryPush(100));
+        std::vector<int> drained;
+        CHECK(ring.Drain([&](int v) { drained.push_back(v); }) == 8);
+        CHECK((drained == std::vector<int>{ 1, 2, 3, 4, 5, 6, 7, 100 }));
+        CHECK(!ring.TryPop(value));
+        CHECK(ring.Drain([](int) {}) == 0);
+    }
+
+    // Across threads: nothing lost, duplicated or reordered, through many wraps
+    {
+        static SpscRing<long long, 64> ring;
+        const long long count = 2000000;
+        std::thread producer([] {
+            for (long long i = 0; i < count; ++i) {
+                while (!ring.TryPush(i)) std::this_thread::yield();
+            }
+        });
+
+        long long expected = 0;
+        long long outOfOrder = 0;
+        while (expected < count) {
+            const size_t n = ring.Drain([&](long long v) {
+                if (v != expected) outOfOrder++;
+                expected = v + 1;
+            });
+            if (n == 0) std::this_thread::yield();
+        }
+        producer.join();
+        CHECK(outOfOrder == 0);
+        CHECK(expected == count);
+        CHECK(ring.Size() == 0);
+    }
+}
@@ -0,0 +1,196 @@
+#include <climits>
+#include <cmath>
+
+#include "field.h"
+#include "game_events.h"
+#include "session.h"
+#include "test.h"
+
+namespace {
+    FieldCache MakeField(const GameSettings& settings) {
+        FieldCache field;
+        UpdateFieldCache(field, 1920, 1080, settings.scale, settings.circleRadiusNorm, settings.cursorRadiusNorm);
+        return field;
+    }
+
+    // Starts a game at startUs with the start click in the center
+    void StartGame(FlicksSession& session, const FieldCache& field, long long startUs) {
+        session.Reset(1);
+        CHECK(session.Click(field.center.x, field.center.y, startUs) == FlicksSession::CLICK_STARTED);
+    }
+
+    // Ticks to the next spawn and returns its time
+    long long NextSpawn(FlicksSession& session) {
+        const long long spawnUs = session.GetNextEventTimeUs();
+        session.Tick(spawnUs);
+        return spawnUs;
+    }
+}
+
+void TestSessionRules() {
+    GameSettings settings;
+    settings.gameTimeSec = 5;
+    const FieldCache field = MakeField(settings);
+    const long long lifetimeUs = settings.circleLifetimeMs * 1000LL;
+
+    // Only a click on the start circle starts the game
+    {
+        FlicksSession session;
+        session.Configure(settings, field);
+        session.Reset(1);
+        CHECK(session.Click(field.fieldTL.x, field.fieldTL.y, 0) == FlicksSession::CLICK_NONE);
+        CHECK(session.GetState() == GAME_NOT_STARTED);
+        CHECK(session.GetNextEventTimeUs() == LLONG_MAX);
+        CHECK(session.Click(field.center.x, field.center.y, 0) == FlicksSession::CLICK_STARTED);
+        CHECK(session.GetState() == GAME_RUNNING);
+    }
+
+    // Hits count from the spawn time; misses only count as attempts
+    {
+        FlicksSession session;
+        session.Configure(settings, field);
+        StartGame(session, field, 1000);
+        const long long spawnUs = NextSpawn(session);
+        CHECK(session.IsCircleActive());
+        CHECK(session.GetCircleSpawnTimeUs() == spawnUs);
+
+        const ImVec2 pos = session.GetCirclePos();
+        const float far = field.circleRadiusPx + field.cursorRadiusPx + 1.0f;
+        CHECK(session.Click(pos.x + far, pos.y, spawnUs + 100000) == FlicksSession::CLICK_MISS);
+        CHECK(session.IsCircleActive());
+        CHECK(session.Click(pos.x, pos.y, spawnUs + 180000) == FlicksSession::CLICK_HIT);
+        CHECK(!session.IsCircleActive());
+        CHECK(session.GetHits() == 1);
+        CHECK(session.GetAttempts() == 2);
+        CHECK(session.GetLastReactionTimeUs() == 180000);
+    }
+
+    // A target lives exactly its lifetime, however late the tick that sees it
+    {
+        FlicksSession session;
+        session.Configure(settings, field);
+        StartGame(session, field, 0);
+        const long long spawnUs = NextSpawn(session);
+        CHECK(session.GetNextEventTimeUs() == spawnUs + lifetimeUs);
+        session.Tick(spawnUs + lifetimeUs - 1);
+        CHECK(session.IsCircleActive());
+
+        // No spawn delay: the next target appears when the last one expired,
+        // not when the late tick came
+        session.Tick(spawnUs + lifetimeUs + 40000);
+        CHECK(session.IsCircleActive());
+        CHECK(session.GetSpawnCount() == 2);
+        CHECK(session.GetCircleSpawnTimeUs() == spawnUs + lifetimeUs);
+    }
+
+    // A timed game ends at its time limit and scores its hits
+    {
+        FlicksSession session;
+        session.Configure(settings, field);
+        StartGame(session, field, 0);
+        // The game was given its room at the start; nothing moves after that
+        const int* reactions = session.GetResult().reactionTimesUs.data();
+        const int* history = session.GetResult().scoreHistory.data();
+        int hits = 0;
+        while (session.GetState() == GAME_RUNNING) {
+            const long long nowUs = session.GetNextEventTimeUs();
+            session.Tick(nowUs);
+            if (session.IsCircleActive() && session.GetCircleSpawnTimeUs() == nowUs && session.GetSpawnCount() % 2 == 0) {
+                const ImVec2 pos = session.GetCirclePos();
+                session.Tick(nowUs + 150000);
+                hits += session.Click(pos.x, pos.y, nowUs + 150000) == FlicksSession::CLICK_HIT;
+            }
+        }
+        const GameResult& result = session.GetResult();
+        CHECK(hits > 0);
+        CHECK(result.hits == hits);
+        CHECK(result.score == static_cast<float>(hits));
+        CHECK(std::fabs(result.avgReactionTime - 150.0f) < 1e-3f);
+        CHECK(result.scoreHistory.size() == static_cast<size_t>(settings.gameTimeSec) + 1);
+        CHECK(result.reactionTimesUs.data() == reactions && result.scoreHistory.data() == history);
+
+        // Copying the result into one reserved like it moves nothing either
+        GameResult shown;
+        shown.scoreHistory.reserve(result.scoreHistory.capacity());
+        shown.reactionTimesUs.reserve(result.reactionTimesUs.capacity());
+        const int* shownReactions = shown.reactionTimesUs.data();
+        shown = result;
+        CHECK(shown.reactionTimesUs.data() == shownReactions && shown.reactionTimesUs == result.reactionTimesUs);
+    }
+
+    // A spawn-count game ends on its last target; misses cost sqrt(missed) * 100
+    {
+        GameSettings countSettings = settings;
+        countSettings.endBySpawnCount = true;
+        countSettings.maxSpawnCount = 5;
+        FlicksSession session;
+        session.Configure(countSettings, field);
+        StartGame(session, field, 0);
+        while (session.GetState() == GAME_RUNNING) {
+            const long long nowUs = session.GetNextEventTimeUs();
+            session.Tick(nowUs);
+            if (session.IsCircleActive() && session.GetCircleSpawnTimeUs() == nowUs && session.GetSpawnCount() != 3) {
+                const ImVec2 pos = session.GetCirclePos();
+                session.Tick(nowUs + 200000);
+                session.Click(pos.x, pos.y, nowUs + 200000);
+            }
+        }
+        const GameResult& result = session.GetResult();
+        CHECK(session.GetSpawnCount() == 5);
+        CHECK(result.hits == 4);
+        CHECK(result.score == 100.0f + result.avgReactionTime);
+    }
+
+    // Ending early lets the live target finish, then spawns nothing more
+    {
+        FlicksSession session;
+        session.Configure(settings, field);
+        StartGame(session, field, 0);
+        const long long spawnUs = NextSpawn(session);
+        session.RequestFinish();
+        session.Tick(spawnUs + 1000);
+        CHECK(session.GetState() == GAME_RUNNING);
+        session.Tick(spawnUs + lifetimeUs);
+        CHECK(session.GetState() == GAME_FINISHED);
+        CHECK(session.WasForceFinished());
+        CHECK(session.GetSpawnCount() == 1);
+    }
+}
+
+void TestGameEventQueue() {
+    GameEventQueue queue;
+    queue.Clear();
+    GameEventType type;
+    long long timeUs;
+    CHECK(queue.GetNextTimeUs() == GameEventQueue::kNone);
+    CHECK(!queue.PopDue(LLONG_MAX - 1, type, timeUs));
+
+    // Earliest first; nothing is due before its time
+    queue.Schedule(GAME_EVENT_SPAWN, 300);
+    queue.Schedule(GAME_EVENT_EXPIRE, 100);
+    queue.Schedule(GAME_EVENT_END, 200);
+    CHECK(queue.GetNextTimeUs() == 100);
+    CHECK(!queue.PopDue(99, type, timeUs));
+    CHECK(queue.PopDue(1000, type, timeUs) && type == GAME_EVENT_EXPIRE && timeUs == 100);
+    CHECK(queue.PopDue(1000, type, timeUs) && type == GAME_EVENT_END && timeUs == 200);
+    CHECK(queue.PopDue(1000, type, timeUs) && type == GAME_EVENT_SPAWN && timeUs == 300);
+    CHECK(!queue.PopDue(1000, type, timeUs));
+
+    // Ties run in type order: end, expiry, spawn
+    queue.Schedule(GAME_EVENT_SPAWN, 50);
+    queue.Schedule(GAME_EVENT_EXPIRE, 50);
+    queue.Schedule(GAME_EVENT_END, 50);
+    for (GameEventType expected : { GAME_EVENT_END, GAME_EVENT_EXPIRE, GAME_EVENT_SPAWN }) {
+        CHECK(queue.PopDue(50, type, timeUs) && type == expected);
+    }
+
+    // Moving or cancelling the earliest event brings the next one forward
+    queue.Schedule(GAME_EVENT_EXPIRE, 10);
+    queue.Schedule(GAME_EVENT_SPAWN, 20);
+    queue.Schedule(GAME_EVENT_EXPIRE, 30);
+    CHECK(queue.GetNextTimeUs() == 20);
+    queue.Cancel(GAME_EVENT_SPAWN);
+    CHECK(queue.GetNextTimeUs() == 30);
+    queue.Clear();
+    CHECK(queue.GetNextTimeUs() == GameEventQueue::kNone);
+}
@@ -0,0 +1,61 @@
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "startup.h"
+#include "test.h"
+
+void TestStartupGraph() {
+    // Serially and with workers alike: a stage runs after everything it
+    // depends on, main-thread stages on the calling thread, and a failure
+    // skips its dependents but not the rest
+    for (int workers : { 0, 3 }) {
+        std::mutex mutex;
+        std::vector<int> order;
+        const std::thread::id caller = std::this_thread::get_id();
+        std::atomic<bool> mainOnCaller{ true };
+        auto stage = [&](int id, bool ok, bool main = false) {
+            return [&, id, ok, main] {
+                if (main && std::this_thread::get_id() != caller) mainOnCaller = false;
+                std::lock_guard<std::mutex> lock(mutex);
+                order.push_back(id);
+                return ok;
+            };
+        };
+
+        StartupGraph graph;
+        const int a = graph.Add("a", stage(0, true));
+        const int b = graph.Add("b", stage(1, true, true), {}, true);
+        const int c = graph.Add("c", stage(2, true), { a, b });
+        const int broken = graph.Add("broken", stage(3, false));
+        const int after = graph.Add("after broken", stage(4, true), { broken, c });
+        const int leaf = graph.Add("leaf", stage(5, true, true), { c }, true);
+
+        CHECK(!graph.Run(workers));
+        CHECK(mainOnCaller);
+        CHECK(graph.Succeeded(a) && graph.Succeeded(b) && graph.Succeeded(c) && graph.Succeeded(leaf));
+        CHECK(!graph.Succeeded(broken) && !graph.Succeeded(after));
+        CHECK(graph.GetTimings()[broken].state == StartupGraph::STAGE_FAILED);
+        CHECK(graph.GetTimings()[after].state == StartupGraph::STAGE_SKIPPED);
+
+        auto position = [&](int id) {
+            for (size_t i = 0; i < order.size(); ++i) {
+                if (order[i] == id) return static_cast<int>(i);
+            }
+            return -1;
+        };
+        CHECK(order.size() == 5 && position(4) == -1);
+        CHECK(position(2) > position(0) && position(2) > position(1));
+        CHECK(position(5) > position(2));
+        // Without workers the stages run in the order added
+        if (workers == 0) CHECK((order == std::vector<int>{ 0, 1, 2, 3, 5 }));
+
+        const std::string report = graph.FormatReport();
+        CHECK(report.find("FAILED") != std::string::npos && report.find("skipped") != std::string::npos);
+    }
+
+    StartupGraph empty;
+    CHECK(empty.Run(2));
+}
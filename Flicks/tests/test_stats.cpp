@@ -0,0 +1,78 @@
+#include <cmath>
+#include <vector>
+
+#include "rng.h"
+#include "stream_stats.h"
+#include "test.h"
+
+void TestStreamStats() {
+    Rng rng(17);
+    std::vector<double> values;
+    for (int i = 0; i < 20000; ++i) values.push_back(rng.NextNormal(150.0f, 60.0f) + (i % 50 == 0 ? 400.0 : 0.0));
+
+    // Moments match the two-pass formulas, and merging halves changes nothing
+    {
+        double sum = 0.0;
+        for (double v : values) sum += v;
+        const double mean = sum / values.size();
+        double squares = 0.0;
+        for (double v : values) squares += (v - mean) * (v - mean);
+        const double variance = squares / values.size();
+
+        RunningStats all, first, second;
+        for (size_t i = 0; i < values.size(); ++i) {
+            all.Add(values[i]);
+            (i < values.size() / 2 ? first : second).Add(values[i]);
+        }
+        first.Merge(second);
+        for (const RunningStats* stats : { &all, &first }) {
+            CHECK(stats->GetCount() == static_cast<long long>(values.size()));
+            CHECK(std::fabs(stats->GetMean() - mean) < 1e-9 * std::fabs(mean));
+            CHECK(std::fabs(stats->GetVariance() - variance) < 1e-9 * variance);
+        }
+        std::vector<double> sorted = values;
+        CHECK(all.GetMin() == ExactQuantile(sorted, 0.0));
+        CHECK(all.GetMax() == ExactQuantile(sorted, 1.0));
+
+        RunningStats empty;
+        CHECK(empty.GetCount() == 0 && empty.GetMin() == 0.0 && empty.GetMax() == 0.0 && empty.GetVariance() == 0.0);
+    }
+
+    // Nearest rank: 1..101 has its p-quantile at 1 + 100p
+    {
+        std::vector<int> ranks;
+        for (int i = 101; i >= 1; --i) ranks.push_back(i);
+        const Quantiles q = ExactQuantiles(ranks);
+        CHECK(q.p50 == 51.0 && q.p90 == 91.0 && q.p99 == 100.0);
+        std::vector<int> none;
+        CHECK(ExactQuantile(none, 0.5) == 0.0);
+    }
+
+    // P-square is exact for the first five values, then close on a long stream
+    {
+        P2Quantile median;
+        const double few[] = { 5.0, 1.0, 4.0, 2.0, 3.0 };
+        for (double v : few) median.Add(v);
+        CHECK(median.Get() == 3.0);
+
+        StreamStats stream;
+        for (double v : values) stream.Add(v);
+        std::vector<double> sorted = values;
+        const Quantiles exact = ExactQuantiles(sorted);
+        const Quantiles estimated = stream.GetQuantiles();
+        const double spread = std::sqrt(stream.moments.GetVariance());
+        CHECK(std::fabs(estimated.p50 - exact.p50) < 0.05 * spread);
+        CHECK(std::fabs(estimated.p90 - exact.p90) < 0.05 * spread);
+        CHECK(std::fabs(estimated.p99 - exact.p99) < 0.2 * spread);
+    }
+
+    // The moving average starts at the first value and follows a step
+    {
+        Ewma trend(0.5);
+        CHECK(!trend.HasValue());
+        trend.Add(10.0);
+        CHECK(trend.HasValue() && trend.Get() == 10.0);
+        trend.Add(20.0);
+        CHECK(trend.Get() == 15.0);
+    }
+}
@@ -0,0 +1,218 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "compat.h"
+#include "field.h"
+#include "presets.h"
+#include "rng.h"
+#include "session.h"
+#include "session_replay.h"
+#include "session_trace.h"
+#include "simulate.h"
+#include "test.h"
+
+namespace {
+    FieldCache MakeField(const GameSettings& settings) {
+        FieldCache field;
+        UpdateFieldCache(field, 1920, 1080, settings.scale, settings.circleRadiusNorm, settings.cursorRadiusNorm);
+        return field;
+    }
+
+    // Rewrites count bytes of the file at offset
+    bool Patch(const std::string& path, long offset, const void* bytes, size_t count) {
+        FILE* f;
+        if (fopen_s(&f, path.c_str(), "r+b") != 0) return false;
+        const bool ok = fseek(f, offset, SEEK_SET) == 0 && fwrite(bytes, 1, count, f) == count;
+        return (fclose(f) == 0) && ok;
+    }
+
+    // A finished game recorded by a simulated player
+    void RecordGame(const GameSettings& settings, uint64_t seed, SessionTrace& trace) {
+        SimPlayer player;
+        player.reactionSdMs = 40.0f;
+        player.aimSpread = 0.6f;
+        player.missRate = 0.05f;
+        FlicksSession session;
+        session.Configure(settings, MakeField(settings));
+        session.Seed(seed);
+        session.SetTrace(&trace);
+        Rng rng(seed, RNG_STREAM_PLAYER);
+        SimulateSession(session, player, rng);
+    }
+}
+
+void TestSessionTrace() {
+    GameSettings settings;
+    const FieldCache field = MakeField(settings);
+
+    // Every field survives encoding; spawns to 1/8 px, clicks exactly
+    SessionTrace trace(1u << 16);
+    trace.SetMouseScale(0.5f);
+    trace.Begin(99, settings, field, 5000000);
+    const std::vector<TraceEvent> input = {
+        { TRACE_CLICK, FlicksSession::CLICK_STARTED, 0, 0, 960.1234f, 540.5678f, 5000000 },
+        { TRACE_SPAWN, 0, 0, 0, 1000.125f, 300.5f, 5100000 },
+        { TRACE_MOVE, 0, -40000, 12, 0.0f, 0.0f, 5100125 },
+        { TRACE_MOVE, 0, 3, -7, 0.0f, 0.0f, 5100120 },
+        { TRACE_CLICK, FlicksSession::CLICK_HIT, 0, 0, 1001.3f, 299.9f, 5290000 },
+        { TRACE_EXPIRE, 0, 0, 0, 0.0f, 0.0f, 5350000 },
+        { TRACE_LAST, 1, 0, 0, 0.0f, 0.0f, 5400000 },
+    };
+    trace.RecordClick(input[0].x, input[0].y, input[0].detail, input[0].timeUs);
+    trace.RecordSpawn(input[1].x, input[1].y, input[1].timeUs);
+    trace.RecordMove(input[2].dx, input[2].dy, input[2].timeUs);
+    trace.RecordMove(input[3].dx, input[3].dy, input[3].timeUs);
+    trace.RecordClick(input[4].x, input[4].y, input[4].detail, input[4].timeUs);
+    trace.RecordExpire(input[5].timeUs);
+    trace.RecordLast(true, input[6].timeUs);
+    GameResult result;
+    result.hits = 1;
+    result.attempts = 1;
+    result.score = 1.0f;
+    trace.RecordEnd(result, true, 5400000);
+    CHECK(!trace.IsRecording());
+    CHECK(trace.GetEventCount() == input.size() + 1);
+
+    std::vector<TraceEvent> decoded;
+    CHECK(DecodeSessionTrace(trace.GetData(), trace.GetSize(), trace.GetHeader().startTimeUs, decoded));
+    if (CHECK(decoded.size() == input.size() + 1)) {
+        for (size_t i = 0; i < input.size(); ++i) {
+            const TraceEvent& a = input[i];
+            const TraceEvent& b = decoded[i];
+            CHECK(a.type == b.type && a.detail == b.detail && a.timeUs == b.timeUs && a.dx == b.dx && a.dy == b.dy);
+            if (a.type == TRACE_CLICK) CHECK(memcmp(&a.x, &b.x, 4) == 0 && memcmp(&a.y, &b.y, 4) == 0);
+            else CHECK(std::abs(a.x - b.x) <= 0.0625f && std::abs(a.y - b.y) <= 0.0625f);
+        }
+        CHECK(decoded.back().type == TRACE_END && decoded.back().detail == 1);
+    }
+
+    // Cut-off data does not decode
+    CHECK(!DecodeSessionTrace(trace.GetData(), trace.GetSize() - 3, 0, decoded));
+
+    // File round trip, then damage: a flipped event byte fails the CRC, a short file the length
+    const std::string dir = MakeTestDir("trace");
+    const std::string path = dir + "/game.flkt";
+    CHECK(trace.Write(path.c_str()));
+    TraceHeader header;
+    std::vector<TraceEvent> read;
+    CHECK(ReadSessionTrace(path.c_str(), header, read));
+    CHECK(read.size() == input.size() + 1);
+    CHECK(header.seed == 99 && header.hits == 1 && header.mouseScale == 0.5f && header.truncated == 0);
+
+    const uint8_t flipped = static_cast<uint8_t>(trace.GetData()[5] ^ 0x40);
+    CHECK(Patch(path, static_cast<long>(sizeof(TraceHeader)) + 5, &flipped, 1));
+    CHECK(!ReadSessionTrace(path.c_str(), header, read));
+
+    CHECK(trace.Write(path.c_str()));
+    std::filesystem::resize_file(path, sizeof(TraceHeader) + trace.GetSize() - 1);
+    CHECK(!ReadSessionTrace(path.c_str(), header, read));
+
+    // Sizes in a crafted header are refused before anything is allocated
+    const uint32_t huge = 0xFFFFFFF0u;
+    CHECK(trace.Write(path.c_str()));
+    CHECK(Patch(path, static_cast<long>(offsetof(TraceHeader, eventBytes)), &huge, sizeof(huge)));
+    CHECK(!ReadSessionTrace(path.c_str(), header, read));
+    CHECK(trace.Write(path.c_str()));
+    CHECK(Patch(path, static_cast<long>(offsetof(TraceHeader, eventCount)), &huge, sizeof(huge)));
+    CHECK(!ReadSessionTrace(path.c_str(), header, read));
+
+    // A full buffer keeps the first events and marks the trace truncated
+    SessionTrace small(64);
+    small.Begin(1, settings, field, 0);
+    for (int i = 0; i < 100; ++i) small.RecordMove(i, -i, i * 125);
+    CHECK(small.IsTruncated());
+    CHECK(small.GetSize() <= small.GetCapacity());
+    decoded.clear();
+    CHECK(DecodeSessionTrace(small.GetData(), small.GetSize(), 0, decoded) && decoded.size() == small.GetEventCount());
+
+    RemoveTestDir(dir);
+}
+
+void TestSessionReplay() {
+    const std::string dir = MakeTestDir("replay");
+    const std::string path = dir + "/game.flkt";
+
+    // Every preset replays to the same events and bit-identical results,
+    // from memory and from a file
+    for (int p = 0; p < g_presetCount; ++p) {
+        GameSettings settings;
+        ApplyPreset(settings, g_presets[p]);
+        SessionTrace trace;
+        for (int g = 0; g < 10; ++g) {
+            RecordGame(settings, static_cast<uint64_t>(p) * 100 + g + 1, trace);
+
+            SessionReplay replay;
+            FlicksSession session;
+            CHECK(replay.Load(trace));
+            CHECK(replay.Begin(session));
+            CHECK(replay.Run());
+            replay.End();
+            const ReplayCheck check = replay.Check();
+            CHECK(check.eventsMatch && check.resultMatch && check.firstMismatch < 0 && check.sameRules);
+        }
+
+        CHECK(trace.Write(path.c_str()));
+        SessionReplay replay;
+        FlicksSession session;
+        CHECK(replay.Load(path.c_str()));
+        CHECK(replay.Begin(session));
+        replay.Run();
+        const ReplayCheck check = replay.Check();
+        CHECK(check.eventsMatch && check.resultMatch);
+    }
+
+    // A doctored score in the header is caught; the events still match
+    {
+        GameSettings settings;
+        SessionTrace trace;
+        RecordGame(settings, 5, trace);
+        CHECK(trace.Write(path.c_str()));
+        const int32_t hits = trace.GetHeader().hits + 10;
+        CHECK(Patch(path, static_cast<long>(offsetof(TraceHeader, hits)), &hits, sizeof(hits)));
+
+        SessionReplay replay;
+        FlicksSession session;
+        CHECK(replay.Load(path.c_str()));
+        CHECK(replay.Begin(session));
+        replay.Run();
+        const ReplayCheck check = replay.Check();
+        CHECK(check.eventsMatch);
+        CHECK(!check.resultMatch);
+        CHECK(check.recorded.hits == hits);
+    }
+
+    // A game from before the rules were recorded is told apart
+    {
+        GameSettings settings;
+        SessionTrace trace;
+        RecordGame(settings, 6, trace);
+        CHECK(trace.GetHeader().rulesVersion == FlicksSession::kRulesVersion);
+        CHECK(trace.Write(path.c_str()));
+        const uint32_t oldRules = 0;
+        CHECK(Patch(path, static_cast<long>(offsetof(TraceHeader, rulesVersion)), &oldRules, sizeof(oldRules)));
+
+        SessionReplay replay;
+        FlicksSession session;
+        CHECK(replay.Load(path.c_str()));
+        CHECK(replay.Begin(session));
+        replay.Run();
+        CHECK(!replay.Check().sameRules);
+    }
+
+    // A trace that does not open with the start click is not a game
+    {
+        GameSettings settings;
+        SessionTrace trace;
+        trace.Begin(1, settings, MakeField(settings), 0);
+        trace.RecordSpawn(10.0f, 10.0f, 1000);
+        SessionReplay replay;
+        CHECK(!replay.Load(trace));
+    }
+
+    RemoveTestDir(dir);
+}
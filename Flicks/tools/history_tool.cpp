@@ -0,0 +1,144 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "history.h"
+#include "session_trace.h"
+#include "stream_stats.h"
+#include "settings_key.h"
+#include "summaries.h"
+
+namespace {
+    void PrintUsage() {
+        printf(
+            "Usage: flicks_history <command> ...\n"
+            "  export <history.bin> <out.csv>   write the log as game_summaries.csv\n"
+            "  import <in.csv> <history.bin>    build a log from a game_summaries.csv (replaces the log)\n"
+            "  check <history.bin>              count records and report damaged ones\n"
+            "  stats <history.bin>              per-settings statistics, as the results window shows them\n"
+            "  trace <game.flkt>                event counts and click outcomes of a recorded game\n");
+    }
+
+    bool ReadOrComplain(std::vector<GameSummary>& summaries, const char* path, int& dropped) {
+        if (!ReadGameHistory(summaries, path, &dropped)) {
+            fprintf(stderr, "%s is missing or not a game history log\n", path);
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        PrintUsage();
+        return 1;
+    }
+
+    const char* command = argv[1];
+    std::vector<GameSummary> summaries;
+    int dropped = 0;
+
+    if (strcmp(command, "export") == 0 && argc == 4) {
+        if (!ReadOrComplain(summaries, argv[2], dropped)) return 1;
+        SaveGameSummaries(summaries, argv[3]);
+        printf("exported %zu games to %s (%d damaged records skipped)\n", summaries.size(), argv[3], dropped);
+        return 0;
+    }
+    if (strcmp(command, "import") == 0 && argc == 4) {
+        LoadGameSummaries(summaries, argv[2]);
+        if (!WriteGameHistory(summaries, argv[3])) {
+            fprintf(stderr, "Could not write %s\n", argv[3]);
+            return 1;
+        }
+        printf("imported %zu games into %s\n", summaries.size(), argv[3]);
+        return 0;
+    }
+    if (strcmp(command, "stats") == 0 && argc == 3) {
+        if (!ReadOrComplain(summaries, argv[2], dropped)) return 1;
+        // Same streams as the statistics view keeps per settings key
+        struct Group {
+            const GameSummary* first;
+            StreamStats score;
+            StreamStats reactionTime;
+        };
+        std::vector<Group> groups;
+        std::unordered_map<uint64_t, size_t> groupOfKey;
+        for (const GameSummary& s : summaries) {
+            auto [it, added] = groupOfKey.try_emplace(MakeSettingsKey(s), groups.size());
+            if (added) groups.push_back(Group{ &s, {}, {} });
+            Group& group = groups[it->second];
+            group.score.Add(s.score);
+            if (s.avgReactionTime > 0.0f) group.reactionTime.Add(s.avgReactionTime);
+        }
+
+        printf("%-28s %8s | %-22s %8s | %-8s %-8s %-8s %-8s\n",
+            "radius/lifetime/time/delay", "games", "score mean +- sd", "trend", "rt mean", "p50", "p90", "p99");
+        for (const Group& stats : groups) {
+            const GameSummary* g = stats.first;
+            const Quantiles q = stats.reactionTime.GetQuantiles();
+            char config[64];
+            snprintf(config, sizeof(config), "%.3f/%d/%d%s/%d-%d", g->circleRadiusNorm, g->circleLifetimeMs,
+                g->endBySpawnCount ? g->maxSpawnCount : g->gameTimeSec, g->endBySpawnCount ? "n" : "s",
+                g->minSpawnDelayMs, g->maxSpawnDelayMs);
+            printf("%-28s %8lld | %9.1f +- %-9.1f %8.1f | %8.1f %8.1f %8.1f %8.1f\n", config, stats.score.moments.GetCount(),
+                stats.score.moments.GetMean(), stats.score.moments.GetStddev(), stats.score.trend.Get(),
+                stats.reactionTime.moments.GetMean(), q.p50, q.p90, q.p99);
+        }
+        return 0;
+    }
+    if (strcmp(command, "trace") == 0 && argc == 3) {
+        TraceHeader header;
+        std::vector<TraceEvent> events;
+        if (!ReadSessionTrace(argv[2], header, events)) {
+            fprintf(stderr, "%s is missing or not a valid session trace\n", argv[2]);
+            return 1;
+        }
+
+        int counts[TRACE_LAST + 1] = {};
+        int hits = 0;
+        int misses = 0;
+        double missDistance = 0.0;      // from the live target, in hit radii
+        float targetX = 0.0f, targetY = 0.0f;
+        bool targetLive = false;
+        const double hitRadius = header.circleRadiusPx + header.cursorRadiusPx;
+        for (const TraceEvent& e : events) {
+            counts[e.type]++;
+            if (e.type == TRACE_SPAWN) {
+                targetX = e.x;
+                targetY = e.y;
+                targetLive = true;
+            }
+            else if (e.type == TRACE_EXPIRE) targetLive = false;
+            else if (e.type == TRACE_CLICK && e.detail == FlicksSession::CLICK_HIT) {
+                hits++;
+                targetLive = false;
+            }
+            else if (e.type == TRACE_CLICK && e.detail == FlicksSession::CLICK_MISS) {
+                misses++;
+                if (targetLive && hitRadius > 0.0) missDistance += std::hypot(e.x - targetX, e.y - targetY) / hitRadius;
+            }
+        }
+
+        const long long durationUs = events.empty() ? 0 : events.back().timeUs - header.startTimeUs;
+        printf("seed %016llx, %.3f s, %u events in %u bytes (%.2f bytes/event)%s\n",
+            static_cast<unsigned long long>(header.seed), durationUs / 1e6, header.eventCount, header.eventBytes,
+            header.eventCount ? static_cast<double>(header.eventBytes) / header.eventCount : 0.0,
+            header.truncated ? ", truncated" : "");
+        printf("spawns %d, expired %d, mouse reports %d, clicks %d (hits %d, misses %d)\n",
+            counts[TRACE_SPAWN], counts[TRACE_EXPIRE], counts[TRACE_MOVE], counts[TRACE_CLICK], hits, misses);
+        if (misses > 0) printf("mean miss distance %.2f hit radii\n", missDistance / misses);
+        printf("recorded result: hits %d/%d, rt %.1f ms, score %.1f\n",
+            header.hits, header.attempts, header.avgReactionTime, header.score);
+        return 0;
+    }
+    if (strcmp(command, "check") == 0 && argc == 3) {
+        if (!ReadOrComplain(summaries, argv[2], dropped)) return 1;
+        printf("%s: %zu games, %d damaged records\n", argv[2], summaries.size(), dropped);
+        return dropped == 0 ? 0 : 2;
+    }
+
+    PrintUsage();
+    return 1;
+}